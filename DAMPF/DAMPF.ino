@@ -239,13 +239,13 @@
  * - SD card size if available
  *
  * DHCP screen:
- * - DHCP IP address: eth_dhcpInfo[  0 ], 0 is usually not used
- * - Network mask:    eth_dhcpInfo[  1 ]
- * - Default gateway: eth_dhcpInfo[  3 ]
- * - Server IP:       eth_dhcpInfo[ 54 ]
- * - Lease time:      eth_dhcpInfo[ 51 ]
- * - DNS Domain name: eth_dhcpInfo[ 15 ]
- * - DNS 1, 2, 3:     eth_dhcpInfo[  6 ]
+ * - DHCP IP address: option   0, 0 is usually not used
+ * - Network mask:    option   1
+ * - Default gateway: option   3
+ * - Server IP:       option  54
+ * - Lease time:      option  51
+ * - DNS Domain name: option  15
+ * - DNS 1, 2, 3:     option   6
  *
  * Discovery screen (data from both LLDP and CDP):
  * - Switch port number
@@ -382,8 +382,20 @@
 // Include local libraries / files
 #include "lldp_functions.h"  // LLDP functions
 #include "cdp_functions.h"   // CDP functions
+#include "frame_functions.h" // Classify received frames
 #include "Packet_data.h"     // Generic packet data structure
+#include "neighbor_table.h"  // Received LLDP and CDP neighbors
 #include "DHCPOptions.h"     // DHCP option structure
+#include "dhcp_client.h"     // DHCP client with independent contexts
+#include "dhcp_sweep.h"      // Probe VLANs for DHCP servers
+#include "link_timeline.h"   // Time from link-up to the discovery milestones
+#include "dns_resolver.h"    // Non-blocking DNS lookups
+#include "ntp_client.h"      // Query all NTP sources at the same time
+#include "frame_pool.h"      // Buffers of the received frames
+#include "enc_filter.h"      // Receive filters of the ENC28J60
+#include "vlan_census.h"     // VLAN IDs of the received frames
+#include "frame_ring.h"      // Frames of the receive task
+#include "fmt_functions.h"   // Format addresses and numbers without String
 #include "prefs.h"           // Use ESP preferences for storing several configuration data
 
 // Check if Bluetooth is enabled in default configuration. For Arduino IDE this
@@ -444,6 +456,7 @@ TFT_eSPI tft = TFT_eSPI(tft_width, tft_height);  // Invoke custom library
 // Green if ethernet is used and a link is established, blue if the link is not up?
 
 static byte tft_userMenuPos = 0;
+static byte tft_userMenuFirst = 0;  // First visible entry of the scrolled menu
 static uint16_t tft_spaceWidth;  // Width of a blank, ASCII character 32 with the used font
 static uint16_t tft_arrowWidth;  // Width of the arrow "> " and blank using the given font
 
@@ -505,7 +518,9 @@ static const byte TFT_SCREEN_LLDP2 = 4;
 static const byte TFT_SCREEN_CDP1 = 5;
 static const byte TFT_SCREEN_CDP2 = 6;
 static const byte TFT_SCREEN_NTP = 7;
-static const byte TFT_SCREEN_WIFIS = 8;
+static const byte TFT_SCREEN_TIMELINE = 8;
+static const byte TFT_SCREEN_VLANS = 9;
+static const byte TFT_SCREEN_WIFIS = 10;
 
 
 // User menu item structure
@@ -532,6 +547,10 @@ static sMenuItem tft_userMenu[] = {
   { TXT_GEN_WRITETOLOG, false, 0 },          // 10) Write all gathered information to log file
   { TXT_GEN_ROTATESCREEN, true, 0 },         // 11) Screen rotation
   { TXT_GEN_SCREENSWITCHDELAY, true, 0 },    // 12) Delay for autmatic screen switching
+  { TXT_ETH_PROMISCUOUS, true, 0 },          // 13) Receive all frames of the Ethernet port
+  { TXT_ETH_SWEEP, true, 0 },                // 14) Start / stop the DHCP sweep
+  { TXT_ETH_SWEEPVLANS, true, ETH_DEFAULTSWEEPRANGEIDX },  // 15)   VLANs of the DHCP sweep
+  { TXT_ETH_SWEEPRATE, true, ETH_DEFAULTSWEEPRATEIDX },    // 16)   DISCOVERs per second of the DHCP sweep
 };
 // Menu array entry numbers
 static const byte TFT_MENUENTRY_ETHERNET = 0;
@@ -546,6 +565,10 @@ static const byte TFT_MENUENTRY_DEFAULTFUNCTION = 8;
 static const byte TFT_MENUENTRY_WRITETOLOG = 9;
 static const byte TFT_MENUENTRY_ROTATESCREEN = 10;
 static const byte TFT_MENUENTRY_SCREENSWITCHDELAY = 11;
+static const byte TFT_MENUENTRY_PROMISCUOUS = 12;
+static const byte TFT_MENUENTRY_SWEEP = 13;
+static const byte TFT_MENUENTRY_SWEEPVLANS = 14;
+static const byte TFT_MENUENTRY_SWEEPRATE = 15;
 
 // If SD card should be supported
 #ifdef USE_SDCARD
@@ -573,40 +596,41 @@ int btn_click = false;
 // been re-established
 bool gen_justBooted = true;
 
-// String for the used device name
-// Do not change yet, this name is currently hard coded in the send_LLDP_MED() function in "lldp_functions.cpp".
+// String for the used device name, also sent as LLDP system name
 String gen_DeviceName;
 
-// Locally administered MAC address, do not change yet, this name is currently hard coded in the
-// send_LLDP_MED() function in "lldp_functions.cpp".
+// Locally administered MAC address, also used as LLDP chassis ID, port ID and serial number
 byte eth_myMAC[] = { 0xCA, 0xFE, 0xC0, 0xFF, 0xEE, 0x00 };
 
 #define UDP_SRC_PORT_H_P 0x22
 #define UDP_SRC_PORT_L_P 0x23
-#define DHCP_SERVER_PORT 67
 
-PINFO eth_lldpPacket;
-PINFO eth_cdpPacket;
-String eth_myMACString;
-static const uint16_t ETH_BUFFERSIZE = 1500;
-//static const uint16_t ETH_BUFFERSIZE = 1522;  // Maximum Ethernet frame size with VLAN tag
+char eth_myMACString[FMT_MACLEN];
+static const uint16_t ETH_BUFFERSIZE = 1522;  // Maximum Ethernet frame size with VLAN tag
 byte Ethernet::buffer[ETH_BUFFERSIZE];
-byte eth_buffcheck[ETH_BUFFERSIZE];
 bool eth_ENCLink;
-DHCP_DATA eth_dhcpInfo[2][255];
-byte eth_vlanOption = 0;
-unsigned long eth_dhcpStart;
+DHCP_DATA eth_dhcpInfo[DHCP_CONTEXTS];
+
+// Receive task: drains the ENC28J60 into the frame ring on the other core. The mutex protects
+// the controller and the EtherCard buffer, which are shared by the task and the loop.
+static const BaseType_t ETH_RXTASKCORE = 0;
+static const UBaseType_t ETH_RXTASKPRIO = 2;
+static const uint32_t ETH_RXTASKSTACK = 4096;
+static const byte ETH_RXFRAMESPERLOOP = RING_SLOTS;  // Frames taken from the ring per pass of the loop
+SemaphoreHandle_t xMutex_eth = NULL;
+TaskHandle_t eth_rxTaskHandle = NULL;
 static const unsigned long ETH_DHCPTIMEOUT = 60000l;
-uint32_t eth_linkUpMillis = 0;
 
 // Received packets
 bool eth_dhcpReceived;
 bool eth_vlanDhcpReceived;
-bool eth_lldpPacketReceived;
-bool eth_cdpPacketReceived;
 bool eth_ntpReceived;
-bool eth_nslookupDomainChecked;
-bool eth_nslookupDNSserachlistChecked;
+bool eth_nslookupStarted;
+bool eth_nslookupDone;
+
+// DNS queries of the DNS domain and the search list
+int8_t eth_dnsHandles[DNS_MAXQUERIES];
+byte eth_dnsCount = 0;
 
 
 // VLAN support
@@ -616,6 +640,47 @@ bool eth_vLANTagging;
 // Send LLDP Med packet
 unsigned long eth_lastLLDPsent = 0;
 const unsigned long ETH_LASTLLDPINTERVAL = 30000l;
+
+// LLDP-MED fast start after link-up (ANSI/TIA-1057 fast start repeat count, IEEE 802.1AB msgFastTx):
+// the first ETH_LLDPFASTCOUNT frames are sent every ETH_LLDPFASTINTERVAL until a network policy is received
+const unsigned long ETH_LLDPFASTINTERVAL = 1000l;
+static const byte ETH_LLDPFASTCOUNT = 4;
+byte eth_lldpFastCount = 0;
+
+// Send CDP packet: Cisco switches send CDP every 60 s, the own announcement with a voice VLAN
+// query lets them answer immediately. Like LLDP-MED the first frames after link-up are sent faster
+// until the voice VLAN is received.
+unsigned long eth_lastCDPsent = 0;
+const unsigned long ETH_CDPINTERVAL = 60000l;
+const unsigned long ETH_CDPFASTINTERVAL = 1000l;
+static const byte ETH_CDPFASTCOUNT = 4;
+byte eth_cdpFastCount = 0;
+
+// Content of the own CDP frame
+static const CDP_TXCONFIG ETH_CDPCONFIG = {
+  180,              // TTL
+  "Port 1",         // Port ID
+  0x00000090,       // Capabilities host, phone
+  TXT_GEN_VERSION,  // Software version
+  TXT_GEN_DEVNAME   // Platform
+};
+
+// Content of the own LLDP-MED frame: IP phone (endpoint class III) requesting 5.0 W with high priority
+static const LLDP_TXCONFIG ETH_LLDPCONFIG = {
+  180,              // TTL
+  "WAN PORT",       // Port description
+  TXT_GEN_DEVNAME,  // Model
+  0x0033,           // LLDP-MED capabilities, network policy, extended power via MDI-PD, inventory
+  3,                // Endpoint class III
+  3,                // Power class 2
+  2,                // Power priority high
+  50,               // Requested power 5.0 W
+  1,                // Network policy application voice
+  "1.0",            // Hardware revision
+  "1.6",            // Firmware revision
+  "1.6",            // Software revision
+  "DIY"             // Manufacturer
+};
 //byte eth_lldpMEDReceivedCount = 0;
 
 // Battery data
@@ -626,6 +691,7 @@ static const float BAT_MAXVOLT = 4.2;
 
 // Display control
 uint8_t disp_currentScreen = 0;
+int8_t disp_neighborSlot = -1;  // Neighbor table slot shown on the LLDP or CDP screens
 bool disp_bDisplayMenu = false;
 bool disp_autoSwitch = true;
 unsigned long disp_autoSwitchLastTime = 0l;
@@ -635,15 +701,14 @@ unsigned long disp_autoSwitchLastTime = 0l;
 byte eth_ntpIPs[ETH_NTPMAXSOURCES][IP_LEN];
 byte eth_ntpSources = 0;
 byte eth_currentNTPSource = 0;
-String eth_ntpServer;
-static const unsigned long ETH_NTPTIMEOUT = 1500ul;
+char eth_ntpServer[FMT_IPV4LEN];
 long eth_timeZoneOffset = 0l;  // 3600L; // Winter (original) time Europe
 enum { NTP_INIT,
+       NTP_RUNNING,
        NTP_OK,
        NTP_FAILED } eth_ntpRequestStatus;
 uint32_t eth_timeFromNTP;
 unsigned long eth_ntpRequestStarted = 0l;
-static const unsigned long GEN_SEVENTY_YEARS = 2208988800UL;
 
 // ESP internal RTC
 ESP32Time esprtc(eth_timeZoneOffset);  // Initialize ESP RTC with time zone offset, use 0 for UTC.
@@ -878,28 +943,26 @@ void setup() {
   tft_userMenu[TFT_MENUENTRY_DEFAULTFUNCTION].value = readPreferencesDefaultFunction();
   tft_userMenu[TFT_MENUENTRY_ROTATESCREEN].value = readPreferencesOrientation();
   tft_userMenu[TFT_MENUENTRY_SCREENSWITCHDELAY].value = readPreferencesDelay();
+  tft_userMenu[TFT_MENUENTRY_PROMISCUOUS].value = readPreferencesPromiscuous() ? enc_Promiscuous : enc_Filtered;
+  tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].value = readPreferencesSweepVLANs();
+  tft_userMenu[TFT_MENUENTRY_SWEEPRATE].value = readPreferencesSweepRate();
 
   // Disable WIFI Options to save power
   if (tft_userMenu[TFT_MENUENTRY_DEFAULTFUNCTION].value != fWiFi)
     wifi_disable();
 
   // Create string of MAC address
-  eth_myMACString = "";
-  for (byte i = 0; i < 6; i++) {
-    String tmp = "0" + String(eth_myMAC[i], HEX);
-    tmp = tmp.substring(tmp.length() - 2);
-    eth_myMACString += tmp;
-    if (i < 5)
-      eth_myMACString += ":";
-  }
+  fmt_mac(eth_myMACString, sizeof(eth_myMACString), eth_myMAC, ':');
 
   // The maximum length for a name is defines in RFC 1035 with 63 bytes.
   gen_DeviceName = String(TXT_GEN_DEVNAME);
+  lldp_buildFrame(eth_myMAC, gen_DeviceName.c_str(), &ETH_LLDPCONFIG);
+  cdp_buildFrame(eth_myMAC, gen_DeviceName.c_str(), &ETH_CDPCONFIG);
 
 #ifdef DEBUGSERIAL
   Serial.printf("\n%s %s\n", TXT_GEN_DEVNAME, TXT_GEN_VERSION);
   Serial.printf("%s %s\n", TXT_GEN_PROPERTYOF, TXT_GEN_OWNER);
-  Serial.println("MAC: %s" + eth_myMACString);
+  Serial.printf("MAC: %s\n", eth_myMACString);
 
   Serial.println("Used IDF version for compilation: " + String(esp_get_idf_version()));
   Serial.printf("Used ESP arduino platform for compilation: %s\n", getArduinoPlatformVersion());
@@ -945,9 +1008,16 @@ void setup() {
   bt_initialize();
 #endif
 
+  // Create a recursive mutex to control ENC28J60 access, the loop takes it in nested functions
+  xMutex_eth = xSemaphoreCreateRecursiveMutex();
+  assert(xMutex_eth != NULL);
+
   // Initialize ENC28J60
   eth_initialize();
 
+  // Receive the frames on the other core, so they are not lost while the loop draws the screen or writes the SD card
+  xTaskCreatePinnedToCore(eth_rxTask, "eth_rx", ETH_RXTASKSTACK, NULL, ETH_RXTASKPRIO, &eth_rxTaskHandle, ETH_RXTASKCORE);
+
   // Set auto scroll time to current millis
   disp_autoSwitchLastTime = millis();
 
@@ -1004,7 +1074,17 @@ void loop() {
       gen_previousMillis = gen_currentMillis;
       if (gen_currentFunction == fEthernet) {
         isENCLinkUp = eth_linkStatus();
+        eth_lock();
         isVLANTaggingEnabled = ENC28J60::is_VLAN_tagging_enabled();
+        eth_unlock();
+
+        // Remove neighbors which did not renew their data in time
+        if (neighbor_expire(gen_currentMillis)) {
+          if ((disp_currentScreen >= TFT_SCREEN_LLDP1) && (disp_currentScreen <= TFT_SCREEN_CDP2))
+            tft_showPage();
+          else
+            tft_updateHeader(false);
+        }
       }
     }
 
@@ -1034,201 +1114,202 @@ void loop() {
 
     if (isENCLinkUp) {
       // Get time from network using NTP request
-      if ((eth_ntpRequestStatus == NTP_INIT) && (eth_dhcpReceived) && (eth_nslookupDomainChecked) && (eth_nslookupDNSserachlistChecked)) {
+      if ((eth_ntpRequestStatus == NTP_INIT) && (eth_dhcpReceived) && (eth_nslookupDone)) {
+        eth_lock();
         eth_startNTPRequests();
+        eth_unlock();
       }
 
-      // Check if an ethernet packed has been received
-      uint16_t plen = ether.packetReceive();
-      if (plen > 0) {
-        receivedPacketWasTagged = ENC28J60::packet_Received_Was_Tagged();
+      // Handle the frames waiting in the ring, at most ETH_RXFRAMESPERLOOP per pass so a burst does not
+      // fill the pool while the buttons and the display are still served. Without a frame the DHCP
+      // client, the DNS queries, NTP and the sweep run once.
+      for (byte rxFrames = 0; rxFrames < ETH_RXFRAMESPERLOOP; rxFrames++) {
+        // Take the next frame received by the receive task
+        FRAME_INFO frameInfo;
+        frameInfo.type = frame_Other;
+        uint16_t plen = 0;
+        const byte *frame = NULL;
+        FRAME_BUFFER *rxBuffer = ring_pop();
+        if (rxBuffer != NULL) {
+          plen = rxBuffer->length;
+          receivedPacketWasTagged = rxBuffer->tagged;
+          frame = rxBuffer->frame;
+
+          // Classify the frame once, the decoders below only check the result
+          frame_classify(frame, plen, &frameInfo);
+        }
 
-        // Check packet size and copy packet to ethernet buffer
-        if (plen > ETH_BUFFERSIZE)
-          plen = ETH_BUFFERSIZE;
-        memcpy(eth_buffcheck, Ethernet::buffer, plen);
-      }
+        // The ARP handling of EtherCard reads the frame from the EtherCard buffer, the other
+        // decoders read it from the pool buffer. Sending also uses the EtherCard buffer, so
+        // nothing is sent before the frame has been handled there. The NTP requests above are sent
+        // before the frame is copied.
+        eth_lock();
+        if ((plen > 0) && (frameInfo.type == frame_ARP))
+          memcpy(Ethernet::buffer, frame, plen);
 
-      // Run the DHCP state machine
-      if ((isENCLinkUp) && ((isVLANTaggingEnabled && receivedPacketWasTagged) || (!isVLANTaggingEnabled))) {
-        plen = eth_callDhcpStateMachine(plen);
-      }
+        // Answers to the DHCP client, its contexts are matched by the transaction ID
+        if ((plen > 0) && dhcpc_receive(frame, plen, &frameInfo, millis()))
+          plen = 0;
 
-      // If the last packet was not a DHCP packet process
-      if (plen > 0) {
-        if ((isVLANTaggingEnabled && !receivedPacketWasTagged) || (!isVLANTaggingEnabled)) {
-          // Check if the packet is a LLDP broadcast
-          unsigned int lldp_correct = lldp_check_Packet(eth_buffcheck, plen);
-          if (lldp_correct > 1) {
-            eth_lldpPacket = lldp_packet_handler(eth_buffcheck, plen);
-            eth_lldpPacketReceived = true;
-            tft_updateHeader(false);
-            if (eth_lldpPacket.VoiceVLAN[1] != "-") {
-              if (eth_voiceVLAN == 0) {
-                eth_voiceVLAN = eth_lldpPacket.VoiceVLAN[1].toInt();
-              }
-            }
-          }  // if( lldp_correct > 1 )
-          else {
-            // Check if the packet is a CDP broadcast
-            unsigned int cdp_correct = cdp_check_Packet(eth_buffcheck, plen);
-            if (cdp_correct > 1) {
-              eth_cdpPacket = cdp_packet_handler(eth_buffcheck, plen);
-              eth_cdpPacketReceived = true;
-              tft_updateHeader(false);
-              if (eth_cdpPacket.VoiceVLAN[1] != "-") {
-                if (eth_voiceVLAN == 0) {
-                  eth_voiceVLAN = eth_cdpPacket.VoiceVLAN[1].toInt();
+        // Answers to the DNS queries
+        if ((plen > 0) && dns_receive(frame, plen, &frameInfo, millis()))
+          plen = 0;
+
+        // Replies to the NTP requests
+        if ((plen > 0) && ntp_receive(frame, plen, &frameInfo, millis()))
+          plen = 0;
+
+        // Resolve the MAC address of the DNS server or the gateway for the DNS queries. A received
+        // ARP frame is handled before the DHCP client may send, the ARP request is sent after it.
+        bool dnsWaitingArp = dns_pending() && ether.clientWaitingDns();
+        if (dnsWaitingArp && (frameInfo.type == frame_ARP))
+          ether.packetLoop(plen);
+
+        // Start the next probes of a running VLAN sweep, then send the DISCOVERs and REQUESTs of all
+        // DHCP contexts
+        bool sweepDone = sweep_process(millis());
+        dhcpc_process(millis(), eth_voiceVLAN);
+        bool dhcpChanged = eth_checkDhcp();
+
+        if (dnsWaitingArp && (frameInfo.type != frame_ARP))
+          ether.packetLoop(0);
+
+        // Send the DNS queries and repeat them after a timeout
+        dns_process(ether.dnsip, !ether.clientWaitingDns(), millis());
+
+        // Select the NTP source when all replies are received or the timeout has passed
+        if (ntp_process(millis()))
+          eth_finishNTPRequests();
+
+        eth_unlock();
+
+        if (dhcpChanged)
+          tft_updateHeader(false);
+        if (sweepDone) {
+#ifdef DEBUGSERIAL
+          dbg_printSweep();
+#endif
+          if (disp_bDisplayMenu || (disp_currentScreen == TFT_SCREEN_VLANS))
+            tft_showPage();
+        }
+
+        // If the last packet was not a DHCP packet process
+        // The LLDP and CDP decoders expect an untagged Ethernet header.
+        if ((plen > 0) && (frameInfo.headerLen == FRAME_ETH_HEADER_LEN)) {
+          if ((isVLANTaggingEnabled && !receivedPacketWasTagged) || (!isVLANTaggingEnabled)) {
+            // Check if the packet is a LLDP broadcast
+            if (frameInfo.type == frame_LLDP) {
+              // Reject malformed or truncated frames, only decode the frame if the content has changed
+              if (eth_checkFrame(frame_LLDP, lldp_validate(frame, plen))) {
+                uint16_t ttl;
+                uint32_t digest = lldp_digest(frame, plen, &ttl);
+                if (!neighbor_refresh(pinfo_ProtoLLDP, digest, ttl, millis())) {
+                  PINFO neighbor;
+                  pinfo_reset(&neighbor);
+                  lldp_packet_handler(frame, plen, &neighbor);
+                  eth_storeNeighbor(&neighbor, digest);
                 }
               }
-            }  // if( cdp_correct > 1 )
+            }  // if (frameInfo.type == frame_LLDP)
             else {
-              // any other protocol?
-              //#ifdef DEBUGSERIAL
-              /*
-              if( ( eth_buffcheck[ 12 ] == 0x08 ) && ( eth_buffcheck[ 13 ] == 0x00 ) )
-              {
-//                Serial.println( F( "Type Ethernet Frame" ) );
-//                if( eth_buffcheck[ IP_PROTO_P ] == IP_PROTO_ICMP_V )
-//                  Serial.println( F( "ICMP packet" ) );
-//                else if( eth_buffcheck[ IP_PROTO_P ] == IP_PROTO_TCP_V )
-//                  Serial.println( F( "TCP packet" ) );
-//                else if( eth_buffcheck[ IP_PROTO_P ] == IP_PROTO_UDP_V )
-//                  Serial.println( F( "UDP packet" ) );
-
-                if( eth_buffcheck[ IP_PROTO_P ] == IP_PROTO_UDP_V )
+              // Check if the packet is a CDP broadcast
+              if (frameInfo.type == frame_CDP) {
+                // Reject malformed, truncated or corrupted frames, only decode the frame if the content has changed
+                uint16_t cdpLen = plen;
+                if (eth_checkFrame(frame_CDP, cdp_validate(frame, &cdpLen))) {
+                  uint16_t ttl;
+                  uint32_t digest = cdp_digest(frame, cdpLen, &ttl);
+                  if (!neighbor_refresh(pinfo_ProtoCDP, digest, ttl, millis())) {
+                    PINFO neighbor;
+                    pinfo_reset(&neighbor);
+                    cdp_packet_handler(frame, cdpLen, &neighbor);
+                    eth_storeNeighbor(&neighbor, digest);
+                  }
+                }
+              }  // if (frameInfo.type == frame_CDP)
+              else {
+                // any other protocol?
+                //#ifdef DEBUGSERIAL
+                /*
+                if( ( frame[ 12 ] == 0x08 ) && ( frame[ 13 ] == 0x00 ) )
                 {
-                  if( ( eth_buffcheck[ 14 ] & 0b00001111 ) == 5 ) // IP header length / 4
+  //                Serial.println( F( "Type Ethernet Frame" ) );
+  //                if( frame[ IP_PROTO_P ] == IP_PROTO_ICMP_V )
+  //                  Serial.println( F( "ICMP packet" ) );
+  //                else if( frame[ IP_PROTO_P ] == IP_PROTO_TCP_V )
+  //                  Serial.println( F( "TCP packet" ) );
+  //                else if( frame[ IP_PROTO_P ] == IP_PROTO_UDP_V )
+  //                  Serial.println( F( "UDP packet" ) );
+
+                  if( frame[ IP_PROTO_P ] == IP_PROTO_UDP_V )
                   {
-                    Serial.println( F( "\nUnhandled packet received" ) );
-                    if( ( ( eth_buffcheck[ UDP_SRC_PORT_H_P ] << 8 ) | eth_buffcheck[ UDP_SRC_PORT_L_P ] ) == 123 )
+                    if( ( frame[ 14 ] & 0b00001111 ) == 5 ) // IP header length / 4
                     {
-                    Serial.println( F( "\nUnhandled packet received" ) );
-                      Serial.println( "Source IP:" + String( eth_buffcheck[ IP_SRC_P + 0 ] ) + "." + String( eth_buffcheck[ IP_SRC_P + 1 ] ) + "." + String( eth_buffcheck[ IP_SRC_P + 2 ] ) + "." + String( eth_buffcheck[ IP_SRC_P + 3 ] ) );
-                      Serial.println( "Dest IP  :" + String( eth_buffcheck[ IP_DST_P + 0 ] ) + "." + String( eth_buffcheck[ IP_DST_P + 1 ] ) + "." + String( eth_buffcheck[ IP_DST_P + 2 ] ) + "." + String( eth_buffcheck[ IP_DST_P + 3 ] ) );
-                      Serial.println( "Source Port:" + String( ( eth_buffcheck[ UDP_SRC_PORT_H_P ] << 8 ) | eth_buffcheck[ UDP_SRC_PORT_L_P ] ) );
-                      Serial.println( "Dest Port  :" + String( ( eth_buffcheck[ UDP_DST_PORT_H_P ] << 8 ) | eth_buffcheck[ UDP_DST_PORT_L_P ] ) ) ;
-//                if( ( eth_buffcheck[ 30 ] == ether.myip[ 0 ] ) && 
-//                  ( eth_buffcheck[ 31 ] == ether.myip[ 1 ] ) && 
-//                  ( eth_buffcheck[ 32 ] == ether.myip[ 2 ] ) && 
-//                  ( eth_buffcheck[ 33 ] == ether.myip[ 3 ] ) )
-//                {
-                      String tmpHex;
-                      for( uint16_t i = 0; i < plen; i++ )
+                      Serial.println( F( "\nUnhandled packet received" ) );
+                      if( ( ( frame[ UDP_SRC_PORT_H_P ] << 8 ) | frame[ UDP_SRC_PORT_L_P ] ) == 123 )
                       {
-                        tmpHex = "00" + String( eth_buffcheck[ i ], HEX );
-                        tmpHex = "0x" + tmpHex.substring( tmpHex.length() - 2 );
-                        Serial.print( tmpHex + " " );
-                        if( ( ( i  + 1 ) % 8 ) == 0 ) Serial.println();
+                      Serial.println( F( "\nUnhandled packet received" ) );
+                        Serial.println( "Source IP:" + String( frame[ IP_SRC_P + 0 ] ) + "." + String( frame[ IP_SRC_P + 1 ] ) + "." + String( frame[ IP_SRC_P + 2 ] ) + "." + String( frame[ IP_SRC_P + 3 ] ) );
+                        Serial.println( "Dest IP  :" + String( frame[ IP_DST_P + 0 ] ) + "." + String( frame[ IP_DST_P + 1 ] ) + "." + String( frame[ IP_DST_P + 2 ] ) + "." + String( frame[ IP_DST_P + 3 ] ) );
+                        Serial.println( "Source Port:" + String( ( frame[ UDP_SRC_PORT_H_P ] << 8 ) | frame[ UDP_SRC_PORT_L_P ] ) );
+                        Serial.println( "Dest Port  :" + String( ( frame[ UDP_DST_PORT_H_P ] << 8 ) | frame[ UDP_DST_PORT_L_P ] ) ) ;
+  //                if( ( frame[ 30 ] == ether.myip[ 0 ] ) && 
+  //                  ( frame[ 31 ] == ether.myip[ 1 ] ) && 
+  //                  ( frame[ 32 ] == ether.myip[ 2 ] ) && 
+  //                  ( frame[ 33 ] == ether.myip[ 3 ] ) )
+  //                {
+                        String tmpHex;
+                        for( uint16_t i = 0; i < plen; i++ )
+                        {
+                          tmpHex = "00" + String( frame[ i ], HEX );
+                          tmpHex = "0x" + tmpHex.substring( tmpHex.length() - 2 );
+                          Serial.print( tmpHex + " " );
+                          if( ( ( i  + 1 ) % 8 ) == 0 ) Serial.println();
+                        }
+                        Serial.println();
                       }
-                      Serial.println();
                     }
                   }
-                }
-              } // if( ( eth_buffcheck[ 12 ] == 0x08 ) && ( eth_buffcheck[ 13 ] == 0x00 ) )
-*/
-              //#endif
-            }  // else
-          }    // else
-        }      // if( ( ENC28J60::is_VLAN_tagging_enabled() && !ENC28J60::packetReceivedWasTagged() ) || ( !ENC28J60::is_VLAN_tagging_enabled() ) )
-
-        // Set length of received packet to 0
-        plen = 0;
-      }  // if( plen > 0 )
-
-      // Check if voice VLAN ID is available and if NTP is not in init state
-      if ((eth_voiceVLAN > 0) && eth_ntpRequestStatus != NTP_INIT) {
-        if (ether.dhcpState == EtherCard::DHCP_STATE_BOUND) {
-          if (!ENC28J60::is_VLAN_tagging_enabled()) {
-            EtherCard::dhcpRelease();
-            ENC28J60::enable_VLAN_tagging(eth_voiceVLAN);
-            eth_startDHCP();
-            tft_updateHeader(false);
-          } else {
-            EtherCard::dhcpRelease();
-            tft_updateHeader(false);
-          }
-        }
+                } // if( ( frame[ 12 ] == 0x08 ) && ( frame[ 13 ] == 0x00 ) )
+  */
+                //#endif
+              }  // else
+            }    // else
+          }      // if( ( ENC28J60::is_VLAN_tagging_enabled() && !ENC28J60::packetReceivedWasTagged() ) || ( !ENC28J60::is_VLAN_tagging_enabled() ) )
+
+          // Set length of received packet to 0
+          plen = 0;
+        }  // if( plen > 0 )
+
+        // Give the buffer back to the receive task
+        pool_release(rxBuffer);
+        if (rxBuffer == NULL)
+          break;
+      }  // for (rxFrames)
+
+      // Lease an address in the voice VLAN when the NTP requests are finished. The voice VLAN has its
+      // own DHCP context, the untagged lease is kept.
+      if ((eth_voiceVLAN > 0) && (eth_ntpRequestStatus != NTP_INIT) && (eth_ntpRequestStatus != NTP_RUNNING)
+          && (!eth_vlanDhcpReceived) && (dhcpc_state(DHCPC_VOICE) == dhcpc_Idle)) {
+        eth_lock();
+        dhcpc_lease(DHCPC_VOICE, eth_voiceVLAN, &eth_dhcpInfo[DHCPC_VOICE], ETH_DHCPTIMEOUT, millis());
+        eth_unlock();
       }
     }
 
-    // Check if there is a system handling the DNS domain name (DHCP option 15) which might be a domain controller
-    //  if( ( eth_dhcpReceived ) && ( ether.dnsip[ 0 ] != 0 ) && ( !isVLANTaggingEnabled ) && ( !eth_nslookupDomainChecked ) )
-    if ((eth_dhcpReceived == true) && (ether.dnsip[0] != 0) && (!isVLANTaggingEnabled) && (!eth_nslookupDomainChecked)) {
-      if ((eth_ntpSources < ETH_NTPMAXSOURCES) && (eth_dhcpInfo[0][15].Option[1] != "-")) {
-#ifdef DEBUGSERIAL
-        Serial.print("NS lookpup for domain:");
-        Serial.println(eth_dhcpInfo[0][15].Option[1]);
-#endif
-        if (ether.dnsLookup(eth_dhcpInfo[0][15].Option[1].c_str())) {
-#ifdef DEBUGSERIAL
-          Serial.println("IP: " + String(ether.hisip[0]) + "." + String(ether.hisip[1]) + "." + String(ether.hisip[2]) + "." + String(ether.hisip[3]));
-#endif
-          for (byte i = 0; i < IP_LEN; ++i)
-            eth_ntpIPs[eth_ntpSources][i] = ether.hisip[i];
-          eth_ntpSources++;
-#ifdef DEBUGSERIAL
-        } else {
-          Serial.println("NS looup failed");
-#endif
-        }
-      }  // if( ( eth_ntpSources < ETH_NTPMAXSOURCES ) && ( eth_dhcpInfo[ 0 ][ 15 ].Option[ 1 ] != "-" ) )
-#ifdef DEBUGSERIAL
-      else {
-        Serial.println("No DNS name provided.");
-      }
-#endif
-      eth_nslookupDomainChecked = true;
-    }  // if( ( eth_dhcpReceived == true ) && ( ether.dnsip[ 0 ] != 0 ) && ( !isVLANTaggingEnabled ) && ( !eth_nslookupDomainChecked ) )
-
-    // Check if there is a domain name search list (DHCP option 119), maybe there is a domain controller
-    if ((eth_dhcpReceived) && (ether.dnsip[0] != 0) && (!isVLANTaggingEnabled) && (!eth_nslookupDNSserachlistChecked)) {
-      String searchList = eth_dhcpInfo[0][119].Option[1];
-      if ((eth_ntpSources < ETH_NTPMAXSOURCES) && (searchList != "-") && (searchList != "")) {
-#ifdef DEBUGSERIAL
-        Serial.print("NS lookpup for domain search list:");
-        Serial.println(searchList);
-#endif
-
-        int16_t posStart = 0;
-        int16_t posEnd = 0;
-        String part;
-        while ((posEnd != -1) && (eth_ntpSources < ETH_NTPMAXSOURCES)) {
-          posEnd = searchList.indexOf('\n', posStart);
-          if (posEnd > 0)
-            part = searchList.substring(posStart, posEnd);
-          else
-            part = searchList.substring(posStart);
-
-#ifdef DEBUGSERIAL
-          Serial.print("looking up:");
-          Serial.println(part);
-#endif
-
-          if (ether.dnsLookup(part.c_str())) {
-#ifdef DEBUGSERIAL
-            Serial.println("IP: " + String(ether.hisip[0]) + "." + String(ether.hisip[1]) + "." + String(ether.hisip[2]) + "." + String(ether.hisip[3]));
-#endif
-            for (byte i = 0; i < IP_LEN; ++i)
-              eth_ntpIPs[eth_ntpSources][i] = ether.hisip[i];
-            eth_ntpSources++;
-#ifdef DEBUGSERIAL
-          }  // if( ether.dnsLookup( part.c_str() ) )
-          else {
-            Serial.println("DNS failed");
-#endif
-          }
+    // Resolve the DNS domain name (DHCP option 15) and the domain search list (DHCP option 119), the systems
+    // handling them might be domain controllers which can be used as NTP sources
+    if ((eth_dhcpReceived) && (ether.dnsip[0] != 0) && (!isVLANTaggingEnabled) && (!eth_nslookupStarted)) {
+      eth_startDnsLookups();
+      eth_nslookupStarted = true;
+    }
 
-          posStart = posEnd + 1;
-        }
-      }  // if( ( eth_ntpSources < ETH_NTPMAXSOURCES ) && ( eth_dhcpInfo[ 0 ][ 15 ].Option[ 1 ] != "-" ) )
-#ifdef DEBUGSERIAL
-      else {
-        Serial.println("No domain name search list provided.");
-      }
-#endif
-      eth_nslookupDNSserachlistChecked = true;
-    }  // if( ( eth_dhcpReceived == true ) && ( ether.dnsip[ 0 ] != 0 ) && ( !isVLANTaggingEnabled ) && ( !eth_nslookupDNSserachlistChecked ) )
+    // Add the resolved addresses to the NTP sources when all names are finished
+    if ((eth_nslookupStarted) && (!eth_nslookupDone) && (!dns_pending())) {
+      eth_storeDnsResults();
+      eth_nslookupDone = true;
+      eth_markTimeline(timeline_DnsDone);
+    }
 
     vTaskDelay(1);
   }
@@ -1242,13 +1323,60 @@ void eth_initalizeReceivedPackets() {
   // No packets for given protocols received
   eth_dhcpReceived = false;
   eth_vlanDhcpReceived = false;
-  eth_lldpPacketReceived = false;
-  eth_cdpPacketReceived = false;
   eth_ntpReceived = false;
-  eth_nslookupDomainChecked = false;
-  eth_nslookupDNSserachlistChecked = false;
+  eth_nslookupStarted = false;
+  eth_nslookupDone = false;
 }  // void eth_initalizeReceivedPackets()
 
+// Count the result of the structural check of a received frame, returns true if it is valid
+bool eth_checkFrame(eFrameType type, eFrameCheck check) {
+#ifdef DEBUGSERIAL
+  if (check != frame_Valid)
+    Serial.printf("eth_checkFrame(): frame type %u rejected, reason %u\n", type, check);
+#endif
+  return frame_count(type, check);
+}  // bool eth_checkFrame(eFrameType type, eFrameCheck check)
+
+// Record a milestone of the link-up timeline, returns true if it was reached for the first time
+bool eth_markTimeline(eTimelineEvent event) {
+  if (!timeline_mark(event, millis()))
+    return false;
+#ifdef DEBUGSERIAL
+  Serial.printf("Timeline: %s %lums after link-up\n", timeline_label(event), (unsigned long)timeline_get(event));
+#endif
+  return true;
+}  // bool eth_markTimeline(eTimelineEvent event)
+
+// Store a decoded LLDP or CDP neighbor in the neighbor table
+void eth_storeNeighbor(PINFO *neighbor, uint32_t digest) {
+  if (!pinfo_isSet(neighbor, pinfo_Proto))
+    return;
+
+  neighbor_update(neighbor, digest, millis());
+  tft_updateHeader(false);
+
+  // Stop fast start with the first network policy
+  if (neighbor->proto == pinfo_ProtoLLDP) {
+    eth_markTimeline(timeline_FirstLLDP);
+    if (((neighbor->lldp.fields & PINFO_FIELD(lldporg_Policy)) != 0) && eth_markTimeline(timeline_LldpPolicy))
+      eth_lldpFastCount = 0;
+  }
+
+  // Stop CDP fast start with the first voice VLAN
+  if (neighbor->proto == pinfo_ProtoCDP) {
+    eth_markTimeline(timeline_FirstCDP);
+    if (pinfo_isSet(neighbor, pinfo_VoiceVLAN) && eth_markTimeline(timeline_CdpVoice))
+      eth_cdpFastCount = 0;
+  }
+
+  if (pinfo_isSet(neighbor, pinfo_VoiceVLAN)) {
+    if (eth_voiceVLAN == 0) {
+      eth_voiceVLAN = neighbor->voiceVLAN;
+      eth_markTimeline(timeline_VoiceVLAN);
+    }
+  }
+}  // void eth_storeNeighbor(PINFO *neighbor, uint32_t digest)
+
 // Initialie Ethernet hardware and connection
 bool eth_initialize() {
 #ifdef DEBUGSERIAL
@@ -1263,7 +1391,7 @@ bool eth_initialize() {
 #ifdef DEBUGSERIAL
     Serial.printf("Revision of ENC26j80 chip detected: %d\n", initENC);
 #endif
-    ether.dhcpAddOptionCallback(15, DHCPOption);
+    dhcpc_init(eth_myMAC, TXT_GEN_DEVNAME);
   } else {
 #ifdef DEBUGSERIAL
     Serial.printf("Revision of ENC26j80 chip detection returned 0.\n");
@@ -1271,8 +1399,9 @@ bool eth_initialize() {
     return false;
   }
 
-  // Set ENC to promiscuous mode
-  ENC28J60::enablePromiscuous();
+  // Only receive the frames of the own address, broadcasts and LLDP / CDP multicasts unless
+  // promiscuous receive is selected in the menu
+  enc_setFilter((eEncFilter)tft_userMenu[TFT_MENUENTRY_PROMISCUOUS].value);
 
   // Start with disabled VLAN tagging
   ENC28J60::disable_VLAN_tagging();
@@ -1293,6 +1422,7 @@ bool eth_initialize() {
 // Stop Ethernet module and putting to sleep
 void eth_stop() {
   bool enc_powerdUp;
+  eth_lock();
   enc_powerdUp = ENC28J60::isPoweredUp();
   if (enc_powerdUp) {
 #ifdef DEBUGSERIAL
@@ -1305,12 +1435,14 @@ void eth_stop() {
   else
     Serial.println("eth_stop(): ENC28J60 already powered down.");
 #endif
+  eth_unlock();
 }  // void eth_stop()
 
 
 // Restart Ethernet module
 void eth_restart() {
   bool enc_powerdUp;
+  eth_lock();
   enc_powerdUp = ENC28J60::isPoweredUp();
   if (!enc_powerdUp) {
 #ifdef DEBUGSERIAL
@@ -1322,10 +1454,91 @@ void eth_restart() {
   else
     Serial.println("eth_restart(): ENC28J60 already awake.");
 #endif
+  eth_unlock();
   tft_displayData1[TFT_HEADERENTRY_ETH].color = TFT_BLUE;
 }  // void eth_restart()
 
 
+// Switch between the receive filters and promiscuous receive and store the setting
+void eth_toggleReceiveFilter() {
+  eEncFilter filter = (tft_userMenu[TFT_MENUENTRY_PROMISCUOUS].value == enc_Filtered) ? enc_Promiscuous : enc_Filtered;
+  tft_userMenu[TFT_MENUENTRY_PROMISCUOUS].value = filter;
+  savePreferencesPromiscuous(filter == enc_Promiscuous);
+  if (gen_currentFunction == fEthernet) {
+    eth_lock();
+    enc_setFilter(filter);
+    eth_unlock();
+  }
+}  // void eth_toggleReceiveFilter()
+
+// Start the DHCP sweep of the VLANs selected in the menu at the selected rate or stop a running
+// sweep. Returns true if a sweep has been started.
+bool eth_toggleSweep() {
+  bool started = false;
+  eth_lock();
+  if (sweep_state() == sweep_Running)
+    sweep_stop();
+  else {
+    sweep_clearVLANs();
+    byte range = tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].value;
+    if (range < eth_sweepRangesCount)
+      sweep_addVLANs(eth_sweepRanges[range].first, eth_sweepRanges[range].last);
+    else {
+      // VLANs seen in the received tagged frames, VLAN 0 of priority tagged frames is skipped
+      for (int16_t vlan = vlan_next(-1); vlan >= 0; vlan = vlan_next(vlan))
+        sweep_addVLANs(vlan, vlan);
+    }
+    started = sweep_start(eth_sweepRates[tft_userMenu[TFT_MENUENTRY_SWEEPRATE].value], millis());
+  }
+  eth_unlock();
+  return started;
+}  // bool eth_toggleSweep()
+
+// Take the ENC28J60 and the EtherCard buffer from the receive task, may be nested
+void eth_lock() {
+  xSemaphoreTakeRecursive(xMutex_eth, portMAX_DELAY);
+}  // void eth_lock()
+
+void eth_unlock() {
+  xSemaphoreGiveRecursive(xMutex_eth);
+}  // void eth_unlock()
+
+// Receive task: copy the frames of the ENC28J60 into buffers of the frame pool and pass them to
+// the loop through the frame ring. A full ring or pool drops the frame and counts it, the ENC28J60
+// buffer is emptied anyway. Overflows of the ENC28J60 buffer are counted while it is empty.
+void eth_rxTask(void *parameter) {
+  while (true) {
+    uint16_t plen = 0;
+    eth_lock();
+    // The loop may have stopped the ENC28J60 while the task was waiting for the mutex
+    if ((gen_currentFunction == fEthernet) && eth_ENCLink) {
+      plen = ether.packetReceive();
+      if (plen == 0)
+        enc_checkOverflow();
+      else {
+        enc_countFrame(Ethernet::buffer, plen);
+        // With VLAN tagging enabled the library removes the tag of the voice VLAN frames
+        bool tagged = ENC28J60::packet_Received_Was_Tagged();
+        vlan_record(Ethernet::buffer, plen, tagged ? eth_voiceVLAN : 0);
+        FRAME_BUFFER *rxBuffer = ring_reserve();
+        if (rxBuffer != NULL) {
+          if (plen > POOL_FRAMELEN)
+            plen = POOL_FRAMELEN;
+          memcpy(rxBuffer->frame, Ethernet::buffer, plen);
+          rxBuffer->length = plen;
+          rxBuffer->tagged = tagged;
+          ring_commit(rxBuffer);
+        }
+      }
+    }
+    eth_unlock();
+
+    // Only wait if the ENC28J60 is empty
+    if (plen == 0)
+      vTaskDelay(1);
+  }
+}  // void eth_rxTask(void *parameter)
+
 // Process ethernet part
 void eth_process() {
   //  static unsigned long lastENCLinkCheck = gen_currentMillis;
@@ -1333,30 +1546,49 @@ void eth_process() {
   //  static bool isVLANTaggingEnabled = ENC28J60::is_VLAN_tagging_enabled();
   //  static bool receivedPacketWasTagged = false;
 
-  // Periodically send LLDP-MED packets
-  if ((gen_currentMillis >= (eth_lastLLDPsent + ETH_LASTLLDPINTERVAL))) {
-    send_LLDP_MED(ETH_BUFFERSIZE, eth_voiceVLAN, &eth_lastLLDPsent, &eth_myMAC[0]);
+  eth_lock();
+
+  // Periodically send LLDP-MED packets, faster during fast start
+  unsigned long interval = (eth_lldpFastCount > 0) ? ETH_LLDPFASTINTERVAL : ETH_LASTLLDPINTERVAL;
+  if ((gen_currentMillis >= (eth_lastLLDPsent + interval))) {
+    send_LLDP_MED(eth_voiceVLAN, &eth_lastLLDPsent);
+    if (eth_lldpFastCount > 0)
+      eth_lldpFastCount--;
   }
+
+  // Periodically send CDP packets, faster during fast start
+  interval = (eth_cdpFastCount > 0) ? ETH_CDPFASTINTERVAL : ETH_CDPINTERVAL;
+  if ((gen_currentMillis >= (eth_lastCDPsent + interval))) {
+    send_CDP(eth_voiceVLAN, &eth_lastCDPsent);
+    if (eth_cdpFastCount > 0)
+      eth_cdpFastCount--;
+  }
+
+  eth_unlock();
 }  // void eth_process( void )
 
 
-// Check link status for changes
+// Check link status for changes. The ENC28J60 is only locked while it is accessed, so the
+// receive task keeps draining it while the page is drawn.
 bool eth_linkStatus() {
+  eth_lock();
   bool eth_currentLinkStatus = ENC28J60::isLinkUp();
   if (eth_ENCLink != eth_currentLinkStatus || gen_justBooted == true) {
     eth_ENCLink = eth_currentLinkStatus;
-    eth_linkUpMillis = millis();
     if (eth_currentLinkStatus) {
-      // Reset DHCP array to defaults
-      for (byte i = 0; i < 1; i++) {
-        for (byte j = 0; j < 255; ++j) {
-          eth_dhcpInfo[i][j].Option[0] = "-";
-          eth_dhcpInfo[i][j].Option[1] = "-";
-        }
-      }
-
-      eth_resetPinfo(&eth_lldpPacket);
-      eth_resetPinfo(&eth_cdpPacket);
+      // Start the timeline of the discovery milestones
+      timeline_start(millis());
+
+      // Stop the DHCP contexts and remove the received DHCP options
+      dhcpc_reset();
+      dhcp_reset(&eth_dhcpInfo[DHCPC_UNTAGGED]);
+      dhcp_reset(&eth_dhcpInfo[DHCPC_VOICE]);
+
+      neighbor_clear();
+      sweep_stop();
+      dns_reset();
+      vlan_reset();
+      ring_flush();
       eth_initalizeReceivedPackets();
 
       gen_justBooted = false;
@@ -1369,134 +1601,141 @@ bool eth_linkStatus() {
       ENC28J60::disable_VLAN_tagging();
       eth_inittializeNTPSources();
       eth_startDHCP();
-      tft_showPage();
 
-      // Send LLDP-MED packet
-      send_LLDP_MED(ETH_BUFFERSIZE, eth_voiceVLAN, &eth_lastLLDPsent, &eth_myMAC[0]);
+      // Send LLDP-MED packet and start the fast start burst
+      send_LLDP_MED(eth_voiceVLAN, &eth_lastLLDPsent);
+      eth_lldpFastCount = ETH_LLDPFASTCOUNT - 1;
+
+      // Send CDP packet and start the fast start burst
+      send_CDP(eth_voiceVLAN, &eth_lastCDPsent);
+      eth_cdpFastCount = ETH_CDPFASTCOUNT - 1;
+      eth_unlock();
+
+      tft_showPage();
     }  // if (eth_currentLinkStatus)
     else {
+      eth_unlock();
       tft_displayData1[TFT_HEADERENTRY_ETH].color = TFT_BLUE;
 #ifdef DEBUGSERIAL
       Serial.println("eth_linkStatus(): ETH TFT_BLUE");
 #endif
       tft_updateHeader(false);
-      memset(Ethernet::buffer, 0, ETH_BUFFERSIZE);
-      memset(eth_buffcheck, 0, ETH_BUFFERSIZE);
       gen_justBooted = false;
     }
-  }
+  } else
+    eth_unlock();
 
   return eth_currentLinkStatus;
 }  // bool eth_linkStatus()
 
-// Start DHCP request
+// Start the untagged DHCP lease
 void eth_startDHCP() {
-  eth_vlanOption = 0;
-  if (ENC28J60::is_VLAN_tagging_enabled())
-    eth_vlanOption = 1;
-  //  if( ENC28J60::is_VLAN_tagging_enabled() )
-  //  {
-  //    eth_vlanOption = 1;
-  //    eth_vlanDhcpReceived = false;
-  //  }
-  //  else
-  //  {
-  //    eth_vlanOption = 0;
-  //    eth_dhcpReceived = false;
-  //  }
-
-  // Reset Array to defaults.
-  for (int j = 0; j < 255; ++j) {
-    eth_dhcpInfo[eth_vlanOption][j].Option[0] = "-";
-    eth_dhcpInfo[eth_vlanOption][j].Option[1] = "-";
-  }
-
   eth_dhcpReceived = false;
-  //ether.dhcpSetup(eth_dhcpName);
-  ether.dhcpSetup(TXT_GEN_DEVNAME);
-
-  eth_dhcpStart = millis();
+  dhcpc_lease(DHCPC_UNTAGGED, 0, &eth_dhcpInfo[DHCPC_UNTAGGED], ETH_DHCPTIMEOUT, millis());
 }  // void eth_startDHCP()
 
-// Check current package for DHCP ports
-unsigned int eth_dhcpCheckPacket(byte EthBuffer[], unsigned int length) {
-  if (length >= 60) {
-    uint16_t srcPort = (EthBuffer[UDP_SRC_PORT_H_P] << 8) | (EthBuffer[UDP_SRC_PORT_H_P]);
-    if (srcPort == DHCP_SERVER_PORT) {
-      // CDP Packet found and is now getting processed
-      tft_updateHeader(false);
-      return length;
+// Follow the untagged and the voice VLAN lease. A new or changed untagged lease configures the
+// address of EtherCard, the voice VLAN lease is given back, only its options are displayed.
+// Returns true if the header has to be updated.
+bool eth_checkDhcp() {
+  bool changed = false;
+
+  // The DISCOVER is sent when selecting and the REQUEST after the OFFER
+  const DHCPC_CONTEXT *lease = dhcpc_getContext(DHCPC_UNTAGGED);
+  if ((lease->state == dhcpc_Selecting) && (lease->sent != 0))
+    eth_markTimeline(timeline_DhcpDiscover);
+  else if (lease->state == dhcpc_Requesting)
+    changed |= eth_markTimeline(timeline_DhcpOffer);
+  else if ((lease->state == dhcpc_Bound) && (!eth_dhcpReceived || (memcmp(ether.myip, lease->ip, IP_LEN) != 0))) {
+    eth_dhcpReceived = true;
+    ether.staticSetup(lease->ip, lease->gateway, lease->dns, lease->mask);
+    eth_markTimeline(timeline_DhcpBound);
+    changed = true;
+#ifdef DEBUGSERIALx
+    Serial.println(" \nDHCP address and options received:");
+    // Write all received options to the serial console
+    const DHCP_DATA *store = &eth_dhcpInfo[DHCPC_UNTAGGED];
+    char value[DHCP_VALUELEN];
+    for (byte i = 0; i < store->count; i++) {
+      uint8_t code = store->options[i].code;
+      if (dhcp_getValue(store, code, value, sizeof(value)))
+        Serial.printf("%u: %s=%s\n", code, dhcp_optionLabel(code), value);
     }
-  } // if (length >= 60)
-
-  return 0;
-} // unsigned int eth_dhcpCheckPacket(byte EthBuffer[], unsigned int length)
-
-// Check packet data and run the DHCP state machine if necessary
-uint16_t eth_callDhcpStateMachine(uint16_t plen) {
-  if (!ENC28J60::isLinkUp())
-    return plen;
+#endif
+  }
 
-  unsigned int dhcp_correct = 0;
-  if ((ether.dhcpState != EtherCard::DHCP_STATE_BOUND) && ((millis() - eth_dhcpStart) < ETH_DHCPTIMEOUT) && (ENC28J60::isLinkUp()) && ((millis() - eth_dhcpStart) > 0l)) {
-    dhcp_correct = eth_dhcpCheckPacket(eth_buffcheck, plen);
-    ether.DhcpStateMachine(plen);
+  if (dhcpc_state(DHCPC_VOICE) == dhcpc_Bound) {
+    eth_vlanDhcpReceived = true;
+    dhcpc_release(DHCPC_VOICE);
+    eth_markTimeline(timeline_VoiceBound);
+    changed = true;
   }
+  return changed;
+}  // bool eth_checkDhcp()
 
-  if (dhcp_correct > 0)
-    plen = 0;  // DHCP packet was processed so no need to do CDP or LLDP checks
+// Queue a name for the DNS lookups of the NTP sources, names already queued are skipped
+void eth_queueDnsLookup(const char *name) {
+  if (eth_dnsCount >= DNS_MAXQUERIES)
+    return;
 
-  if ((ether.dhcpState == EtherCard::DHCP_STATE_BOUND) && (eth_dhcpReceived == false))
-  //  if( ( ether.dhcpState == EtherCard::DHCP_STATE_BOUND ) &&
-  //    ( ( !eth_dhcpReceived && !ENC28J60::is_VLAN_tagging_enabled() ) || ( !eth_vlanDhcpReceived && ENC28J60::is_VLAN_tagging_enabled() ) )
-  //  )
-  {
-    // DHCP has entered into bound state
-    eth_dhcpReceived = true;
-    ether.updateBroadcastAddress();
-    ether.delaycnt = 0;
-
-    // Convert received UIP address into a string for the eth_dhcpInfo array
-    String ipaddy;
-    for (byte j = 0; j < 4; ++j) {
-      ipaddy += String(ether.myip[j]);
-      if (j < 3) {
-        ipaddy += ".";
-      }
-    }
+  int8_t handle = dns_query(name, millis());
+  if (handle < 0)
+    return;
+  for (byte i = 0; i < eth_dnsCount; i++) {
+    if (eth_dnsHandles[i] == handle)
+      return;
+  }
+  eth_dnsHandles[eth_dnsCount++] = handle;
+#ifdef DEBUGSERIAL
+  Serial.print("NS lookup for domain:");
+  Serial.println(name);
+#endif
+}  // void eth_queueDnsLookup(const char *name)
 
-    eth_vlanOption = 0;
-    if (ENC28J60::is_VLAN_tagging_enabled())
-      eth_vlanOption = 1;
-    //    if( ENC28J60::is_VLAN_tagging_enabled() )
-    //    {
-    //      eth_vlanOption = 1;
-    //      eth_vlanDhcpReceived = true;
-    //    }
-    //    else
-    //    {
-    //      eth_vlanOption = 0;
-    //      eth_dhcpReceived = true;
-    //    }
-
-    eth_dhcpInfo[eth_vlanOption][0].Option[0] = "IP";  // Option 0 is not used
-    eth_dhcpInfo[eth_vlanOption][0].Option[1] = ipaddy;
-
-    // Update header
-    tft_updateHeader(false);
+// Start the DNS lookups of the DNS domain and the domain search list, they are resolved in parallel
+void eth_startDnsLookups() {
+  char names[DHCP_VALUELEN];
+  dns_cancel();
+  eth_dnsCount = 0;
 
-#ifdef DEBUGSERIALx
-    Serial.println(" \nDHCP address and options received:");
-    // Write all received options to the serial console
-    for (byte i = 0; i < 254; i++) {
-      if (eth_dhcpInfo[eth_vlanOption][i].Option[1] != "-")
-        Serial.println(String(i, DEC) + ": " + eth_dhcpInfo[eth_vlanOption][i].Option[0] + "=" + eth_dhcpInfo[eth_vlanOption][i].Option[1]);
+  if (dhcp_getValue(&eth_dhcpInfo[0], 15, names, sizeof(names)))
+    eth_queueDnsLookup(names);
+#ifdef DEBUGSERIAL
+  else
+    Serial.println("No DNS name provided.");
+#endif
+
+  // One domain per line
+  if (dhcp_getValue(&eth_dhcpInfo[0], 119, names, sizeof(names))) {
+    char *part = names;
+    while (part != NULL) {
+      char *next = strchr(part, '\n');
+      if (next != NULL)
+        *next++ = '\0';
+      eth_queueDnsLookup(part);
+      part = next;
     }
+  }
+#ifdef DEBUGSERIAL
+  else
+    Serial.println("No domain name search list provided.");
 #endif
-  } // if ((ether.dhcpState == EtherCard::DHCP_STATE_BOUND) && (eth_dhcpReceived == false))
+}  // void eth_startDnsLookups()
 
-  return plen;
-}  // uint16_t eth_callDhcpStateMachine(uint16_t plen)
+// Add the resolved addresses of the DNS lookups to the NTP sources
+void eth_storeDnsResults() {
+  for (byte i = 0; i < eth_dnsCount; i++) {
+    const byte *ip = dns_getIP(eth_dnsHandles[i]);
+#ifdef DEBUGSERIAL
+    char text[FMT_IPV4LEN];
+    if (ip != NULL)
+      fmt_ipv4(text, sizeof(text), ip);
+    Serial.printf("%s: %s\n", dns_getName(eth_dnsHandles[i]), (ip != NULL) ? text : "DNS failed");
+#endif
+    if ((ip != NULL) && (eth_ntpSources < ETH_NTPMAXSOURCES))
+      IPv4NTP(ip, IP_LEN);
+  }
+}  // void eth_storeDnsResults()
 
 // Initialize the eth_ntpSources value and the IP array
 void eth_inittializeNTPSources() {
@@ -1510,10 +1749,11 @@ void eth_inittializeNTPSources() {
   eth_ntpRequestStarted = 0l;
   eth_timeFromNTP = 0l;
   eth_ntpRequestStatus = NTP_INIT;
-  eth_ntpServer = "";
+  eth_ntpServer[0] = '\0';
+  ntp_stop();
 } // void eth_inittializeNTPSources()
 
-// Start NTP request
+// Send NTP requests to all sources, the replies are received by the loop
 void eth_startNTPRequests() {
 #ifdef DEBUGSERIAL
   Serial.println("eth_startNTPRequests()");
@@ -1521,116 +1761,104 @@ void eth_startNTPRequests() {
   bool isENCLinkUp = ENC28J60::isLinkUp();
 
   // Get time from network
-  if ((isENCLinkUp) && (eth_ntpRequestStatus == NTP_INIT) && (eth_dhcpReceived))
-  //  if( ( isENCLinkUp ) && ( eth_ntpRequestStatus == NTP_INIT ) &&
-  //    ( ( eth_dhcpReceived && !ENC28J60::is_VLAN_tagging_enabled() ) || ( eth_vlanDhcpReceived && ENC28J60::is_VLAN_tagging_enabled() ) )
-  //  )
-  {
-    if ((eth_ntpRequestStarted == 0l) || (eth_ntpRequestStatus == NTP_INIT)) {
-      byte i = 0;
-      eth_timeFromNTP = 0l;
-      while ((i < eth_ntpSources) && (eth_timeFromNTP == 0l)) {
-#ifdef DEBUGSERIAL
-        Serial.print("Start NTP request source=");
-        Serial.println(String(i));
-#endif
-        eth_timeFromNTP = eth_getNtpTime(i);
-        if (eth_timeFromNTP != 0l) {
-          eth_ntpRequestStatus = NTP_OK;
-          eth_timeFromNTP += eth_timeZoneOffset;
+  if ((isENCLinkUp) && (eth_ntpRequestStatus == NTP_INIT) && (eth_dhcpReceived) && (ntp_state() != ntp_Running)) {
+    eth_timeFromNTP = 0l;
+    eth_ntpRequestStarted = millis();
+    if (ntp_start(eth_ntpIPs, eth_ntpSources, eth_ntpRequestStarted))
+      eth_ntpRequestStatus = NTP_RUNNING;
+    else
+      eth_finishNTPRequests();
+  }
+}  // void eth_startNTPRequests()
+
+// Set the time of the selected NTP source when all replies are received or the timeout has passed
+void eth_finishNTPRequests() {
+  int8_t best = ntp_best();
+  if (best >= 0) {
+    eth_timeFromNTP = ntp_getTime(millis());
+    eth_ntpRequestStatus = NTP_OK;
+    eth_timeFromNTP += eth_timeZoneOffset;
 #ifdef DEBUGSERIAL
-          Serial.print("NTP reply received time");
-          if (eth_timeZoneOffset == 0l)
-            Serial.print("(UTC) ");
-          Serial.print(": " + String(eth_timeFromNTP));
+    Serial.print("NTP reply received time");
+    if (eth_timeZoneOffset == 0l)
+      Serial.print("(UTC) ");
+    Serial.println(": " + String(eth_timeFromNTP));
 #endif
-          esprtc.setTime(eth_timeFromNTP);
-          tft_displayData1[TFT_HEADERENTRY_RTC].color = TFT_DARKGREEN;
+    esprtc.setTime(eth_timeFromNTP);
+    tft_displayData1[TFT_HEADERENTRY_RTC].color = TFT_DARKGREEN;
 #ifdef DEBUGSERIAL
-          Serial.println("eth_startNTPRequests(): RTC TFT_DARKGREEN");
+    Serial.println("eth_finishNTPRequests(): RTC TFT_DARKGREEN");
 #endif
 
 #ifdef USE_RTCTIME
-          if (ertc_present)
-            rtc.adjust(DateTime(eth_timeFromNTP));
+    if (ertc_present)
+      rtc.adjust(DateTime(eth_timeFromNTP));
 #endif
 #ifdef DEBUGSERIAL
-          // formating options  http://www.cplusplus.com/reference/ctime/strftime/
-          Serial.println(esprtc.getTime("%A, %B %d %Y %H:%M:%S")) + String(" (UTC)");  // (String) returns time with specified format
-#endif
-          eth_currentNTPSource = i;
-          eth_ntpReceived = true;
-          eth_ntpServer = "";
-          for (byte j = 0; j < IP_LEN; j++) {
-            eth_ntpServer += String(eth_ntpIPs[eth_currentNTPSource][j]);
-            if (j < (IP_LEN - 1))
-              eth_ntpServer += ".";
-          }
-          tft_updateHeader(false);
-          break;
-        } // if (eth_timeFromNTP != 0l)
-        i++;
-      } // while ((i < eth_ntpSources) && (eth_timeFromNTP == 0l))
-
-      // still in INIT state?
-      if (eth_ntpRequestStatus == NTP_INIT)
-        eth_ntpRequestStatus = NTP_FAILED;
-
-#ifdef DEBUGSERIAL
-      Serial.print("NTP request finished: ");
-      Serial.println(eth_ntpRequestStatus);
-      Serial.println("Time: " + String(eth_timeFromNTP));
+    // formating options  http://www.cplusplus.com/reference/ctime/strftime/
+    Serial.println(esprtc.getTime("%A, %B %d %Y %H:%M:%S") + String(" (UTC)"));  // (String) returns time with specified format
 #endif
-    }  // if ((eth_ntpRequestStarted == 0l) || (eth_ntpRequestStatus == NTP_INIT))
-  }    // if ((isENCLinkUp) && (eth_ntpRequestStatus == NTP_INIT) && (eth_dhcpReceived))
-}  // void eth_startNTPRequests()
+    eth_currentNTPSource = best;
+    eth_ntpReceived = true;
+    eth_markTimeline(timeline_NtpOK);
+    fmt_ipv4(eth_ntpServer, sizeof(eth_ntpServer), ntp_getSource(best)->ip);
+    tft_updateHeader(false);
+  } else
+    eth_ntpRequestStatus = NTP_FAILED;
 
-unsigned long eth_getNtpTime(byte src) {
-  ether.ntpRequest(eth_ntpIPs[src], NTP_PORT);
-  unsigned long beginWait = millis();
-  while (millis() - beginWait < ETH_NTPTIMEOUT) {
-    word length = ether.packetReceive();
-    ether.packetLoop(length);
-    if (length > 0 && ether.ntpProcessAnswer(&eth_timeFromNTP, NTP_PORT)) {
-      Serial.print("Time from NTP: ");
-      Serial.println(eth_timeFromNTP);
-      return eth_timeFromNTP - GEN_SEVENTY_YEARS;
-    }
+#ifdef DEBUGSERIAL
+  char value[NTP_SOURCELEN];
+  Serial.printf("NTP request finished after %lums: %u\n", millis() - eth_ntpRequestStarted, eth_ntpRequestStatus);
+  for (byte i = 0; i < ntp_sourceCount(); i++) {
+    const NTP_SOURCE *source = ntp_getSource(i);
+    char ip[FMT_IPV4LEN];
+    fmt_ipv4(ip, sizeof(ip), source->ip);
+    ntp_printSource(source, value, sizeof(value));
+    Serial.printf("  %s%s: %s\n", (i == best) ? "*" : " ", ip, value);
   }
-  return 0;
-}  // unsigned long eth_getNtpTime(byte src)
-
-// Reset PINFO structures / values. Modev this into Ethernet part because the data is collected
-// by Ethernet only, neither BLuetooth nor WiFi.
-void eth_resetPinfo(PINFO *info) {
-  info->ChassisID[1] = "-";
-  info->Proto[1] = "-";
-  info->ProtoVer[1] = "-";
-  info->SWName[1] = "-";
-  info->SWDomain[1] = "-";
-  info->MAC[1] = "-";
-  info->Port[1] = "-";
-  info->PortDesc[1] = "-";
-  info->Model[1] = "-";
-  info->VLAN[1] = "-";
-  info->IP[1] = "-";
-  info->VoiceVLAN[1] = "-";
-  info->Cap[1] = "-";
-  info->SWver[1] = "-";
-  info->TTL[1] = "-";
-  info->VTP[1] = "-";
-  info->Dup[1] = "-";
-  info->PoEAvail[1] = "-";
-  info->PoECons[1] = "-";
-  info->MgmtIP[1] = "-";
-  info->MgmtVLAN[1] = "-";
-  info->Checksum[1] = "-";
-}  // void eth_resetPinfo( PINFO *info )
+#endif
+}  // void eth_finishNTPRequests()
 
 
 // *************************************************************************
 // Serial console and debug functions
 #ifdef DEBUGSERIAL
+// Print all received values of the neighbors of a protocol
+void dbg_printNeighbors(ePinfoProto proto) {
+  char value[PINFO_VALUELEN];
+  for (int8_t slot = neighbor_next(proto, -1); slot >= 0; slot = neighbor_next(proto, slot)) {
+    PINFO *info = neighbor_get(proto, slot);
+    Serial.printf("%s neighbor %d:\n", (proto == pinfo_ProtoCDP) ? "CDP" : "LLDP", slot);
+    for (byte i = 0; i < pinfo_FieldCount; i++) {
+      if (PINFO_FIELDS[i].exported && pinfo_getValue(info, (ePinfoField)i, value, sizeof(value)))
+        Serial.printf("  %s=%s\n", PINFO_FIELDS[i].label, value);
+    }
+  }
+}  // void dbg_printNeighbors(ePinfoProto proto)
+
+// Print the VLANs found by the DHCP sweep
+void dbg_printSweep() {
+  char value[SWEEP_RESULTLEN];
+  Serial.printf("DHCP sweep: %u of %u VLANs probed, %u with DHCP server\n", sweep_probed(), sweep_total(), sweep_found());
+  for (uint8_t i = 0; i < sweep_resultCount(); i++) {
+    const SWEEP_RESULT *result = sweep_getResult(i);
+    sweep_printResult(result, value, sizeof(value));
+    Serial.printf("  VLAN %u: %s\n", result->vlan, value);
+  }
+}  // void dbg_printSweep()
+
+// Print the time from link-up to the discovery milestones
+void dbg_printTimeline() {
+  Serial.println("Timeline after link-up:");
+  for (byte i = 0; i < timeline_EventCount; i++) {
+    uint32_t delay = timeline_get((eTimelineEvent)i);
+    if (delay != 0)
+      Serial.printf("  %s: %lums\n", timeline_label((eTimelineEvent)i), (unsigned long)delay);
+    else
+      Serial.printf("  %s: -\n", timeline_label((eTimelineEvent)i));
+  }
+}  // void dbg_printTimeline()
+
 // Process serial interface, used for controlling using the serial monitor
 void dbg_process() {
   if (Serial.available()) {
@@ -1645,7 +1873,12 @@ void dbg_process() {
       Serial.println("aa: Button 1 long press");
       Serial.println("b: Button 2 short press");
       Serial.println("bb: Button 2 long press");
+      Serial.println("n: print LLDP and CDP neighbors");
       Serial.println("r: rotate screen");
+      Serial.println("s: start / stop the DHCP sweep of the VLANs selected in the menu");
+      Serial.println("s <first> <last>: start the DHCP sweep of VLAN first-last");
+      Serial.println("f: switch between filtered and promiscuous receive");
+      Serial.println("t: print the timeline after link-up");
       Serial.println("v: switch VLAN tagging");
 
       //Serial.println( F( "startdhcp: start DHCP and waiting for an IP address" ) );
@@ -1658,11 +1891,41 @@ void dbg_process() {
       btn_btn2ShortClick();
     //  else if (command == "bb")
     //      btn_btn2LongClick();
-    else if (command == "r") {
+    else if (command == "n") {
+      dbg_printNeighbors(pinfo_ProtoLLDP);
+      dbg_printNeighbors(pinfo_ProtoCDP);
+    } else if (command == "r") {
       tft_rotateScreen();
+    } else if (command == "s") {
+      if (sweep_state() == sweep_Running) {
+        eth_toggleSweep();
+        dbg_printSweep();
+      } else if (eth_toggleSweep())
+        Serial.println("DHCP sweep started.");
+      else
+        Serial.println("DHCP sweep not started, no VLANs to probe.");
+    } else if (command.startsWith("s ")) {
+      // Range given on the console, started at the rate selected in the menu
+      unsigned int first = 0;
+      unsigned int last = 0;
+      bool started = false;
+      if ((sscanf(command.c_str(), "s %u %u", &first, &last) == 2) && (last <= SWEEP_MAXVLAN)) {
+        eth_lock();
+        sweep_clearVLANs();
+        if (sweep_addVLANs(first, last))
+          started = sweep_start(eth_sweepRates[tft_userMenu[TFT_MENUENTRY_SWEEPRATE].value], millis());
+        eth_unlock();
+      }
+      Serial.println(started ? "DHCP sweep started." : "DHCP sweep not started, VLAN range 1-4094 expected.");
+    } else if (command == "f") {
+      eth_toggleReceiveFilter();
+      Serial.println((tft_userMenu[TFT_MENUENTRY_PROMISCUOUS].value == enc_Filtered) ? "Receive filters enabled." : "Promiscuous receive enabled.");
+    } else if (command == "t") {
+      dbg_printTimeline();
     } else if (command == "v") {
       if (eth_voiceVLAN != 0) {
         Serial.print("VLAN tagging has been ");
+        eth_lock();
         if (ENC28J60::is_VLAN_tagging_enabled()) {
           ENC28J60::disable_VLAN_tagging();
           eth_vLANTagging = false;
@@ -1675,6 +1938,7 @@ void dbg_process() {
           Serial.print(String(eth_voiceVLAN, DEC));
           Serial.println("\n");
         }  // else
+        eth_unlock();
       }    // if( eth_voiceVLAN != 0 )
       else {
         Serial.println("VLAN tagging can't be enabled, no voice VLAN information received yet.");
@@ -2133,7 +2397,7 @@ void tft_updateHeader(bool fillrect) {
   if ((disp_currentScreen == TFT_SCREEN_LLDP1) || (disp_currentScreen == TFT_SCREEN_LLDP2))
     tft.setTextColor(TFT_DARKGREEN, TFT_WHITE);
   else {
-    if (eth_lldpPacketReceived)
+    if (neighbor_count(pinfo_ProtoLLDP) > 0)
       tft.setTextColor(TFT_BLACK, TFT_WHITE);
     else
       tft.setTextColor(TFT_SILVER, TFT_WHITE);
@@ -2144,7 +2408,7 @@ void tft_updateHeader(bool fillrect) {
   if ((disp_currentScreen == TFT_SCREEN_CDP1) || (disp_currentScreen == TFT_SCREEN_CDP2))
     tft.setTextColor(TFT_DARKGREEN, TFT_WHITE);
   else {
-    if (eth_cdpPacketReceived)
+    if (neighbor_count(pinfo_ProtoCDP) > 0)
       tft.setTextColor(TFT_BLACK, TFT_WHITE);
     else
       tft.setTextColor(TFT_SILVER, TFT_WHITE);
@@ -2155,7 +2419,7 @@ void tft_updateHeader(bool fillrect) {
   if (disp_currentScreen == TFT_SCREEN_NTP)
     tft.setTextColor(TFT_DARKGREEN, TFT_WHITE);
   else {
-    if (eth_cdpPacketReceived)
+    if (eth_ntpReceived)
       tft.setTextColor(TFT_BLACK, TFT_WHITE);
     else
       tft.setTextColor(TFT_SILVER, TFT_WHITE);
@@ -2174,15 +2438,38 @@ void tft_updateHeader(bool fillrect) {
   tft.drawString(tft_displayData2[TFT_HEADERENTRY_WIFIDATA].text, tft_displayData2[TFT_HEADERENTRY_WIFIDATA].xPos, tft_displayData2[TFT_HEADERENTRY_WIFIDATA].yPos);
 }  // void tft_updateHeader( bool fillrect )
 
-// Print text array on TFT, separated by colon
-void tft_drawText(String value[2]) {
-  if (value[1] != "-") {
-    tft.setTextColor(TFT_GREEN);
-    tft.print(value[0] + ":");
-    tft.setTextColor(TFT_WHITE);
-    tft.println(value[1]);
+// Print a label and a value on TFT, separated by colon
+void tft_drawText(const char* label, const char* value) {
+  tft.setTextColor(TFT_GREEN);
+  tft.print(label);
+  tft.print(":");
+  tft.setTextColor(TFT_WHITE);
+  tft.println(value);
+}  // void tft_drawText(const char* label, const char* value)
+
+// Print a time in seconds with one decimal on TFT, nothing is printed for 0
+void tft_drawDelay(const char* label, unsigned long delay) {
+  if (delay == 0)
+    return;
+  char value[16];
+  snprintf(value, sizeof(value), "%lu.%lus", delay / 1000, (delay % 1000) / 100);
+  tft_drawText(label, value);
+}  // void tft_drawDelay(const char* label, unsigned long delay)
+
+// Print a received value of PINFO on TFT, nothing is printed if it was not received
+void tft_drawPinfo(PINFO *info, ePinfoField field) {
+  char value[PINFO_VALUELEN];
+  if (pinfo_getValue(info, field, value, sizeof(value)))
+    tft_drawText(PINFO_FIELDS[field].label, value);
+}  // void tft_drawPinfo(PINFO *info, ePinfoField field)
+
+// Print all received values of a page on TFT
+void tft_drawPage(PINFO *info, ePinfoPage page) {
+  for (byte i = 0; i < pinfo_FieldCount; i++) {
+    if (PINFO_FIELDS[i].page == page)
+      tft_drawPinfo(info, (ePinfoField)i);
   }
-}  // void tft_drawText(String value[2])
+}  // void tft_drawPage(PINFO *info, ePinfoPage page)
 
 // Rotate the screen and store the setting
 void tft_rotateScreen() {
@@ -2254,25 +2541,40 @@ void tft_switchScreen() {
     }
   }
 
+  // Show the next LLDP or CDP neighbor before leaving the discovery screens
+  if ((disp_currentScreen == TFT_SCREEN_LLDP2) || (disp_currentScreen == TFT_SCREEN_CDP2)) {
+    int8_t nextSlot = neighbor_next(tft_screenProto(disp_currentScreen), disp_neighborSlot);
+    if (nextSlot >= 0) {
+      disp_neighborSlot = nextSlot;
+      disp_currentScreen--;
+      tft_showPage();
+      return;
+    }
+  }
+
   disp_currentScreen++;
   if (disp_currentScreen > TFT_SCREEN_WIFIS)
     disp_currentScreen = TFT_SCREEN_INFO;
 
   // Check if data for displaying is available
-  if ((disp_currentScreen == TFT_SCREEN_DHCP) && (eth_dhcpInfo[0][0].Option[1] == "-"))  // IP address in option field 0
+  if ((disp_currentScreen == TFT_SCREEN_DHCP) && !dhcp_hasOption(&eth_dhcpInfo[0], DHCP_OPT_IP))  // IP address in option field 0
     disp_currentScreen++;
-  if ((disp_currentScreen == TFT_SCREEN_DHCPVLAN) && (eth_dhcpInfo[1][0].Option[1] == "-"))  // IP address in option field 0 for voice VLAN?
+  if ((disp_currentScreen == TFT_SCREEN_DHCPVLAN) && !dhcp_hasOption(&eth_dhcpInfo[1], DHCP_OPT_IP))  // IP address in option field 0 for voice VLAN?
     disp_currentScreen++;
-  if ((disp_currentScreen == TFT_SCREEN_LLDP1) && (!eth_lldpPacketReceived))
+  if ((disp_currentScreen == TFT_SCREEN_LLDP1) && (neighbor_count(pinfo_ProtoLLDP) == 0))
     disp_currentScreen++;
-  if ((disp_currentScreen == TFT_SCREEN_LLDP2) && (!eth_lldpPacketReceived))
+  if ((disp_currentScreen == TFT_SCREEN_LLDP2) && (neighbor_count(pinfo_ProtoLLDP) == 0))
     disp_currentScreen++;
-  if ((disp_currentScreen == TFT_SCREEN_CDP1) && (!eth_cdpPacketReceived))
+  if ((disp_currentScreen == TFT_SCREEN_CDP1) && (neighbor_count(pinfo_ProtoCDP) == 0))
     disp_currentScreen++;
-  if ((disp_currentScreen == TFT_SCREEN_CDP2) && (!eth_cdpPacketReceived))
+  if ((disp_currentScreen == TFT_SCREEN_CDP2) && (neighbor_count(pinfo_ProtoCDP) == 0))
     disp_currentScreen++;
   if ((disp_currentScreen == TFT_SCREEN_NTP) && (!eth_ntpReceived))
     disp_currentScreen++;
+  if ((disp_currentScreen == TFT_SCREEN_TIMELINE) && (timeline_count() == 0))
+    disp_currentScreen++;
+  if ((disp_currentScreen == TFT_SCREEN_VLANS) && (vlan_seenCount() == 0) && (sweep_state() == sweep_Idle))
+    disp_currentScreen++;
   if (disp_currentScreen == TFT_SCREEN_WIFIS)  // WiFi
   {
     if (wifi_scanForSSID == NULL) {
@@ -2286,6 +2588,10 @@ void tft_switchScreen() {
   if (disp_currentScreen > TFT_SCREEN_WIFIS)
     disp_currentScreen = TFT_SCREEN_INFO;
 
+  // Start with the first neighbor of the protocol
+  if ((disp_currentScreen == TFT_SCREEN_LLDP1) || (disp_currentScreen == TFT_SCREEN_CDP1))
+    disp_neighborSlot = neighbor_next(tft_screenProto(disp_currentScreen), -1);
+
   // Only update screen if it has changed
   if ((displayedScreenCurrent != disp_currentScreen) || (displayedWifi != wifi_Current)) {
     tft_showPage();
@@ -2347,91 +2653,57 @@ void tft_startScreen() {
 void tft_dhcpScreen(byte selection) {
   tft.setCursor(0, tft_userY);
 
-  // IP address received using DHCP
-  if (eth_dhcpInfo[selection][0].Option[1] != "-")
-    tft_drawText(eth_dhcpInfo[selection][0].Option);
-
-  // Network mask
-  if (eth_dhcpInfo[selection][1].Option[1] != "-")
-    tft_drawText(eth_dhcpInfo[selection][1].Option);
-
-  // Default gateway
-  if (eth_dhcpInfo[selection][3].Option[1] != "-")
-    tft_drawText(eth_dhcpInfo[selection][3].Option);
-
-  // Server IP
-  if (eth_dhcpInfo[selection][54].Option[1] != "-")
-    tft_drawText(eth_dhcpInfo[selection][54].Option);
-
-  // Lease time
-  if (eth_dhcpInfo[selection][51].Option[1] != "-")
-    tft_drawText(eth_dhcpInfo[selection][51].Option);
-
-  // DNS Domain name
-  if (eth_dhcpInfo[selection][15].Option[1] != "-")
-    tft_drawText(eth_dhcpInfo[selection][15].Option);
-
-  // DNS
-  if (eth_dhcpInfo[selection][6].Option[1] != "-")
-    tft_drawText(eth_dhcpInfo[selection][6].Option);
+  // IP address, network mask, default gateway, server IP, lease time, DNS domain name and DNS,
+  // followed by the provisioning of IP phones: TFTP servers, SIP servers, Avaya and VLAN ID
+  static const uint8_t options[] = { DHCP_OPT_IP, 1, 3, 54, 51, 15, 6, 66, 150, 120, 242, 132 };
+  char value[DHCP_VALUELEN];
+  for (byte i = 0; i < sizeof(options); i++) {
+    if (dhcp_getValue(&eth_dhcpInfo[selection], options[i], value, sizeof(value)))
+      tft_drawText(dhcp_optionLabel(options[i]), value);
+  }
 } // void tft_dhcpScreen(byte selection)
 
+// Protocol of the neighbors shown on a LLDP or CDP screen
+uint8_t tft_screenProto(uint8_t screen) {
+  if ((screen == TFT_SCREEN_CDP1) || (screen == TFT_SCREEN_CDP2))
+    return pinfo_ProtoCDP;
+  return pinfo_ProtoLLDP;
+}  // uint8_t tft_screenProto(uint8_t screen)
+
+// Neighbor shown on the current LLDP or CDP screen. If it has expired in the meantime
+// the first neighbor of the protocol is selected.
+PINFO *tft_screenNeighbor() {
+  uint8_t proto = tft_screenProto(disp_currentScreen);
+  PINFO *info = neighbor_get(proto, disp_neighborSlot);
+  if (info == NULL) {
+    disp_neighborSlot = neighbor_next(proto, -1);
+    info = neighbor_get(proto, disp_neighborSlot);
+  }
+  return info;
+}  // PINFO *tft_screenNeighbor()
+
 // Display info data for LLDP or CDP
 void tft_discoveryScreen(PINFO *info) {
   tft.setCursor(0, tft_userY);
 
-  // Print used port
-  if (info->Port[1] != "-")
-    tft_drawText(info->Port);
-
-  // Print port description
-  if (info->PortDesc[1] != "-")
-    tft_drawText(info->PortDesc);
-
-  // Print VLAN
-  if (info->VLAN[1] != "-")
-    tft_drawText(info->VLAN);
-
-  // Print Voice VLAN
-  if (info->VoiceVLAN[1] != "-")
-    tft_drawText(info->VoiceVLAN);
-
-  // Print Switch name
-  if (info->SWName[1] != "-")
-    tft_drawText(info->SWName);
-
-  // Print Switch domain
-  if (info->SWDomain[1] != "-")
-    tft_drawText(info->SWDomain);
-
-  // Print Switch IP
-  if (info->IP[1] != "-")
-    tft_drawText(info->IP);
-
-  // Print Switch MAC
-  if (info->MAC[1] != "-")
-    tft_drawText(info->MAC);
-
-  // Print Power over Ethernet available
-  if (info->PoEAvail[1] != "-")
-    tft_drawText(info->PoEAvail);
-
-  // Print Power over Ethernet consumed
-  if (info->PoECons[1] != "-")
-    tft_drawText(info->PoECons);
+  // Port, VLANs, switch and PoE
+  tft_drawPage(info, pinfo_Page1);
 } // void tft_discoveryScreen(PINFO *info)
 
 // Display info data for LLDP or CDP
 void tft_discoveryScreen2(PINFO *info) {
   tft.setCursor(0, tft_userY);
 
-  // Print capabilities
-  if (info->Cap[1] != "-")
-    tft_drawText(info->Cap);
+  // Capabilities, model, LLDP power budget and frame size
+  tft_drawPage(info, pinfo_Page2);
 
-  // Print model
-  if (info->Model[1] != "-")
-    tft_drawText(info->Model);
+  // Time from link-up to the first reply and the voice VLAN
+  if (info->proto == pinfo_ProtoLLDP) {
+    tft_drawDelay("Policy after", timeline_get(timeline_LldpPolicy));
+  } else {
+    tft_drawDelay("Reply after", timeline_get(timeline_FirstCDP));
+    tft_drawDelay("Voice after", timeline_get(timeline_CdpVoice));
+  }
 } // void tft_discoveryScreen2(PINFO *info)
 
 // Display info data for NTP
@@ -2445,16 +2717,85 @@ void tft_ntpScreen() {
 
   tft.setCursor(0, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
   tft.print(eth_ntpServer);
+
+  // Stratum, round-trip delay and offset to the selected server of all sources
+  char ip[FMT_IPV4LEN];
+  char value[NTP_SOURCELEN];
+  tft.setCursor(0, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  for (byte i = 0; i < ntp_sourceCount(); i++) {
+    const NTP_SOURCE *source = ntp_getSource(i);
+    fmt_ipv4(ip, sizeof(ip), source->ip);
+    ntp_printSource(source, value, sizeof(value));
+    tft_drawText(ip, value);
+  }
 } // void tft_ntpScreen()
 
+// Display the time from link-up to the discovery milestones
+void tft_timelineScreen() {
+  tft.setCursor(0, tft_userY);
+
+  for (byte i = 0; i < timeline_EventCount; i++)
+    tft_drawDelay(timeline_label((eTimelineEvent)i), timeline_get((eTimelineEvent)i));
+} // void tft_timelineScreen()
+
+// Display the subnets found by the DHCP sweep and the VLAN IDs of the received tagged frames with
+// their frame counts, as many as fit
+void tft_vlanScreen() {
+  uint8_t rows = (tft_userHeight - tft_userY) / (tft_fontHeight * TFT_SIZESCALER);
+  char label[16];
+  char value[SWEEP_RESULTLEN];
+  tft.setCursor(0, tft_userY);
+  uint8_t row = 0;
+
+  if (sweep_state() != sweep_Idle) {
+    snprintf(value, sizeof(value), "%u/%u", sweep_probed(), sweep_total());
+    tft_drawText("DHCP sweep", value);
+    row++;
+    for (uint8_t i = 0; (i < sweep_resultCount()) && (row++ < rows); i++) {
+      const SWEEP_RESULT *result = sweep_getResult(i);
+      snprintf(label, sizeof(label), "VLAN %u", result->vlan);
+      sweep_printSubnet(result, value, sizeof(value));
+      tft_drawText(label, value);
+    }
+  }
+
+  if (row++ >= rows)
+    return;
+  snprintf(value, sizeof(value), "%u", vlan_seenCount());
+  tft_drawText("VLANs seen", value);
+  for (int16_t vlan = vlan_next(-1); (vlan >= 0) && (row++ < rows); vlan = vlan_next(vlan)) {
+    // VLANs which did not fit into the counter table have no frame count
+    uint32_t frames = vlan_frames(vlan);
+    snprintf(label, sizeof(label), "VLAN %d", vlan);
+    if (frames > 0)
+      snprintf(value, sizeof(value), "%lu", (unsigned long)frames);
+    else
+      snprintf(value, sizeof(value), "-");
+    tft_drawText(label, value);
+  }
+} // void tft_vlanScreen()
+
+// Y position of a menu entry, depends on the first visible entry
+int32_t tft_menuY(uint8_t entry) {
+  return tft_userY + (int32_t)(tft_fontHeight * TFT_SIZESCALER) * (entry - tft_userMenuFirst);
+}  // int32_t tft_menuY(uint8_t entry)
+
 // Display user menu
 void tft_displayMenu() {
+  // Scroll the menu if the selected entry is not visible, the entries outside the user area are clipped
+  uint8_t rows = (tft_userHeight - tft_userY) / (tft_fontHeight * TFT_SIZESCALER);
+  if (tft_userMenuPos < tft_userMenuFirst)
+    tft_userMenuFirst = tft_userMenuPos;
+  else if (tft_userMenuPos >= tft_userMenuFirst + rows)
+    tft_userMenuFirst = tft_userMenuPos - rows + 1;
+  tft.setViewport(0, tft_userY, tft_width, tft_userHeight - tft_userY, false);
+
   uint8_t row = 0;
   tft.setTextWrap(false);
   tft.setTextColor(TFT_YELLOW);
 
   // 1st row: Ethernet
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_ETHERNET].text);
   tft.print(":");
   if (gen_currentFunction == fEthernet)
@@ -2464,7 +2805,7 @@ void tft_displayMenu() {
 
   // -----
   // 2nd row: WiFi
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_WIFI].text);
   tft.print(":");
   if (gen_currentFunction == fWiFi)
@@ -2479,7 +2820,7 @@ void tft_displayMenu() {
 #else
   tft.setTextColor(TFT_SILVER);
 #endif
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_BTSERIAL].text);
   tft.print(":");
 #ifdef USE_BTSERIAL
@@ -2492,7 +2833,7 @@ void tft_displayMenu() {
 #endif
 
   // 4th row: Bluetooth serial logging to SD card
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   // Set color to yellow if Bluetooth serial is enabled
   if (tft_userMenu[TFT_MENUENTRY_BTSERIALLOGSD].isActive)
     tft.setTextColor(TFT_YELLOW);
@@ -2508,7 +2849,7 @@ void tft_displayMenu() {
   // -----
   // 5th row: Serial Logging
   tft.setTextColor(TFT_YELLOW);
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_SERIALLOGGING].text);
   tft.print(":");
   if (gen_currentFunction == fSerialLogger)
@@ -2517,7 +2858,7 @@ void tft_displayMenu() {
     tft.print(TXT_GEN_OFF);
 
   // 6th row: Serial Logging type
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   if (tft_userMenu[TFT_MENUENTRY_SERIALLOGGINGMODE].isActive)
     tft.setTextColor(TFT_YELLOW);
   else
@@ -2535,7 +2876,7 @@ void tft_displayMenu() {
     tft.setTextColor(TFT_YELLOW);
   else
     tft.setTextColor(TFT_SILVER);
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_SERIALSPEED].text);
   tft.print(":");
   if (tft_userMenu[TFT_MENUENTRY_SERIALSPEED].value < sizeof(ser_speeds) / sizeof(ser_speeds[0])) {
@@ -2549,7 +2890,7 @@ void tft_displayMenu() {
     tft.setTextColor(TFT_YELLOW);
   else
     tft.setTextColor(TFT_SILVER);
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_SERIALCONFIGURATION].text);
   tft.print(":");
   tft.print(ser_configurations[tft_userMenu[TFT_MENUENTRY_SERIALCONFIGURATION].value].serName);
@@ -2558,7 +2899,7 @@ void tft_displayMenu() {
   // -----
   // 9th row: Default function: none, Ethernet, WiFi, BT serial, Serial logging
   tft.setTextColor(TFT_YELLOW);
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_DEFAULTFUNCTION].text);
   tft.print(":");
   switch (tft_userMenu[TFT_MENUENTRY_DEFAULTFUNCTION].value) {
@@ -2593,19 +2934,19 @@ void tft_displayMenu() {
 #else
   tft.setTextColor(TFT_SILVER);
 #endif
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_WRITETOLOG].text);
 
   // -----
   // 11th row: Rotate screen
   tft.setTextColor(TFT_YELLOW);
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_ROTATESCREEN].text);
 
   // -----
   // 12th row: Switch delay
   tft.setTextColor(TFT_YELLOW);
-  tft.setCursor(tft_arrowWidth, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * row++);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
   tft.print(tft_userMenu[TFT_MENUENTRY_SCREENSWITCHDELAY].text);
   tft.print(":");
   if(tft_userMenu[TFT_MENUENTRY_SCREENSWITCHDELAY].value != 0)
@@ -2613,12 +2954,61 @@ void tft_displayMenu() {
   else
     tft.print(TXT_GEN_OFF);
 
+  // -----
+  // 13th row: Receive all frames
+  tft.setTextColor(TFT_YELLOW);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
+  tft.print(tft_userMenu[TFT_MENUENTRY_PROMISCUOUS].text);
+  tft.print(":");
+  if (tft_userMenu[TFT_MENUENTRY_PROMISCUOUS].value == enc_Promiscuous)
+    tft.print(TXT_GEN_ON);
+  else
+    tft.print(TXT_GEN_OFF);
+
+  // -----
+  // 14th row: DHCP sweep, the probed VLANs while running
+  if (gen_currentFunction == fEthernet)
+    tft.setTextColor(TFT_YELLOW);
+  else
+    tft.setTextColor(TFT_SILVER);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
+  tft.print(tft_userMenu[TFT_MENUENTRY_SWEEP].text);
+  tft.print(":");
+  if (sweep_state() == sweep_Running) {
+    tft.print(sweep_probed());
+    tft.print("/");
+    tft.print(sweep_total());
+  } else
+    tft.print(TXT_GEN_OFF);
+
+  // -----
+  // 15th row: VLANs of the DHCP sweep
+  tft.setTextColor(TFT_YELLOW);
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
+  tft.print(tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].text);
+  tft.print(":");
+  if (tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].value < eth_sweepRangesCount) {
+    tft.print(eth_sweepRanges[tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].value].first);
+    tft.print("-");
+    tft.print(eth_sweepRanges[tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].value].last);
+  } else
+    tft.print(TXT_ETH_SWEEPSEEN);
+
+  // -----
+  // 16th row: DISCOVERs per second of the DHCP sweep
+  tft.setCursor(tft_arrowWidth, tft_menuY(row++));
+  tft.print(tft_userMenu[TFT_MENUENTRY_SWEEPRATE].text);
+  tft.print(":");
+  tft.print(eth_sweepRates[tft_userMenu[TFT_MENUENTRY_SWEEPRATE].value]);
+  tft.print("/s");
+
 
   // Print arrow at the current position
-  tft.setCursor(0, tft_userY + (tft_fontHeight * TFT_SIZESCALER) * tft_userMenuPos);
+  tft.setCursor(0, tft_menuY(tft_userMenuPos));
   tft.print("> ");
 
   tft.setTextWrap(true);
+  tft.resetViewport();
 } // void tft_displayMenu()
 
 // Display the current page
@@ -2657,28 +3047,24 @@ void tft_showPage() {
           break;
 
         case TFT_SCREEN_LLDP1:
-          // LLDP Discovery screen
-          if (eth_lldpPacketReceived)
-            tft_discoveryScreen(&eth_lldpPacket);
-          break;
-
-        case TFT_SCREEN_LLDP2:
-          // LLDP Discovery screen 2
-          if (eth_lldpPacketReceived)
-            tft_discoveryScreen2(&eth_lldpPacket);
-          break;
-
         case TFT_SCREEN_CDP1:
-          // CDP Discovery screen
-          if (eth_cdpPacketReceived)
-            tft_discoveryScreen(&eth_cdpPacket);
-          break;
+          // LLDP or CDP Discovery screen
+          {
+            PINFO *info = tft_screenNeighbor();
+            if (info != NULL)
+              tft_discoveryScreen(info);
+            break;
+          }
 
+        case TFT_SCREEN_LLDP2:
         case TFT_SCREEN_CDP2:
-          // CDP Discovery screen 2
-          if (eth_cdpPacketReceived)
-            tft_discoveryScreen2(&eth_cdpPacket);
-          break;
+          // LLDP or CDP Discovery screen 2
+          {
+            PINFO *info = tft_screenNeighbor();
+            if (info != NULL)
+              tft_discoveryScreen2(info);
+            break;
+          }
 
         case TFT_SCREEN_NTP:
           // NTP Discovery screen
@@ -2686,6 +3072,16 @@ void tft_showPage() {
             tft_ntpScreen();
           break;
 
+        case TFT_SCREEN_TIMELINE:
+          // Discovery timeline
+          tft_timelineScreen();
+          break;
+
+        case TFT_SCREEN_VLANS:
+          // VLAN IDs of the received tagged frames
+          tft_vlanScreen();
+          break;
+
         case TFT_SCREEN_WIFIS:
           // Discovered WiFis
           if (wifi_Current != -1)
@@ -3138,8 +3534,46 @@ void btn_btn2ShortClick() {
           {
             if (tft_userMenu[TFT_MENUENTRY_SCREENSWITCHDELAY].isActive) {
               tft_changeDisplayAutoSwitchDelay();
-              break;
             }
+            break;
+          }
+
+        case TFT_MENUENTRY_PROMISCUOUS:  // Toggle promiscuous receive
+          {
+            if (tft_userMenu[TFT_MENUENTRY_PROMISCUOUS].isActive) {
+              eth_toggleReceiveFilter();
+            }
+            break;
+          }
+
+        case TFT_MENUENTRY_SWEEP:  // Start / stop the DHCP sweep
+          {
+            if (tft_userMenu[TFT_MENUENTRY_SWEEP].isActive && (gen_currentFunction == fEthernet)) {
+              eth_toggleSweep();
+            }
+            break;
+          }
+
+        case TFT_MENUENTRY_SWEEPVLANS:  // Select the VLANs of the DHCP sweep
+          {
+            if (tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].isActive) {
+              tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].value++;
+              if (tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].value > ETH_SWEEPSEENVLANS)
+                tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].value = 0;
+              savePreferencesSweepVLANs(tft_userMenu[TFT_MENUENTRY_SWEEPVLANS].value);
+            }
+            break;
+          }
+
+        case TFT_MENUENTRY_SWEEPRATE:  // Select the DISCOVERs per second of the DHCP sweep
+          {
+            if (tft_userMenu[TFT_MENUENTRY_SWEEPRATE].isActive) {
+              tft_userMenu[TFT_MENUENTRY_SWEEPRATE].value++;
+              if (tft_userMenu[TFT_MENUENTRY_SWEEPRATE].value >= eth_sweepRatesCount)
+                tft_userMenu[TFT_MENUENTRY_SWEEPRATE].value = 0;
+              savePreferencesSweepRate(tft_userMenu[TFT_MENUENTRY_SWEEPRATE].value);
+            }
+            break;
           }
 
         default:
@@ -3362,32 +3796,44 @@ void sd_exportData() {
     exportStr += "Device name: " + String(TXT_GEN_DEVNAME) + "\n";
 
     // Append all received DHCP informations
-    if (eth_dhcpInfo[0][0].Option[1] != "-") {
+    if (dhcp_hasOption(&eth_dhcpInfo[0], DHCP_OPT_IP)) {
       exportStr += "DHCP data:\n";
-      for (byte i = 0; i < 254; i++) {
-        if (eth_dhcpInfo[0][i].Option[1] != "-")
-          exportStr += String(i, DEC) + ": " + eth_dhcpInfo[0][i].Option[0] + "=" + eth_dhcpInfo[0][i].Option[1] + "\n";
-      }
+      exportStr += sd_createDhcpString(&eth_dhcpInfo[0]);
     }
 
     // Append all received DHCP informations
-    if (eth_dhcpInfo[1][0].Option[1] != "-") {
+    if (dhcp_hasOption(&eth_dhcpInfo[1], DHCP_OPT_IP)) {
       exportStr += "\nVoIP VLAN DHCP data:\n";
-      for (byte i = 0; i < 254; i++) {
-        if (eth_dhcpInfo[1][i].Option[1] != "-")
-          exportStr += String(i, DEC) + ": " + eth_dhcpInfo[1][i].Option[0] + "=" + eth_dhcpInfo[1][i].Option[1] + "\n";
+      exportStr += sd_createDhcpString(&eth_dhcpInfo[1]);
+    }
+
+    // VLANs found by the DHCP sweep
+    if (sweep_state() != sweep_Idle) {
+      char value[SWEEP_RESULTLEN];
+      exportStr += "\nDHCP sweep: " + String(sweep_probed()) + " of " + String(sweep_total()) + " VLANs probed, "
+                   + String(sweep_found()) + " with DHCP server\n";
+      for (uint8_t i = 0; i < sweep_resultCount(); i++) {
+        const SWEEP_RESULT *result = sweep_getResult(i);
+        sweep_printResult(result, value, sizeof(value));
+        exportStr += "VLAN " + String(result->vlan) + ": " + value + "\n";
       }
     }
 
     // NTP
     if (eth_timeFromNTP > 0l) {
-      exportStr += "\nNTP source: ";
-      for (byte i = 0; i < IP_LEN; i++) {
-        exportStr += String(eth_ntpIPs[eth_currentNTPSource][i]);
-        if (i < (IP_LEN - 1))
-          exportStr += ".";
-      }
-      exportStr += "\n";
+      char ntpSource[FMT_IPV4LEN];
+      fmt_ipv4(ntpSource, sizeof(ntpSource), eth_ntpIPs[eth_currentNTPSource]);
+      exportStr += "\nNTP source: " + String(ntpSource) + "\n";
+    }
+
+    // Stratum, round-trip delay and offset to the selected server of all NTP sources
+    for (byte i = 0; i < ntp_sourceCount(); i++) {
+      const NTP_SOURCE *source = ntp_getSource(i);
+      char ip[FMT_IPV4LEN];
+      char value[NTP_SOURCELEN];
+      fmt_ipv4(ip, sizeof(ip), source->ip);
+      ntp_printSource(source, value, sizeof(value));
+      exportStr += "NTP " + String(ip) + ": " + value + "\n";
     }
 
     // WiFis
@@ -3406,16 +3852,53 @@ void sd_exportData() {
       }
     }
 
+    // Rejected LLDP and CDP frames
+    for (eFrameType type : { frame_LLDP, frame_CDP }) {
+      const FRAME_COUNTERS *counters = frame_getCounters(type);
+      exportStr += String("\n") + ((type == frame_LLDP) ? "LLDP" : "CDP") + " frames accepted: " + String(counters->accepted) + ", rejected truncated: "
+                   + String(counters->truncated) + ", malformed: " + String(counters->malformed) + ", bad checksum: " + String(counters->badChecksum) + "\n";
+    }
+
+    // Frames of the receive task
+    const RING_COUNTERS *ringCounters = ring_getCounters();
+    exportStr += "Frames received: " + String(ringCounters->received) + ", dropped: " + String(ringCounters->dropped)
+                 + ", ring high water: " + String(ringCounters->highWater) + " of " + String(RING_SLOTS) + "\n";
+
+    // Frames accepted by the receive filters of the ENC28J60
+    const ENC_COUNTERS *encCounters = enc_getCounters();
+    exportStr += String("Receive filter: ") + ((enc_getFilter() == enc_Filtered) ? "filtered" : "promiscuous") + ", unicast: " + String(encCounters->unicast)
+                 + ", broadcast: " + String(encCounters->broadcast) + ", multicast: " + String(encCounters->multicast) + ", other: " + String(encCounters->other)
+                 + ", receive overflows: " + String(encCounters->overflows) + "\n";
+
+    // VLAN IDs of the received tagged frames
+    if (vlan_seenCount() > 0) {
+      exportStr += "\nVLANs seen: " + String(vlan_seenCount()) + "\n";
+      for (int16_t vlan = vlan_next(-1); vlan >= 0; vlan = vlan_next(vlan))
+        exportStr += "VLAN " + String(vlan) + ": " + String(vlan_frames(vlan)) + " frames\n";
+      if (vlan_uncounted() > 0)
+        exportStr += "Frames of VLANs without counter: " + String(vlan_uncounted()) + "\n";
+    }
+
+    // Time from link-up to the discovery milestones
+    if (timeline_count() > 0) {
+      exportStr += "\nTimeline after link-up:\n";
+      for (byte i = 0; i < timeline_EventCount; i++) {
+        uint32_t delay = timeline_get((eTimelineEvent)i);
+        if (delay != 0)
+          exportStr += String(timeline_label((eTimelineEvent)i)) + ": " + String(delay) + "ms\n";
+      }
+    }
+
     // LLDP Discovery data received
-    if (eth_lldpPacketReceived) {
+    for (int8_t slot = neighbor_next(pinfo_ProtoLLDP, -1); slot >= 0; slot = neighbor_next(pinfo_ProtoLLDP, slot)) {
       exportStr += "\nLLDP discover data:\n";
-      exportStr += sd_createPInfoString(&eth_lldpPacket);
+      exportStr += sd_createPInfoString(neighbor_get(pinfo_ProtoLLDP, slot));
     }
 
     // CDP Discovery data received
-    if (eth_cdpPacketReceived) {
+    for (int8_t slot = neighbor_next(pinfo_ProtoCDP, -1); slot >= 0; slot = neighbor_next(pinfo_ProtoCDP, slot)) {
       exportStr += "\nCDP discover data:\n";
-      exportStr += sd_createPInfoString(&eth_cdpPacket);
+      exportStr += sd_createPInfoString(neighbor_get(pinfo_ProtoCDP, slot));
     }
 
     // Export data
@@ -3444,70 +3927,33 @@ void sd_exportData() {
 // Create string with gathered data
 String sd_createPInfoString(PINFO *info) {
   String tempStr = "";
+  char value[PINFO_VALUELEN];
 
-  if (info->SWName[1] != "-")
-    tempStr += info->SWName[0] + "=" + info->SWName[1] + "\n";
-
-  if (info->SWDomain[1] != "-")
-    tempStr += info->SWDomain[0] + "=" + info->SWDomain[1] + "\n";
-
-  if (info->MAC[1] != "-")
-    tempStr += info->MAC[0] + "=" + info->MAC[1] + "\n";
-
-  if (info->Port[1] != "-")
-    tempStr += info->Port[0] + "=" + info->Port[1] + "\n";
+  for (byte i = 0; i < pinfo_FieldCount; i++) {
+    if (!PINFO_FIELDS[i].exported || !pinfo_getValue(info, (ePinfoField)i, value, sizeof(value)))
+      continue;
 
-  if (info->PortDesc[1] != "-")
-    tempStr += info->PortDesc[0] + "=" + info->PortDesc[1] + "\n";
-
-  if (info->Model[1] != "-")
-    tempStr += info->Model[0] + "=" + info->Model[1] + "\n";
-
-  if (info->ChassisID[1] != "-")
-    tempStr += info->ChassisID[0] + "=" + info->ChassisID[1] + "\n";
-
-  if (info->Proto[1] != "-") {
-    tempStr += info->Proto[0] + "=" + info->Proto[1] + " ";
-    if (info->ProtoVer[1] != "-")
-      tempStr += info->ProtoVer[1] + "\n";
+    tempStr += PINFO_FIELDS[i].label;
+    tempStr += "=";
+    tempStr += value;
     tempStr += "\n";
   }
 
-  if (info->IP[1] != "-")
-    tempStr += info->IP[0] + "=" + info->IP[1] + "\n";
-
-  if (info->Cap[1] != "-")
-    tempStr += info->Cap[0] + "=" + info->Cap[1] + "\n";
-
-  if (info->SWver[1] != "-")
-    tempStr += info->SWver[0] + "=" + info->SWver[1] + "\n";
-
-  if (info->VLAN[1] != "-")
-    tempStr += info->VLAN[0] + "=" + info->VLAN[1] + "\n";
-
-  if (info->VoiceVLAN[1] != "-")
-    tempStr += info->VoiceVLAN[0] + "=" + info->VoiceVLAN[1] + "\n";
-
-  if (info->VTP[1] != "-")
-    tempStr += info->VTP[0] + "=" + info->VTP[1] + "\n";
-
-  if (info->MgmtIP[1] != "-")
-    tempStr += info->MgmtIP[0] + "=" + info->MgmtIP[1] + "\n";
-
-  if (info->MgmtVLAN[1] != "-")
-    tempStr += info->MgmtVLAN[0] + "=" + info->MgmtVLAN[1] + "\n";
-
-  if (info->TTL[1] != "-")
-    tempStr += info->TTL[0] + "=" + info->TTL[1] + "\n";
+  return tempStr;
+}
 
-  if (info->Dup[1] != "-")
-    tempStr += info->Dup[0] + "=" + info->Dup[1] + "\n";
+// Create string with the received DHCP options
+String sd_createDhcpString(const DHCP_DATA *store) {
+  String tempStr = "";
+  char value[DHCP_VALUELEN];
 
-  if (info->PoEAvail[1] != "-")
-    tempStr += info->PoEAvail[0] + "=" + info->PoEAvail[1] + "\n";
+  for (byte i = 0; i < store->count; i++) {
+    uint8_t code = store->options[i].code;
+    if (!dhcp_getValue(store, code, value, sizeof(value)))
+      continue;
 
-  if (info->PoECons[1] != "-")
-    tempStr += info->PoECons[0] + "=" + info->PoECons[1] + "\n";
+    tempStr += String(code, DEC) + ": " + dhcp_optionLabel(code) + "=" + value + "\n";
+  }
 
   return tempStr;
 }
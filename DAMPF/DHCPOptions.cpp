@@ -11,17 +11,7 @@ https://help.sonicwall.com/help/sw/eng/6800/26/2/3/content/Network_DHCP_Server.0
 #include "Definitions.h"
 #include <Arduino.h>
 #include "DHCPOptions.h"
-
-// Information about the DHCP options. The option 0 is reserved for padding and not used by DHCP
-// itself. So this field is used in the project for the provided IP address.
-// The eth_dhcpInfo is a two dimensional array:
-// eth_dhcpInfo[0]: normal DHCP information
-// eth_dhcpInfo[1]: DHCP information if a Voice VLAN has been found
-extern DHCP_DATA eth_dhcpInfo[2][255];
-
-// eth_vlanOption = 0: normal DHCP
-// eth_vlanOption = 1: Voice VLAN DHCP
-extern byte eth_vlanOption;
+#include "fmt_functions.h"
 
 // How many IP addresses might be used for possible NTP servers?
 // - option 42 (NTP) returns a list of IP addresses, I haven't found a maximum number
@@ -33,187 +23,403 @@ extern byte eth_ntpSources;
 
 #define DHCP_INFINITE_LEASE 0xffffffff
 
-void DHCPOption(uint8_t option, const byte* data, uint8_t len) {
-  // likely to be an IPv4 address/Subnet
-  switch (option) {
-    case 1:
-      // Subnet mask
-      IPv4(option, "MASK", data, len);  // len must be 4
-      break;
+// Maximum number of compression pointers followed in one domain name
+static const uint8_t DHCP_MAXJUMPS = 16;
 
-    case 2:
-      // Time offset for DHCP option 4 - not used here
-      // DHCP_NumField( option, "TMOF", data, len );
-      //Serial.println("DHCP option 2: time offset");
-      break;
+// Text entries like the DNS domain
+static size_t dhcp_formatText(char* value, size_t size, const byte data[], uint8_t length) {
+  if (length >= size)
+    length = size - 1;
+  memcpy(value, data, length);
+  value[length] = '\0';
+  return length;
+}
 
-    case 3:
-      {
-        // Router / default gateway address
-        IPv4(option, "GW", data, len);  // len must be a multiple of 4
-        IPv4NTP(data, len);             // Add router(s) to possible IP sources
-        break;
-      }
+// Binary data as hex string
+static size_t dhcp_formatOpaque(char* value, size_t size, const byte data[], uint8_t length) {
+  return fmt_hex(value, size, data, length);
+}
 
-    case 4:
-      // Time server - see RFC0868
-      // currently not used here since this is a different protocol
-      //#ifdef DEBUGSERIAL
-      //      Serial.println("DHCP option 4: TIME");
-      //#endif
+static bool dhcp_isText(const byte data[], uint8_t length) {
+  for (uint8_t i = 0; i < length; i++) {
+    // A terminating zero is sent by some servers
+    if ((data[i] == 0) && (i == (length - 1)))
       break;
+    if ((data[i] < 0x20) || (data[i] > 0x7e))
+      return false;
+  }
+  return length > 0;
+}
 
-    case 6:
-      // Domain server
-      IPv4(option, "DNS", data, len);  // len must be a multiple of 4
-      break;
+// IPv4 address(es), one per line.
+// Some DHCP entries returns more than one address like DNS servers,
+// others like the network mask should only return one address.
+static size_t dhcp_formatIPv4(char* value, size_t size, const byte data[], uint8_t length) {
+  size_t pos = 0;
+  value[0] = '\0';
+  for (unsigned int i = 0; i < (length / IP_LEN); ++i) {
+    if (i > 0)
+      pos += fmt_text(value + pos, size - pos, "\n");
+    pos += fmt_ipv4(value + pos, size - pos, data + i * IP_LEN);
+  }
+  return pos;
+}
 
-    case 15:
-      // DNS domain name
-      DHCP_Text(option, "DOM", data, len);
-      break;
+// Unsigned number of 1 to 4 bytes
+static size_t dhcp_formatUint(char* value, size_t size, const byte data[], uint8_t length) {
+  if ((length == 0) || (length > 4))
+    return dhcp_formatOpaque(value, size, data, length);
+  uint32_t num = 0;
+  for (uint8_t i = 0; i < length; ++i)
+    num = (num << 8) | data[i];
+  return fmt_uint(value, size, num);
+}
 
-    case 28:
-      // Broadcast (IPv4) address
-      IPv4(option, "BC", data, len);
-      break;
+// Signed time offset in seconds
+static size_t dhcp_formatInt(char* value, size_t size, const byte data[], uint8_t length) {
+  if (length != 4)
+    return dhcp_formatOpaque(value, size, data, length);
+  int32_t num = (int32_t)(((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3]);
+  int len = snprintf(value, size, "%ld s", (long)num);
+  return ((len < 0) || ((size_t)len >= size)) ? strlen(value) : len;
+}
 
-    case 42:
-      {
-        // NTP servers
-        IPv4(option, "NTP", data, len);
-        IPv4NTP(data, len);  // Add NTP server(s) to NTP sources
-        break;
-      }
+// Time entries, full hours are shown in hours
+static size_t dhcp_formatTime(char* value, size_t size, const byte data[], uint8_t length) {
+  if ((length == 0) || (length > 4))
+    return dhcp_formatOpaque(value, size, data, length);
+  uint32_t num = 0;
+  for (uint8_t i = 0; i < length; ++i)
+    num = (num << 8) | data[i];
+  if (num == DHCP_INFINITE_LEASE)
+    return fmt_text(value, size, "infinite");
+  bool hours = (num != 0) && ((num % 3600) == 0);
+  size_t pos = fmt_uint(value, size, hours ? (num / 3600) : num);
+  return pos + fmt_text(value + pos, size - pos, hours ? " hours" : " s");
+}
 
-    case 44:
-      // NETBIOS name server
-      IPv4(option, "NETB", data, len);
-      break;
+// Print one name in DNS encoding. Compression pointers (RFC 1035 4.1.4) are offsets in
+// the option data (RFC 3397). Returns the position after the name, length if it is invalid.
+static uint16_t dhcp_formatName(char* value, size_t size, size_t* pos, const byte data[], uint8_t length, uint16_t index) {
+  uint16_t next = 0;
+  uint8_t jumps = 0;
+  bool first = true;
+  while (index < length) {
+    uint8_t labelLen = data[index];
+    if ((labelLen & 0xc0) == 0xc0) {
+      if (((index + 1) >= length) || (jumps == DHCP_MAXJUMPS))
+        return length;
+      if (jumps++ == 0)
+        next = index + 2;
+      index = ((labelLen & 0x3f) << 8) | data[index + 1];
+      continue;
+    }
+    if ((labelLen > 63) || ((index + 1 + labelLen) > length))
+      return length;
+    index++;
+    if (labelLen == 0)
+      return (jumps > 0) ? next : index;
+    if (!first)
+      *pos += fmt_text(value + *pos, size - *pos, ".");
+    *pos += dhcp_formatText(value + *pos, size - *pos, data + index, labelLen);
+    index += labelLen;
+    first = false;
+  }
+  return length;
+}
 
-    case 51:
-      // IP address lease time
-      DHCP_Time(option, "LEASE", data, len);
-      break;
+// Domain list in DNS encoding like the search list (RFC 3397), one domain per line
+static size_t dhcp_formatDomains(char* value, size_t size, const byte data[], uint8_t length) {
+  size_t pos = 0;
+  uint16_t index = 0;
+  value[0] = '\0';
+  while (index < length) {
+    size_t start = pos;
+    if (pos > 0)
+      pos += fmt_text(value + pos, size - pos, "\n");
+    size_t nameStart = pos;
+    index = dhcp_formatName(value, size, &pos, data, length, index);
+    if (pos == nameStart) {
+      // Skip empty names
+      pos = start;
+      value[pos] = '\0';
+    }
+  }
+  return pos;
+}
 
-    case 53:
-      // DHCP message type
-      // Value   Message type
-      //     1   Discover
-      //     2   Offer
-      //     3   Request
-      //     4   Decline
-      //     5   P ACK (packet acknowledged)?
-      //     6   P NAK (packet not acknowledged?)
-      //     7   Release
-      //     8   Inform
-      //skip DHCP_Text( option, "DHCP Msg Type ", data, len );
-      break;
+// SIP servers (RFC 3361), a list of domain names or IPv4 addresses
+static size_t dhcp_formatSip(char* value, size_t size, const byte data[], uint8_t length) {
+  if ((length > 1) && (data[0] == 0))
+    return dhcp_formatDomains(value, size, data + 1, length - 1);
+  if ((length > 1) && (data[0] == 1))
+    return dhcp_formatIPv4(value, size, data + 1, length - 1);
+  return dhcp_formatOpaque(value, size, data, length);
+}
 
-    case 54:
-      // DHCP server identification
-      IPv4(option, "DHCP", data, len);
-      break;
+// Server addresses of the VoIP options, vendors send them as text or IPv4 address
+static size_t dhcp_formatAddress(char* value, size_t size, const byte data[], uint8_t length) {
+  if (dhcp_isText(data, length))
+    return dhcp_formatText(value, size, data, length);
+  if ((length > 0) && ((length % IP_LEN) == 0))
+    return dhcp_formatIPv4(value, size, data, length);
+  return dhcp_formatOpaque(value, size, data, length);
+}
 
-    case 58:
-      // DHCP renewal (T1) time
-      // DHCP_Time( option, "RENEW", data, len );
-      break;
+// Vendor specific information, text or sub-options
+static size_t dhcp_formatVendor(char* value, size_t size, const byte data[], uint8_t length) {
+  if (dhcp_isText(data, length))
+    return dhcp_formatText(value, size, data, length);
+  return dhcp_formatOpaque(value, size, data, length);
+}
 
-    case 59:
-      // DHCP rebinding (T1) time
-      // DHCP_Time( option, "REBIND", data, len );
+// Classless static routes (RFC 3442), one route per line
+static size_t dhcp_formatRoutes(char* value, size_t size, const byte data[], uint8_t length) {
+  size_t pos = 0;
+  uint8_t index = 0;
+  value[0] = '\0';
+  while (index < length) {
+    uint8_t width = data[index++];
+    uint8_t octets = (width + 7) / 8;
+    if ((width > 32) || ((index + octets + IP_LEN) > length))
       break;
+    byte destination[IP_LEN] = { 0, 0, 0, 0 };
+    memcpy(destination, data + index, octets);
+    index += octets;
+
+    if (pos > 0)
+      pos += fmt_text(value + pos, size - pos, "\n");
+    pos += fmt_ipv4(value + pos, size - pos, destination);
+    pos += fmt_text(value + pos, size - pos, "/");
+    pos += fmt_uint(value + pos, size - pos, width);
+    pos += fmt_text(value + pos, size - pos, " via ");
+    pos += fmt_ipv4(value + pos, size - pos, data + index);
+    index += IP_LEN;
+  }
+  return pos;
+}
 
-    case 61:
-      // Client identifier => 0x01 + Client MAC address?
-      // Skip DHCP_Text( option, "CLIENTID", data, len );
-      break;
+// List of option codes like the parameter request list
+static size_t dhcp_formatCodes(char* value, size_t size, const byte data[], uint8_t length) {
+  size_t pos = 0;
+  value[0] = '\0';
+  for (uint8_t i = 0; i < length; i++) {
+    if (i > 0)
+      pos += fmt_text(value + pos, size - pos, " ");
+    pos += fmt_uint(value + pos, size - pos, data[i]);
+  }
+  return pos;
+}
 
-    case 66:
-      // TFTP server name
-      // DHCP_Text( option, "TFTP", data, len );
-      break;
+// DHCP message type
+static const char* const DHCP_MSGTYPES[] = { "", "DISCOVER", "OFFER", "REQUEST", "DECLINE", "ACK", "NAK", "RELEASE", "INFORM" };
 
-    case 67:
-      // TFTP boot file name
-      // DHCP_Text( option, "PXEF", data, len );
-      break;
+static size_t dhcp_formatMsgType(char* value, size_t size, const byte data[], uint8_t length) {
+  if ((length == 1) && (data[0] > 0) && (data[0] < (sizeof(DHCP_MSGTYPES) / sizeof(DHCP_MSGTYPES[0]))))
+    return fmt_text(value, size, DHCP_MSGTYPES[data[0]]);
+  return dhcp_formatUint(value, size, data, length);
+}
 
-    case 77:
-      // User class information
-      // Skip option
-      break;
+// Types of the option data, index of DHCP_FORMATTERS
+enum eDhcpType {
+  dhcp_TypeOpaque = 0,
+  dhcp_TypeText,
+  dhcp_TypeIPv4,
+  dhcp_TypeUint,
+  dhcp_TypeInt,
+  dhcp_TypeTime,
+  dhcp_TypeDomains,
+  dhcp_TypeSip,
+  dhcp_TypeAddress,
+  dhcp_TypeVendor,
+  dhcp_TypeRoutes,
+  dhcp_TypeCodes,
+  dhcp_TypeMsgType,
+  dhcp_TypeCount
+};
+
+// Print the raw data of an option, returns the number of characters written
+typedef size_t (*DHCP_FORMATTER)(char* value, size_t size, const byte data[], uint8_t length);
+
+static const DHCP_FORMATTER DHCP_FORMATTERS[dhcp_TypeCount] = {
+  dhcp_formatOpaque, dhcp_formatText, dhcp_formatIPv4, dhcp_formatUint, dhcp_formatInt, dhcp_formatTime, dhcp_formatDomains,
+  dhcp_formatSip, dhcp_formatAddress, dhcp_formatVendor, dhcp_formatRoutes, dhcp_formatCodes, dhcp_formatMsgType
+};
+
+// Name and type of an option
+struct DHCP_OPTIONTYPE {
+  uint8_t code;
+  const char* label;
+  uint8_t type;  // eDhcpType
+};
+
+// Known options, sorted by code for the binary search in dhcp_findType(). Other options are
+// shown as OPT with their data in hex.
+static constexpr DHCP_OPTIONTYPE DHCP_OPTIONTYPES[] = {
+  { DHCP_OPT_IP, "IP", dhcp_TypeIPv4 },  // Leased address, see DHCP_OPT_IP
+  { 1, "MASK", dhcp_TypeIPv4 },          // Subnet mask, length must be 4
+  { 2, "TMOF", dhcp_TypeInt },           // Time offset
+  { 3, "GW", dhcp_TypeIPv4 },            // Router / default gateway address, length must be a multiple of 4
+  { 4, "TIME", dhcp_TypeIPv4 },          // Time server - see RFC0868
+  { 6, "DNS", dhcp_TypeIPv4 },           // Domain server, length must be a multiple of 4
+  { 7, "LOG", dhcp_TypeIPv4 },           // Log server
+  { 12, "HOST", dhcp_TypeText },         // Host name
+  { 15, "DOM", dhcp_TypeText },          // DNS domain name
+  { 26, "MTU", dhcp_TypeUint },          // Interface MTU
+  { 28, "BC", dhcp_TypeIPv4 },           // Broadcast (IPv4) address
+  { 42, "NTP", dhcp_TypeIPv4 },          // NTP servers
+  { 43, "VENDOR", dhcp_TypeVendor },     // Vendor specific information
+  { 44, "NETB", dhcp_TypeIPv4 },         // NETBIOS name server
+  { 46, "NETBTYPE", dhcp_TypeUint },     // NETBIOS node type
+  { 51, "LEASE", dhcp_TypeTime },        // IP address lease time
+  { 53, "MSGTYPE", dhcp_TypeMsgType },   // DHCP message type
+  { 54, "DHCP", dhcp_TypeIPv4 },         // DHCP server identification
+  { 55, "PRL", dhcp_TypeCodes },         // Parameter request list
+  { 57, "MAXMSG", dhcp_TypeUint },       // Maximum DHCP message size
+  { 58, "RENEW", dhcp_TypeTime },        // DHCP renewal (T1) time
+  { 59, "REBIND", dhcp_TypeTime },       // DHCP rebinding (T2) time
+  { 60, "VCI", dhcp_TypeText },          // Vendor class identifier
+  { 61, "CLIENTID", dhcp_TypeOpaque },   // Client identifier => 0x01 + Client MAC address
+  { 66, "TFTP", dhcp_TypeText },         // TFTP server name
+  { 67, "PXEF", dhcp_TypeText },         // TFTP boot file name
+  { 77, "USERCLASS", dhcp_TypeOpaque },  // User class information
+  { 82, "RELAY", dhcp_TypeOpaque },      // Relay agent information
+  { 100, "TZPOSIX", dhcp_TypeText },     // POSIX time zone
+  { 101, "TZDB", dhcp_TypeText },        // Time zone database name
+  { 114, "PORTAL", dhcp_TypeText },      // Captive portal URI
+  { 119, "SRCDOM", dhcp_TypeDomains },   // DNS domain search list
+  { 120, "SIP", dhcp_TypeSip },          // SIP servers
+  { 121, "ROUTES", dhcp_TypeRoutes },    // Classless static routes
+  { 125, "VIVSO", dhcp_TypeOpaque },     // Vendor-identifying vendor specific information
+  { 128, "PHONETFTP", dhcp_TypeAddress },  // TFTP server for the IP phone software
+  { 129, "CALLSRV", dhcp_TypeAddress },  // Call server
+  { 130, "DISCR", dhcp_TypeText },       // Discrimination string
+  { 131, "STATSRV", dhcp_TypeAddress },  // Remote statistics server
+  { 132, "VLANID", dhcp_TypeUint },      // IEEE 802.1Q VLAN ID
+  { 133, "L2PRIO", dhcp_TypeUint },      // IEEE 802.1D/p layer 2 priority
+  { 134, "DSCP", dhcp_TypeUint },        // Diffserv code point
+  { 135, "PROXY", dhcp_TypeAddress },    // HTTP proxy for phone specific applications
+  { 150, "TFTPSRV", dhcp_TypeIPv4 },     // TFTP server addresses, used by Cisco phones
+  { 158, "PCP", dhcp_TypeOpaque },       // OPTION_V4_PCP_SERVER
+  { 176, "AVAYA", dhcp_TypeText },       // Avaya IP telephone, older firmware
+  { 242, "AVAYA", dhcp_TypeText },       // Avaya IP telephone
+  { 243, "AVAYA", dhcp_TypeText },       // Avaya configuration?
+  { 252, "WPAD", dhcp_TypeText },        // Web proxy auto discovery
+};
+
+static const uint8_t DHCP_OPTIONTYPECOUNT = sizeof(DHCP_OPTIONTYPES) / sizeof(DHCP_OPTIONTYPES[0]);
+
+static constexpr bool dhcp_optionTypesSorted(uint8_t i) {
+  return ((i + 1) >= DHCP_OPTIONTYPECOUNT) || ((DHCP_OPTIONTYPES[i].code < DHCP_OPTIONTYPES[i + 1].code) && dhcp_optionTypesSorted(i + 1));
+}
+static_assert(dhcp_optionTypesSorted(0), "DHCP_OPTIONTYPES must be sorted by code");
+
+// Binary search of the option type, NULL for unknown options
+static const DHCP_OPTIONTYPE* dhcp_findType(uint8_t code) {
+  uint8_t low = 0;
+  uint8_t high = DHCP_OPTIONTYPECOUNT;
+  while (low < high) {
+    uint8_t mid = (low + high) / 2;
+    if (DHCP_OPTIONTYPES[mid].code == code)
+      return &DHCP_OPTIONTYPES[mid];
+    if (DHCP_OPTIONTYPES[mid].code < code)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return NULL;
+}
 
-    case 119:
-      // DNS domain search list
-      DHCP_Search(option, "SRCDOM", data, len);
-      break;
+// Remove all options, nothing else than the counters has to be reset
+void dhcp_reset(DHCP_DATA* store) {
+  store->count = 0;
+  store->used = 0;
+}
 
-    case 158:
-      // Unspecified OPTION_V4_PCP_SERVER
-      // DHCP_Text( option, "OPTION_V4_PCP_SERVER", data, len );
-      break;
+// Index of the option or the position to insert it
+static uint8_t dhcp_findOption(const DHCP_DATA* store, uint8_t code) {
+  uint8_t low = 0;
+  uint8_t high = store->count;
+  while (low < high) {
+    uint8_t mid = (low + high) / 2;
+    if (store->options[mid].code < code)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
 
-    case 242:
-      // Avaya configuration?
-      DHCP_Text(option, "AVAYA", data, len);
-      break;
+// Store the raw data of an option, a repeated option replaces the stored one.
+// Returns false if the store is full.
+bool dhcp_setOption(DHCP_DATA* store, uint8_t code, const byte data[], uint8_t length) {
+  uint8_t index = dhcp_findOption(store, code);
+  DHCP_OPTION* option = &store->options[index];
+  bool found = (index < store->count) && (option->code == code);
+
+  // Replaced data is written in place if it fits, else it is appended
+  if (!found || (length > option->length)) {
+    if ((store->used + length) > DHCP_DATALEN)
+      return false;
+    if (!found) {
+      if (store->count == DHCP_MAXOPTIONS)
+        return false;
+      memmove(option + 1, option, (store->count - index) * sizeof(DHCP_OPTION));
+      store->count++;
+      option->code = code;
+    }
+    option->offset = store->used;
+    store->used += length;
+  }
+  option->length = length;
+  memcpy(store->data + option->offset, data, length);
+  return true;
+}  // bool dhcp_setOption()
+
+// Raw data of an option, NULL if it has not been received
+const byte* dhcp_getOption(const DHCP_DATA* store, uint8_t code, uint8_t* length) {
+  uint8_t index = dhcp_findOption(store, code);
+  if ((index == store->count) || (store->options[index].code != code))
+    return NULL;
+  *length = store->options[index].length;
+  return store->data + store->options[index].offset;
+}
 
-    case 243:
-      // Avaya configuration?
-      DHCP_Text(option, "AVAYA", data, len);
-      break;
+bool dhcp_hasOption(const DHCP_DATA* store, uint8_t code) {
+  uint8_t length;
+  return dhcp_getOption(store, code, &length) != NULL;
+}
 
-    case 255:
-      // End
-      // Skip option
-      break;
+// Label of an option
+const char* dhcp_optionLabel(uint8_t code) {
+  const DHCP_OPTIONTYPE* type = dhcp_findType(code);
+  return (type != NULL) ? type->label : "OPT";
+}
 
-    default:
-      {
+// Print a received option for displaying or exporting.
+// Returns false if the option has not been received.
+bool dhcp_getValue(const DHCP_DATA* store, uint8_t code, char* value, size_t size) {
+  uint8_t length;
+  const byte* data = dhcp_getOption(store, code, &length);
+  if (data == NULL)
+    return false;
+  const DHCP_OPTIONTYPE* type = dhcp_findType(code);
+  DHCP_FORMATTERS[(type != NULL) ? type->type : (uint8_t)dhcp_TypeOpaque](value, size, data, length);
+  return true;
+}
+
+// Called by the DHCP client for each option of a received ACK. The raw data is only stored,
+// it is decoded when it is displayed or exported.
+void DHCPOption(DHCP_DATA* store, uint8_t option, const byte* data, uint8_t len) {
+  if (!dhcp_setOption(store, option, data, len)) {
 #ifdef DEBUGSERIAL
-        byte i;
-        char temp[len + 1];
-        int a = 0;
-        for (i = 0; i < (len); ++i, ++a) {
-          temp[a] = data[i];
-        }
-        temp[len] = '\0';
-        String temp1 = temp;
-        String hex;
-        Serial.println("DHCP default OPT: " + String(option) + " LEN:" + String(len));
-        for (i = 0; i < len; i++) {
-          hex = "00" + String(temp[i], HEX);
-          hex = "0x" + hex.substring(hex.length() - 2);
-          Serial.print("0x" + String(temp[i], HEX) + " ");
-        }
-        Serial.println();
+    Serial.printf("DHCP option %u dropped, LEN:%u\n", option, len);
 #endif
-        break;
-      }
   }
-}
 
-// Process IPv4 address(es)
-// Some DHCP entries returns more than one address like DNS servers,
-// others like the network mask should only return one address.
-void IPv4(uint8_t option, String optlabel, const byte* data, uint8_t len) {
-  byte address[IP_LEN];
-  String temp;
-  for (unsigned int i = 0; i < (len / IP_LEN); ++i) {
-    for (unsigned int j = 0; j < IP_LEN; ++j) {
-      address[j] = data[j + i * IP_LEN];
-      temp += address[j];
-      if (j < (IP_LEN - 1)) {
-        temp += ".";
-      }
-    }
-    if (i < ((len / IP_LEN) - 1))
-      temp += "\n";
-  }
-  eth_dhcpInfo[eth_vlanOption][option].Option[0] = optlabel;
-  eth_dhcpInfo[eth_vlanOption][option].Option[1] = temp;
+  // Add router(s) and NTP server(s) to possible NTP sources
+  if ((option == 3) || (option == 42))
+    IPv4NTP(data, len);
 }
 
 // Process IPv4 address(es) which might be used as NTP time sources
@@ -222,17 +428,13 @@ void IPv4NTP(const byte* data, uint8_t len) {
   byte tmpIP[IP_LEN];
   bool found;
 
-  for (byte i = 0; i < len; i += IP_LEN) {
+  for (byte i = 0; (i + IP_LEN) <= len; i += IP_LEN) {
     // Create temporary IP address field
-    for (byte j = 0; j < IP_LEN; j++) {
-      tmpIP[j] = data[i * IP_LEN + j];
+    memcpy(tmpIP, data + i, IP_LEN);
 #ifdef DEBUGSERIAL
-      Serial.print(tmpIP[j]);
-      if (j < (IP_LEN - 1)) Serial.print(".");
-#endif
-    }
-#ifdef DEBUGSERIAL
-    Serial.println();
+    char text[FMT_IPV4LEN];
+    fmt_ipv4(text, sizeof(text), tmpIP);
+    Serial.println(text);
 #endif
 
     found = false;
@@ -254,7 +456,7 @@ void IPv4NTP(const byte* data, uint8_t len) {
         Serial.print("WARNING: current eth_ntpSources value=");
         Serial.println(String(eth_ntpSources));
         Serial.print("WARNING: IPs to be processed: ");
-        byte toBeProc = (len - i * 4) / 4;
+        byte toBeProc = (len - i) / IP_LEN;
         Serial.println(String(toBeProc));
 #endif
         return;
@@ -267,72 +469,3 @@ void IPv4NTP(const byte* data, uint8_t len) {
     }  // if( !found)
   }    // for( byte i = 0; i < len; i += IP_LEN )
 }
-
-// Process text entries like the DNS domain
-void DHCP_Text(uint8_t option, String optlabel, const byte* data, uint8_t len) {
-  char temp[len + 1];
-  int a = 0;
-  String temp1;
-  for (byte i = 0; i < (len); ++i, ++a) {
-    temp[a] = data[i];
-  }
-  temp[len] = '\0';
-  temp1 = temp;
-  eth_dhcpInfo[eth_vlanOption][option].Option[0] = optlabel;
-  eth_dhcpInfo[eth_vlanOption][option].Option[1] = temp1;
-}
-
-void DHCP_Search(uint8_t option, String optlabel, const byte* data, uint8_t len) {
-  char temp[len];
-  int a = 0;
-  String temp1;
-
-  unsigned int DataIndex = 0;
-  while (DataIndex < len) {
-    unsigned int Searchlen = data[DataIndex];
-    if (Searchlen == 0) {
-      temp1 += "\n";
-      DataIndex++;
-    } else {
-      DataIndex++;
-      for (int i = 0; i < Searchlen; ++i, ++a) {
-        temp[a] = data[i + DataIndex];
-      }
-      temp[Searchlen] = '\0';
-      temp1 += temp;
-      if ((DataIndex + Searchlen) != len && data[DataIndex + Searchlen] != 0) {
-        temp1 += ".";
-      }
-      DataIndex += Searchlen;
-      a = 0;
-    }
-  }
-  eth_dhcpInfo[eth_vlanOption][option].Option[0] = optlabel;
-  eth_dhcpInfo[eth_vlanOption][option].Option[1] = temp1;
-}
-
-// Process time entries
-void DHCP_Time(uint8_t option, String optlabel, const byte* data, uint8_t len) {
-  unsigned long num = 0;
-  int temp1;
-  for (unsigned int i = 0; i < len; ++i) {
-    num <<= 8;
-    num += data[i];
-  }
-  temp1 = (int)num;
-  temp1 = ((temp1 / 60) / 60);
-  eth_dhcpInfo[eth_vlanOption][option].Option[0] = optlabel;
-  eth_dhcpInfo[eth_vlanOption][option].Option[1] = String(temp1) + " hours";
-}
-
-void DHCP_NumField(uint8_t option, String optlabel, const byte* data, uint8_t len) {
-  unsigned long num = 0;
-  String temp;
-  for (unsigned int i = 0; i < len; ++i) {
-    num <<= 8;
-    num += data[i];
-  }
-  temp = String(num, DEC);
-  eth_dhcpInfo[eth_vlanOption][option].Option[0] = optlabel;
-  eth_dhcpInfo[eth_vlanOption][option].Option[1] = String(temp);
-}
@@ -15,17 +15,45 @@ https://help.sonicwall.com/help/sw/eng/6800/26/2/3/content/Network_DHCP_Server.0
 #ifndef DHCPOPTIONS_H
 #define DHCPOPTIONS_H
 
+// DHCP contexts, index of eth_dhcpInfo:
+// [0] will be used for regular DHCP information
+// [1] will be used for DHCP information recevied from a tagged VLAN
+static const uint8_t DHCP_CONTEXTS = 2;
+
+// Maximum number of stored options and bytes of their data per context. A lease has usually
+// less than 15 options, options which do not fit are dropped.
+static const uint8_t DHCP_MAXOPTIONS = 32;
+static const uint16_t DHCP_DATALEN = 1536;
+
+// Maximum length of a value printed by dhcp_getValue() including the terminating zero
+static const uint16_t DHCP_VALUELEN = 256;
+
+// Option 0 is reserved for padding and not used by DHCP itself, it holds the leased IP address
+static const uint8_t DHCP_OPT_IP = 0;
+
+// Raw data of a received option in DHCP_DATA.data
+struct DHCP_OPTION {
+  uint8_t code;
+  uint8_t length;
+  uint16_t offset;
+};
+
+// Received options of one DHCP context, sorted by code. Only the raw data is kept,
+// it is decoded when it is displayed or exported.
 struct DHCP_DATA {
-  // Option[ 0 ] will be used for regular DHCP information
-  // Option[ 1 ] will be used for DHCP information recevied from a tagged VLAN
-  String Option[2] = { "-", "-" };
+  uint8_t count;
+  uint16_t used;  // Bytes of data in use
+  DHCP_OPTION options[DHCP_MAXOPTIONS];
+  byte data[DHCP_DATALEN];
 };
 
-void DHCPOption(uint8_t option, const byte* data, uint8_t len);
-void IPv4(uint8_t option, String optlabel, const byte* data, uint8_t len);
+void dhcp_reset(DHCP_DATA* store);
+bool dhcp_setOption(DHCP_DATA* store, uint8_t code, const byte data[], uint8_t length);
+const byte* dhcp_getOption(const DHCP_DATA* store, uint8_t code, uint8_t* length);
+bool dhcp_hasOption(const DHCP_DATA* store, uint8_t code);
+const char* dhcp_optionLabel(uint8_t code);
+bool dhcp_getValue(const DHCP_DATA* store, uint8_t code, char* value, size_t size);
+
+void DHCPOption(DHCP_DATA* store, uint8_t option, const byte* data, uint8_t len);
 void IPv4NTP(const byte* data, uint8_t len);
-void DHCP_Text(uint8_t option, String optlabel, const byte* data, uint8_t len);
-void DHCP_Time(uint8_t option, String optlabel, const byte* data, uint8_t len);
-void DHCP_Search(uint8_t option, String optlabel, const byte* data, uint8_t len);
-void DHCP_NumField(uint8_t option, String optlabel, const byte* data, uint8_t len);
 #endif
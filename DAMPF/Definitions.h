@@ -83,9 +83,29 @@ This file contains Global definitions for the project which might used in severa
 // CS pin for Ethernet
 #define ETH_CS 5
 
+// Receive all frames of the Ethernet port, e.g. for analysing a mirror port
+// If this is not active the ENC28J60 only receives broadcasts, frames to the own MAC address and
+// the LLDP / CDP multicast addresses. This is only the default, the setting can be changed in the menu.
+//#define ETH_PROMISCUOUS
+
 // Maxiumum numbers of NTP sources to support/check
 #define ETH_NTPMAXSOURCES 10
 
+// DHCP sweep: selectable DISCOVERs per second and VLAN ranges. The entry after the last range
+// probes the VLANs seen in the received tagged frames.
+const uint16_t eth_sweepRates[] = { 25, 50, 100, 200 };
+const unsigned char eth_sweepRatesCount = sizeof(eth_sweepRates) / sizeof(eth_sweepRates[0]);
+const unsigned char ETH_DEFAULTSWEEPRATEIDX = 3;  // Index of eth_sweepRates array for default value
+
+struct sSweepRange {
+  uint16_t first;
+  uint16_t last;
+};
+const sSweepRange eth_sweepRanges[] = { { 1, 4094 }, { 1, 1023 }, { 1024, 2047 }, { 2048, 3071 }, { 3072, 4094 } };
+const unsigned char eth_sweepRangesCount = sizeof(eth_sweepRanges) / sizeof(eth_sweepRanges[0]);
+const unsigned char ETH_SWEEPSEENVLANS = eth_sweepRangesCount;  // Index for the VLANs seen
+const unsigned char ETH_DEFAULTSWEEPRANGEIDX = 0;                // Index of eth_sweepRanges array for default value
+
 #ifdef USE_SDCARD
 // Network log file
 #define SD_LOGFILENAME "/dampf.log"
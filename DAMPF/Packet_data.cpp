@@ -0,0 +1,330 @@
+/*
+Packet_data.cpp
+
+Helper functions to set and print the values of PINFO.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include <stddef.h>
+#include "Packet_data.h"
+#include "fmt_functions.h"
+
+// LLDP power classes as reported in the MDI power support TLV, index is the received value
+static const char* const PINFO_LLDPPOECLASSES[] = { "n/a", "0.44W-12.95W", "0.44W-3.84W", "3.84W-6.49W", "6.49W-12.95W",
+                                                    "12.95W-25.5W", "40W", "51W", "62W", "71.3W" };
+
+// Capabilities, index is ePinfoCap: bit number in the LLDP and CDP capability masks and name
+struct PINFO_CAPABILITY {
+  uint8_t lldpBit;
+  uint8_t cdpBit;
+  const char* name;
+};
+
+static const uint8_t PINFO_NOCAP = 0xff;
+
+static const PINFO_CAPABILITY PINFO_CAPS[pinfo_CapCount] = {
+  { 0, PINFO_NOCAP, "Other" },
+  { 1, 6, "Repeater" },
+  { 2, 1, "Bridge" },
+  { 3, PINFO_NOCAP, "WLAN" },
+  { 4, 0, "Router" },
+  { 5, 7, "Telephone" },
+  { 6, PINFO_NOCAP, "DOCSIS" },
+  { 7, 4, "Station" },
+  { 8, PINFO_NOCAP, "CVLAN" },
+  { 9, PINFO_NOCAP, "SVLAN" },
+  { 10, 10, "TPMR" },
+  { PINFO_NOCAP, 2, "Route_Bridge" },
+  { PINFO_NOCAP, 3, "Switch" },
+  { PINFO_NOCAP, 5, "IGMP" },
+  { PINFO_NOCAP, 8, "RemMgmDev" },
+  { PINFO_NOCAP, 9, "Camera" },
+};
+
+void pinfo_reset(PINFO* info) {
+  memset(info, 0, sizeof(PINFO));
+}
+
+bool pinfo_isSet(const PINFO* info, ePinfoField field) {
+  return (info->fields & PINFO_FIELD(field)) != 0;
+}
+
+void pinfo_set(PINFO* info, ePinfoField field) {
+  info->fields |= PINFO_FIELD(field);
+}
+
+// Map the capability bits of the protocol to PINFO_FIELD(ePinfoCap) bits
+static uint32_t pinfo_mapCaps(uint8_t proto, uint32_t caps) {
+  uint32_t mask = 0;
+  for (byte i = 0; i < pinfo_CapCount; i++) {
+    uint8_t bit = (proto == pinfo_ProtoCDP) ? PINFO_CAPS[i].cdpBit : PINFO_CAPS[i].lldpBit;
+    if ((bit != PINFO_NOCAP) && ((caps & (1UL << bit)) != 0))
+      mask |= PINFO_FIELD(i);
+  }
+  return mask;
+}
+
+// System or enabled capabilities as PINFO_FIELD(ePinfoCap) bits
+uint32_t pinfo_capabilities(const PINFO* info, bool enabled) {
+  return pinfo_mapCaps(info->proto, enabled ? info->cap : info->sysCap);
+}
+
+bool pinfo_hasCap(const PINFO* info, ePinfoCap cap) {
+  return (pinfo_capabilities(info, true) & PINFO_FIELD(cap)) != 0;
+}
+
+// Print the names of the capability bits
+static void pinfo_printCaps(char* value, size_t size, uint8_t proto, uint32_t caps) {
+  uint32_t mask = pinfo_mapCaps(proto, caps);
+  size_t pos = 0;
+  value[0] = '\0';
+  for (byte i = 0; i < pinfo_CapCount; i++) {
+    if ((mask & PINFO_FIELD(i)) != 0) {
+      int len = snprintf(value + pos, size - pos, "%s ", PINFO_CAPS[i].name);
+      if ((len < 0) || ((pos + len) >= size))
+        break;
+      pos += len;
+    }
+  }
+}
+
+// Read a numeric value of 1, 2 or 4 bytes
+static uint32_t pinfo_readUint(const PINFO* info, const PINFO_FIELDDESC* desc) {
+  const byte* data = (const byte*)info + desc->offset;
+  switch (desc->size) {
+    case 1:
+      return *data;
+    case 2:
+      {
+        uint16_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+      }
+    default:
+      {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+      }
+  }
+}
+
+// Formatters of PINFO_FIELDS, desc->offset points to the value in PINFO
+static bool pinfo_formatText(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size) {
+  fmt_text(value, size, (const char*)info + desc->offset);
+  return true;
+}
+
+static bool pinfo_formatUint(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size) {
+  fmt_uint(value, size, pinfo_readUint(info, desc));
+  return true;
+}
+
+static bool pinfo_formatHex16(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size) {
+  size_t pos = fmt_text(value, size, "0x");
+  fmt_hexNumber(value + pos, size - pos, pinfo_readUint(info, desc), 4);
+  return true;
+}
+
+static bool pinfo_formatMAC(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size) {
+  fmt_mac(value, size, (const byte*)info + desc->offset, '\0');
+  return true;
+}
+
+static bool pinfo_formatIPv4(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size) {
+  fmt_ipv4(value, size, (const byte*)info + desc->offset);
+  return true;
+}
+
+// Power in 0.1 W
+static bool pinfo_formatDeciWatt(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size) {
+  uint32_t power = pinfo_readUint(info, desc);
+  snprintf(value, size, "%lu.%luW", (unsigned long)(power / 10), (unsigned long)(power % 10));
+  return true;
+}
+
+// Power in mW
+static bool pinfo_formatMilliWatt(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size) {
+  snprintf(value, size, "%lumWh", (unsigned long)pinfo_readUint(info, desc));
+  return true;
+}
+
+// LLDP sends the power class, CDP the available power
+static bool pinfo_formatPoEAvail(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size) {
+  if (info->proto == pinfo_ProtoLLDP) {
+    if (info->poeClass >= (sizeof(PINFO_LLDPPOECLASSES) / sizeof(PINFO_LLDPPOECLASSES[0])))
+      return false;
+    fmt_text(value, size, PINFO_LLDPPOECLASSES[info->poeClass]);
+  } else if (info->poeAvail != 0)
+    pinfo_formatMilliWatt(info, desc, value, size);
+  else
+    fmt_text(value, size, "not available");
+  return true;
+}
+
+// Protocol name, followed by the version if it was received
+static bool pinfo_formatProto(const PINFO* info, const PINFO_FIELDDESC* /* desc */, char* value, size_t size) {
+  size_t pos = fmt_text(value, size, (info->proto == pinfo_ProtoCDP) ? "CDP" : "LLDP");
+  if (pinfo_isSet(info, pinfo_ProtoVer)) {
+    pos += fmt_text(value + pos, size - pos, " ");
+    fmt_uint(value + pos, size - pos, info->protoVer);
+  }
+  return true;
+}
+
+static bool pinfo_formatDuplex(const PINFO* info, const PINFO_FIELDDESC* /* desc */, char* value, size_t size) {
+  fmt_text(value, size, info->fullDuplex ? "Full" : "Half");
+  return true;
+}
+
+static bool pinfo_formatCaps(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size) {
+  pinfo_printCaps(value, size, info->proto, pinfo_readUint(info, desc));
+  return true;
+}
+
+#define PINFO_DESC(field, label, format, member, page, exported) \
+  { field, label, format, offsetof(PINFO, member), sizeof(PINFO::member), page, exported }
+#define PINFO_LLDPDESC(field, label, format, member, page, exported) \
+  { field, label, format, offsetof(PINFO, lldp.member), sizeof(PINFO_LLDPORG::member), page, exported }
+
+// Description of the received values, index is ePinfoField. The order of the entries is the order
+// of the rows on the pages and in the SD export.
+constexpr PINFO_FIELDDESC PINFO_FIELDS[pinfo_FieldCount] = {
+  PINFO_DESC(pinfo_Port, "Port", pinfo_formatText, port, pinfo_Page1, true),
+  PINFO_DESC(pinfo_PortDesc, "PortDesc", pinfo_formatText, portDesc, pinfo_Page1, true),
+  PINFO_DESC(pinfo_VLAN, "VLAN", pinfo_formatUint, vlan, pinfo_Page1, true),
+  PINFO_DESC(pinfo_VoiceVLAN, "VoiceVLAN", pinfo_formatUint, voiceVLAN, pinfo_Page1, true),
+  PINFO_DESC(pinfo_SWName, "Name", pinfo_formatText, swName, pinfo_Page1, true),
+  PINFO_DESC(pinfo_SWDomain, "Domain", pinfo_formatText, swDomain, pinfo_Page1, true),
+  PINFO_DESC(pinfo_IP, "IP", pinfo_formatIPv4, ip, pinfo_Page1, true),
+  PINFO_DESC(pinfo_MAC, "MAC", pinfo_formatMAC, mac, pinfo_Page1, true),
+  PINFO_DESC(pinfo_PoEAvail, "PoE avail", pinfo_formatPoEAvail, poeAvail, pinfo_Page1, true),
+  PINFO_DESC(pinfo_PoECons, "PoE cons", pinfo_formatMilliWatt, poeCons, pinfo_Page1, true),
+  PINFO_DESC(pinfo_SysCap, "SysCap", pinfo_formatCaps, sysCap, pinfo_Page2, true),
+  PINFO_DESC(pinfo_Cap, "Cap", pinfo_formatCaps, cap, pinfo_Page2, true),
+  PINFO_DESC(pinfo_Model, "Model", pinfo_formatText, model, pinfo_Page2, true),
+  PINFO_LLDPDESC(pinfo_PoEReq, "PoE req", pinfo_formatDeciWatt, powerRequested, pinfo_Page2, true),
+  PINFO_LLDPDESC(pinfo_PoEAlloc, "PoE alloc", pinfo_formatDeciWatt, powerAllocated, pinfo_Page2, true),
+  PINFO_LLDPDESC(pinfo_MaxFrame, "MaxFrame", pinfo_formatUint, maxFrameSize, pinfo_Page2, true),
+  PINFO_DESC(pinfo_ChassisID, "ChassisID", pinfo_formatText, chassisID, pinfo_PageNone, true),
+  PINFO_DESC(pinfo_Proto, "Proto", pinfo_formatProto, proto, pinfo_PageNone, true),
+  PINFO_DESC(pinfo_ProtoVer, "ProtoVer", pinfo_formatUint, protoVer, pinfo_PageNone, false),  // Part of Proto
+  PINFO_DESC(pinfo_SWver, "SWver", pinfo_formatText, swVer, pinfo_PageNone, true),
+  PINFO_DESC(pinfo_VTP, "VTP", pinfo_formatText, vtp, pinfo_PageNone, true),
+  PINFO_DESC(pinfo_MgmtIP, "MgmtIP", pinfo_formatIPv4, mgmtIP, pinfo_PageNone, true),
+  PINFO_DESC(pinfo_MgmtVLAN, "MgmtVLAN", pinfo_formatUint, mgmtVLAN, pinfo_PageNone, true),
+  PINFO_DESC(pinfo_TTL, "TTL", pinfo_formatUint, ttl, pinfo_PageNone, true),
+  PINFO_DESC(pinfo_Dup, "Dup", pinfo_formatDuplex, fullDuplex, pinfo_PageNone, true),
+  PINFO_DESC(pinfo_Checksum, "Checksum", pinfo_formatHex16, checksum, pinfo_PageNone, false),
+};
+
+#undef PINFO_DESC
+#undef PINFO_LLDPDESC
+
+// The index of an entry must be its ePinfoField
+static constexpr bool pinfo_fieldsInOrder(uint8_t i) {
+  return (i >= pinfo_FieldCount) || ((PINFO_FIELDS[i].field == i) && pinfo_fieldsInOrder(i + 1));
+}
+static_assert(pinfo_fieldsInOrder(0), "PINFO_FIELDS must be in the order of ePinfoField");
+
+// Get the text buffer of a field, NULL for numeric fields
+static char* pinfo_textBuffer(PINFO* info, ePinfoField field, size_t* size) {
+  const PINFO_FIELDDESC* desc = &PINFO_FIELDS[field];
+  if (desc->format != pinfo_formatText) {
+    *size = 0;
+    return NULL;
+  }
+  *size = desc->size;
+  return (char*)info + desc->offset;
+}
+
+// Print a received value for displaying or exporting.
+// Returns false if the value has not been received.
+bool pinfo_getValue(const PINFO* info, ePinfoField field, char* value, size_t size) {
+  if ((field >= pinfo_FieldCount) || !pinfo_isSet(info, field))
+    return false;
+  const PINFO_FIELDDESC* desc = &PINFO_FIELDS[field];
+  return desc->format(info, desc, value, size);
+}  // bool pinfo_getValue()
+
+// Copy length characters of the frame into the text field, longer texts are cut
+void pinfo_setText(PINFO* info, ePinfoField field, const byte value[], uint16_t length) {
+  size_t size;
+  char* text = pinfo_textBuffer(info, field, &size);
+  if (text == NULL)
+    return;
+
+  if (length >= size)
+    length = size - 1;
+  memcpy(text, value, length);
+  text[length] = '\0';
+  pinfo_set(info, field);
+}
+
+// Copy only the part after the last '/', e.g. "GigabitEthernet1/0/12" => "12"
+void pinfo_setLastPart(PINFO* info, ePinfoField field, const byte value[], uint16_t length) {
+  uint16_t start = length;
+  while ((start > 0) && (value[start - 1] != '/'))
+    start--;
+  pinfo_setText(info, field, value + start, length - start);
+}
+
+// Copy only the first line of a multi line text
+void pinfo_setFirstLine(PINFO* info, ePinfoField field, const byte value[], uint16_t length) {
+  uint16_t end = 0;
+  while ((end < length) && (value[end] != '\r') && (value[end] != '\n'))
+    end++;
+  pinfo_setText(info, field, value, end);
+}
+
+// Print MAC address or other binary data as hex string without separators
+void pinfo_setHex(PINFO* info, ePinfoField field, const byte value[], uint16_t length) {
+  size_t size;
+  char* text = pinfo_textBuffer(info, field, &size);
+  if (text == NULL)
+    return;
+
+  fmt_hex(text, size, value, length);
+  pinfo_set(info, field);
+}
+
+// Print an IPv4 address into a text field
+void pinfo_setIPv4(PINFO* info, ePinfoField field, const byte ip[]) {
+  size_t size;
+  char* text = pinfo_textBuffer(info, field, &size);
+  if (text == NULL)
+    return;
+
+  fmt_ipv4(text, size, ip);
+  pinfo_set(info, field);
+}
+
+// Print an IPv6 address into a text field
+void pinfo_setIPv6(PINFO* info, ePinfoField field, const byte ip[]) {
+  size_t size;
+  char* text = pinfo_textBuffer(info, field, &size);
+  if (text == NULL)
+    return;
+
+  fmt_ipv6(text, size, ip);
+  pinfo_set(info, field);
+}
+
+// Create a String of a text in the received frame, only used for debug output
+String pinfo_debugText(const byte value[], uint16_t length) {
+  String text;
+  text.concat((const char*)value, length);
+  return text;
+}
+
+// FNV-1a hash, start with PINFO_HASHINIT
+uint32_t pinfo_hash(uint32_t hash, const byte data[], uint16_t length) {
+  for (uint16_t i = 0; i < length; i++) {
+    hash ^= data[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
@@ -12,29 +12,231 @@ Hold received information from LLDP or CDP (and possibly other protocols in futu
 #ifndef PACKET_DATA_H
 #define PACKET_DATA_H
 
+// Maximum length of the texts including the terminating zero, longer values are cut
+static const uint8_t PINFO_IDLEN = 48;
+static const uint8_t PINFO_NAMELEN = 48;
+static const uint8_t PINFO_PORTLEN = 48;
+static const uint8_t PINFO_VTPLEN = 33;
+static const uint8_t PINFO_SWVERLEN = 160;
+static const uint8_t PINFO_VLANNAMELEN = 33;
+static const uint8_t PINFO_INVENTORYLEN = 33;
+
+// Maximum length of a value printed by pinfo_getValue() including the terminating zero
+static const uint8_t PINFO_VALUELEN = PINFO_SWVERLEN;
+
+// Protocol the data was received with
+enum ePinfoProto {
+  pinfo_ProtoNone = 0,
+  pinfo_ProtoLLDP = 1,
+  pinfo_ProtoCDP = 2
+};
+
+// Received values. The order is the order of the rows on the LLDP / CDP pages and in the
+// SD export, each value is described by its entry in PINFO_FIELDS.
+enum ePinfoField {
+  // Page 1
+  pinfo_Port = 0,
+  pinfo_PortDesc,
+  pinfo_VLAN,
+  pinfo_VoiceVLAN,
+  pinfo_SWName,
+  pinfo_SWDomain,
+  pinfo_IP,
+  pinfo_MAC,
+  pinfo_PoEAvail,
+  pinfo_PoECons,
+  // Page 2
+  pinfo_SysCap,
+  pinfo_Cap,
+  pinfo_Model,
+  pinfo_PoEReq,
+  pinfo_PoEAlloc,
+  pinfo_MaxFrame,
+  // Only exported
+  pinfo_ChassisID,
+  pinfo_Proto,
+  pinfo_ProtoVer,
+  pinfo_SWver,
+  pinfo_VTP,
+  pinfo_MgmtIP,
+  pinfo_MgmtVLAN,
+  pinfo_TTL,
+  pinfo_Dup,
+  pinfo_Checksum,
+  pinfo_FieldCount
+};
+
+// Bit in PINFO.fields for a received value
+#define PINFO_FIELD(field) (1UL << (field))
+
+// Capabilities of LLDP and CDP neighbors. The received masks keep the bits of the protocol,
+// pinfo_capabilities() maps them to a mask with PINFO_FIELD(ePinfoCap) bits.
+enum ePinfoCap {
+  pinfo_CapOther = 0,
+  pinfo_CapRepeater,
+  pinfo_CapBridge,
+  pinfo_CapWLAN,
+  pinfo_CapRouter,
+  pinfo_CapPhone,
+  pinfo_CapDOCSIS,
+  pinfo_CapStation,
+  pinfo_CapCVLAN,
+  pinfo_CapSVLAN,
+  pinfo_CapTPMR,
+  pinfo_CapSRBridge,
+  pinfo_CapSwitch,
+  pinfo_CapIGMP,
+  pinfo_CapRemote,
+  pinfo_CapCamera,
+  pinfo_CapCount
+};
+
+// LLDP organizationally specific TLVs stored in PINFO_LLDPORG, see lldp_customTLV()
+enum eLldpOrgField {
+  lldporg_MacPhy = 0,
+  lldporg_Power,
+  lldporg_LinkAgg,
+  lldporg_MaxFrame,
+  lldporg_PVID,
+  lldporg_PPVID,
+  lldporg_VlanName,
+  lldporg_Protocol,
+  lldporg_MedCap,
+  lldporg_Policy,
+  lldporg_Location,
+  lldporg_ExtPower,
+  lldporg_Inventory
+};
+
+// Protocols of the IEEE 802.1 Protocol Identity TLV, bits of PINFO_LLDPORG.protocols
+static const uint8_t PINFO_PROTO_STP = 0x01;
+static const uint8_t PINFO_PROTO_LACP = 0x02;
+static const uint8_t PINFO_PROTO_EAPOL = 0x04;
+static const uint8_t PINFO_PROTO_OTHER = 0x80;
+
+// Values of the LLDP organizationally specific TLVs, stored as received
+struct PINFO_LLDPORG {
+  uint32_t fields;  // PINFO_FIELD() bits of eLldpOrgField
+
+  // IEEE 802.3
+  uint8_t autoNeg;          // MAC/PHY: bit 0 supported, bit 1 enabled
+  uint16_t autoNegAdvCap;   // MAC/PHY: advertised capabilities
+  uint16_t mauType;         // MAC/PHY: operational MAU type
+  uint8_t powerPortClass;   // MDI power: port class and support bits
+  uint8_t powerPairs;       // MDI power: pethPsePortPowerPairs
+  uint8_t powerClass;       // MDI power: pethPsePortPowerClassification
+  uint8_t powerTypePrio;    // MDI power: type, source and priority
+  uint16_t powerRequested;  // MDI power: PD requested power in 0.1 W
+  uint16_t powerAllocated;  // MDI power: PSE allocated power in 0.1 W
+  uint8_t linkAggStatus;    // Bit 0 capable, bit 1 aggregated
+  uint32_t linkAggPortID;
+  uint16_t maxFrameSize;
+
+  // IEEE 802.1
+  uint8_t ppvidFlags;
+  uint16_t ppvid;
+  uint16_t vlanNameID;
+  char vlanName[PINFO_VLANNAMELEN];
+  uint8_t protocols;  // PINFO_PROTO_* bits
+
+  // LLDP-MED
+  uint16_t medCap;
+  uint8_t medClass;
+  uint8_t policyApp;    // Media application, voice is preferred
+  uint8_t policyFlags;  // Bit 1 unknown policy, bit 0 tagged
+  uint16_t policyVLAN;
+  uint8_t policyPrio;   // L2 priority
+  uint8_t policyDSCP;
+  uint8_t locationFormat;
+  char locationCountry[3];
+  uint8_t extPowerType;    // Type, source and priority
+  uint16_t extPowerValue;  // 0.1 W
+  char hwRev[PINFO_INVENTORYLEN];
+  char fwRev[PINFO_INVENTORYLEN];
+  char swRev[PINFO_INVENTORYLEN];
+  char serial[PINFO_INVENTORYLEN];
+  char manufacturer[PINFO_INVENTORYLEN];
+  char assetID[PINFO_INVENTORYLEN];
+};
+
+// Received data of one neighbor. The record has a fixed size and contains no pointers,
+// so it can be reset with memset() and copied with memcpy().
 struct PINFO {
-  String ChassisID[2] = { "ChassisID", "-" };
-  String Proto[2] = { "Proto", "-" };
-  String ProtoVer[2] = { "ProtoVer", "-" };
-  String SWName[2] = { "Name", "-" };
-  String SWDomain[2] = { "Domain", "-" };
-  String MAC[2] = { "MAC", "-" };
-  String Port[2] = { "Port", "-" };
-  String PortDesc[2] = { "PortDesc", "-" };
-  String Model[2] = { "Model", "-" };
-  String VLAN[2] = { "VLAN", "-" };
-  String IP[2] = { "IP", "-" };
-  String VoiceVLAN[2] = { "VoiceVLAN", "-" };
-  String Cap[2] = { "Cap", "-" };
-  String SWver[2] = { "SWver", "-" };
-  String TTL[2] = { "TTL", "-" };
-  String VTP[2] = { "VTP", "-" };
-  String Dup[2] = { "Dup", "-" };
-  String PoEAvail[2] = { "PoE avail", "-" };
-  String PoECons[2] = { "PoE cons", "-" };
-  String MgmtIP[2] = { "MgmtIP", "-" };
-  String MgmtVLAN[2] = { "MgmtVLAN", "-" };
-  String Checksum[2] = { "Checksum", "-" };
+  uint32_t fields;  // PINFO_FIELD() bits of the received values
+  uint8_t proto;    // ePinfoProto
+  uint8_t protoVer;
+  bool fullDuplex;
+  uint8_t poeClass;  // LLDP power class as received, 0 = not available
+  uint16_t vlan;
+  uint16_t voiceVLAN;
+  uint16_t mgmtVLAN;
+  uint16_t ttl;  // Time to live in seconds
+  uint16_t checksum;
+  uint32_t sysCap;    // System capabilities, the bits depend on proto
+  uint32_t cap;       // Enabled capabilities, the bits depend on proto
+  uint32_t poeAvail;  // mW
+  uint32_t poeCons;   // mW
+  byte mac[ETH_LEN];
+  byte ip[IP_LEN];
+  byte mgmtIP[IP_LEN];
+  char chassisID[PINFO_IDLEN];
+  char swName[PINFO_NAMELEN];
+  char swDomain[PINFO_NAMELEN];
+  char port[PINFO_PORTLEN];
+  char portDesc[PINFO_PORTLEN];
+  char model[PINFO_NAMELEN];
+  char swVer[PINFO_SWVERLEN];
+  char vtp[PINFO_VTPLEN];
+  PINFO_LLDPORG lldp;
+};
+
+void pinfo_reset(PINFO* info);
+bool pinfo_isSet(const PINFO* info, ePinfoField field);
+void pinfo_set(PINFO* info, ePinfoField field);
+bool pinfo_getValue(const PINFO* info, ePinfoField field, char* value, size_t size);
+
+// LLDP / CDP page a value is shown on
+enum ePinfoPage {
+  pinfo_PageNone = 0,
+  pinfo_Page1 = 1,
+  pinfo_Page2 = 2
+};
+
+// Description of a received value: how it is stored, printed and where it is shown.
+// The formatter prints the value at offset in PINFO, it returns false if there is nothing to show.
+struct PINFO_FIELDDESC;
+typedef bool (*PINFO_FORMATTER)(const PINFO* info, const PINFO_FIELDDESC* desc, char* value, size_t size);
+
+struct PINFO_FIELDDESC {
+  uint8_t field;            // ePinfoField, the same as the index in PINFO_FIELDS
+  const char* label;
+  PINFO_FORMATTER format;
+  uint16_t offset;          // offsetof() the value in PINFO
+  uint8_t size;             // Size of the value, buffer size of texts
+  uint8_t page;             // ePinfoPage
+  bool exported;            // Written to the SD export and the serial dump
 };
 
+// One entry per ePinfoField
+extern const PINFO_FIELDDESC PINFO_FIELDS[pinfo_FieldCount];
+
+// Set a text of PINFO from data of a received frame and flag it as received
+void pinfo_setText(PINFO* info, ePinfoField field, const byte value[], uint16_t length);
+void pinfo_setLastPart(PINFO* info, ePinfoField field, const byte value[], uint16_t length);
+void pinfo_setFirstLine(PINFO* info, ePinfoField field, const byte value[], uint16_t length);
+void pinfo_setHex(PINFO* info, ePinfoField field, const byte value[], uint16_t length);
+void pinfo_setIPv4(PINFO* info, ePinfoField field, const byte ip[]);
+void pinfo_setIPv6(PINFO* info, ePinfoField field, const byte ip[]);
+
+// Capabilities independent of the protocol
+uint32_t pinfo_capabilities(const PINFO* info, bool enabled);
+bool pinfo_hasCap(const PINFO* info, ePinfoCap cap);
+
+// FNV-1a hash, used for the neighbor keys and the digests of the received frames
+static const uint32_t PINFO_HASHINIT = 2166136261UL;
+uint32_t pinfo_hash(uint32_t hash, const byte data[], uint16_t length);
+
+// Create a String of a text in the received frame, only used for debug output
+String pinfo_debugText(const byte value[], uint16_t length);
+
 #endif
@@ -35,6 +35,11 @@ static const char* TXT_GEN_DEFAULTFUNCTION = "Std";
 static const char* TXT_GEN_WRITETOLOG = "Protokoll speich.";
 static const char* TXT_GEN_ROTATESCREEN = "Bildschirm drehen";
 static const char* TXT_GEN_SCREENSWITCHDELAY = "Pause";
+static const char* TXT_ETH_PROMISCUOUS = "Alle Frames";
+static const char* TXT_ETH_SWEEP = "DHCP-Sweep";
+static const char* TXT_ETH_SWEEPVLANS = " VLANs";
+static const char* TXT_ETH_SWEEPRATE = " Rate";
+static const char* TXT_ETH_SWEEPSEEN = "gesehene";
 
 #ifdef USE_BTSERIAL
 static const char* TXT_BT_CONNECTION = "Bluetooth-Verbindung";
@@ -82,6 +87,11 @@ static const char* TXT_GEN_DEFAULTFUNCTION = "Def";
 static const char* TXT_GEN_WRITETOLOG = "Write to log";
 static const char* TXT_GEN_ROTATESCREEN = "Rotate screen";
 static const char* TXT_GEN_SCREENSWITCHDELAY = "Delay";
+static const char* TXT_ETH_PROMISCUOUS = "Promiscuous";
+static const char* TXT_ETH_SWEEP = "DHCP sweep";
+static const char* TXT_ETH_SWEEPVLANS = " VLANs";
+static const char* TXT_ETH_SWEEPRATE = " Rate";
+static const char* TXT_ETH_SWEEPSEEN = "seen";
 
 #ifdef USE_BTSERIAL
 static const char* TXT_BT_CONNECTION = "Bluetooth connection";
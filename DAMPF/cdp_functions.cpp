@@ -15,91 +15,93 @@ Some details added as description / comments from WireShark
 // CDP broadcast address
 byte cdp_mac[] = { 0x01, 0x00, 0x0c, 0xcc, 0xcc, 0xcc };
 
-/*
-#define printhex(n) \
-  { \
-    if ((n) < 0x10) { Serial.print('0'); } \
-    Serial.print((n), HEX); \
+// Read the TLV at *index and advance *index to the next one.
+// TLV structure
+// Type     Length   Value
+// 2 bytes  2 bytes  Length - 4 bytes
+// Returns false at the end of the frame or if the TLV does not fit into plen.
+bool cdp_nextTLV(const byte cdpData[], uint16_t plen, uint16_t* index, CDP_TLV* tlv) {
+  uint16_t pos = *index;
+  if ((pos + 4) > plen)
+    return false;
+
+  tlv->type = (cdpData[pos] << 8) | cdpData[pos + 1];
+  uint16_t length = (cdpData[pos + 2] << 8) | cdpData[pos + 3];
+  if ((length < 4) || ((pos + length) > plen))
+    return false;
+
+  tlv->length = length - 4;
+  tlv->value = cdpData + pos + 4;
+  *index = pos + length;
+  return true;
+}  // bool cdp_nextTLV()
+
+// Check the structure and checksum of the CDP frame before it is decoded. *plen is reduced
+// to the length given in the IEEE 802.3 header, so the padding of short frames is ignored.
+// A frame shorter than this length is reported as truncated, e.g. a frame clipped to the buffer size.
+eFrameCheck cdp_validate(const byte cdpData[], uint16_t* plen) {
+  if (*plen < CDP_HEADER_LEN)
+    return frame_Truncated;
+
+  uint16_t frameLength = 14 + ((cdpData[12] << 8) | cdpData[13]);
+  if (frameLength > *plen)
+    return frame_Truncated;
+  if (frameLength < CDP_HEADER_LEN)
+    return frame_Malformed;
+
+  byte version = cdpData[CDP_SNAP_LEN];
+  if ((version != 1) && (version != 2))
+    return frame_Malformed;
+
+  // Every TLV has at least type and length and has to end inside the frame
+  uint16_t pos = CDP_HEADER_LEN;
+  while (pos < frameLength) {
+    if ((pos + 4) > frameLength)
+      return frame_Malformed;
+    uint16_t length = (cdpData[pos + 2] << 8) | cdpData[pos + 3];
+    if ((length < 4) || ((pos + length) > frameLength))
+      return frame_Malformed;
+    pos += length;
   }
-*/
 
-PINFO cdpinfo;
+  // The checksum over version, TTL, checksum and TLVs is 0 for a valid frame
+  if (cdp_checksum(cdpData + CDP_SNAP_LEN, frameLength - CDP_SNAP_LEN) != 0)
+    return frame_BadChecksum;
 
-unsigned int cdp_check_Packet(byte EthBuffer[], unsigned int length) {
-  if (length > 0) {
-    unsigned int cdpDataIndex = 0;
-
-    // This PID is for CDP only and will filter out VTP, DTP, etc..
-    String PID = print_mac(EthBuffer, 20, 2);
-    if (PID != "2000") {
-      return (0);
-    } else {
-      if (byte_array_contains(EthBuffer, cdpDataIndex, cdp_mac, sizeof(cdp_mac))) {
-        // CDP Packet found and is now getting processed
-#ifdef DEBUGSERIAL
-        Serial.println("\n\nCDP Packet Recieved");
-#endif
+  *plen = frameLength;
+  return frame_Valid;
+}  // eFrameCheck cdp_validate()
 
-        cdpDataIndex += sizeof(cdp_mac);  // Increment index the length of the source MAC address
-
-        // Get source MAC Address
-        byte* macFrom = EthBuffer + cdpDataIndex;
-        cdpinfo.MAC[1] = print_mac(macFrom, 0, 6);
-
-        cdpDataIndex += sizeof(cdp_mac);  // received from, MAC address = 6 bytes
-
-        cdpDataIndex += 2;
-        return cdpDataIndex;
-      } else {
-        return (0);
-      }
-    }
-  }
 
-  return (0);
-}
+// Decode the CDP frame into record. No data is copied, texts are views into cdpData.
+// Returns false if the frame is too short for the CDP header.
+bool cdp_decode(const byte cdpData[], uint16_t plen, CDP_RECORD* record) {
+  CDP_TLV tlv;
+  uint16_t cdpDataIndex = CDP_HEADER_LEN;
 
+  if (plen < CDP_HEADER_LEN)
+    return false;
 
-PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
-  unsigned int cdpDataIndex = 22;
-  int cdpVersion = cdpData[cdpDataIndex];
+  memset(record, 0, sizeof(CDP_RECORD));
 
+  // 1 byte: Version
   // 1 byte: TTL - Time To Live in seconds
-  cdpDataIndex++;
-  int cdpTtl = cdpData[cdpDataIndex];
-  cdpinfo.TTL[1] = cdpTtl;
-  cdpinfo.Proto[1] = "CDP";
-  cdpinfo.ProtoVer[1] = String(cdpVersion);
-  cdpDataIndex++;
-
   // 2 byte: Checksum
-  cdpDataIndex += 2;
-
-  while (cdpDataIndex < plen) {
-    unsigned int cdpFieldType = (cdpData[cdpDataIndex] << 8) | cdpData[cdpDataIndex + 1];
-    cdpDataIndex += 2;
-    unsigned int cdpFieldLength = (cdpData[cdpDataIndex] << 8) | cdpData[cdpDataIndex + 1];
-    cdpDataIndex += 2;
-    cdpFieldLength -= 4;
+  record->version = cdpData[CDP_SNAP_LEN];
+  record->ttl = cdpData[CDP_SNAP_LEN + 1];
+  record->checksum = (cdpData[CDP_SNAP_LEN + 2] << 8) | cdpData[CDP_SNAP_LEN + 3];
 
-    switch (cdpFieldType) {
-      case 0x0001:
+  while (cdp_nextTLV(cdpData, plen, &cdpDataIndex, &tlv)) {
+    switch (tlv.type) {
+      case CDP_TLV_DEVICEID:
         {
           // Device ID / Device name
-          // Split device name into name and domain
-          String tmpStr = handleCdpAsciiField(cdpData, cdpDataIndex, cdpFieldLength);
-          byte pos = tmpStr.indexOf('.');
-          if (pos > 0) {
-            cdpinfo.SWName[1] = tmpStr.substring(0, pos);
-            cdpinfo.SWDomain[1] = tmpStr.substring(pos + 1);
-          } else {
-            cdpinfo.SWName[1] = tmpStr;
-            cdpinfo.SWDomain[1] = "";
-          }
+          record->deviceID.data = tlv.value;
+          record->deviceID.length = tlv.length;
           break;
         }
 
-      case 0x0002:
+      case CDP_TLV_ADDRESSES:
         {
           // IP addresses
           // 4 byte: Number of addresses
@@ -120,23 +122,20 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
           //            0xAAAA03 000000 8019: Apollo Domain (protocol type 3D 2)
           //    2 byte: Address length
           //    4 byte: (for IP protocol?): IP address
-          cdpinfo.IP[1] = handleCdpAddresses(cdpData, cdpDataIndex, cdpFieldLength);
+          if (!cdp_firstIPv4(&tlv, record->address))
+            continue;
           break;
         }
 
-      case 0x0003:
+      case CDP_TLV_PORTID:
         {
           // Port ID / Port Name
-          // Strip unnecessary data, only having the last port number
-          String tmpStr = handleCdpAsciiField(cdpData, cdpDataIndex, cdpFieldLength);
-          if (tmpStr.indexOf('/') > 0) {
-            tmpStr = tmpStr.substring(tmpStr.lastIndexOf('/') + 1);
-          }
-          cdpinfo.Port[1] = tmpStr;
+          record->portID.data = tlv.value;
+          record->portID.length = tlv.length;
           break;
         }
 
-      case 0x0004:
+      case CDP_TLV_CAPABILITIES:
         {
           // Capabilities
           // 4 byte: Capabilities
@@ -151,24 +150,25 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
           //         0b000 0000 0000 0000 0000 000x 0000 0000 = Remotely Managed Device
           //         0b000 0000 0000 0000 0000 00x0 0000 0000 = CVTA/STP Dispute Resolution/Cisco VT Camera
           //         0b000 0000 0000 0000 0000 0x00 0000 0000 = Two Port Mac Relay
-          cdpinfo.Cap[1] = handleCdpCapabilities(cdpData, cdpDataIndex + 2, cdpFieldLength - 2);
+          if (tlv.length < 4)
+            continue;
+          record->capabilities = cdp_number(tlv.value, 4);
           break;
         }
 
-      case 0x0005:
+      case CDP_TLV_SWVERSION:
         {
           // Software version
-          cdpinfo.SWver[1] = handleCdpAsciiField(cdpData, cdpDataIndex, cdpFieldLength);
+          record->swVersion.data = tlv.value;
+          record->swVersion.length = tlv.length;
           break;
         }
 
-      case 0x0006:
+      case CDP_TLV_PLATFORM:
         {
           // Platform / CDP Model Name
-          //cdpinfo.Model[ 1 ] = handleCdpAsciiField( cdpData, cdpDataIndex, cdpFieldLength );
-          String tmpStr = handleCdpAsciiField(cdpData, cdpDataIndex, cdpFieldLength);
-          uint16_t tmp16 = tmpStr.indexOf("\n");
-          cdpinfo.Model[1] = tmpStr.substring(0, tmp16 - 1);
+          record->platform.data = tlv.value;
+          record->platform.length = tlv.length;
           break;
         }
 
@@ -195,71 +195,46 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
           //     6 byte: Switch's MAC Address
           //     1 byte: uNKNOWN
           //     2 byte: Management VLAN
-
-          /*
-        // Get 3 byte OUT
-        tmp32 = ( cdpData[ cdpDataIndex ] << 16 ) | ( cdpData[ cdpDataIndex + 1 ] << 8 ) | cdpData[ cdpDataIndex + 2 ];
-        cdpDataIndex += 3;
-        cdpFieldLength -= 3;
-
-        if( tmp32 == 0x0000000c )
-        {
-          // OUT: Cisco
-          // Get 2 byte protocol ID
-          tmp16 = ( cdpData[ cdpDataIndex ] << 8 ) | cdpData[ cdpDataIndex + 1 ];
-          cdpDataIndex += 2;
-          cdpFieldLength -= 2;
-
-          if( tmp16 == 0x0112 )
-          {
-            // Protocol ID: Cluster Management
-            // Get 4 byte Cluster Master IP
-
-            // ...
-
-            // Get Management VLAN
-            cdpinfo.MgmtVLAN[ 1 ] = String( ( cdpData[ cdpDataIndex + 25 ] << 8 ) | cdpData[ cdpDataIndex + 26 ], DEC );
-
-//            cdpinfo.MgmtVLAN[ 1 ] = handleCdpNumField( cdpData, cdpDataIndex + 25, cdpFieldLength - 25 );        
-//#ifdef DEBUGSERIAL
-//Serial.println( "CDP Hello MgmtVLAN: " + cdpinfo.MgmtVLAN[ 1 ] );
-//#endif
-          }
-        }
-*/
-          break;
+          continue;
         }
 
-      case 0x0009:
+      case CDP_TLV_VTPDOMAIN:
         {
           // VTP (VLAN Trunk Protocol) Management Domain
-          cdpinfo.VTP[1] = handleCdpAsciiField(cdpData, cdpDataIndex, cdpFieldLength);
+          record->vtpDomain.data = tlv.value;
+          record->vtpDomain.length = tlv.length;
           break;
         }
 
-      case 0x000a:
+      case CDP_TLV_NATIVEVLAN:
         {
           // Native VLAN / CDP VLAN #
           // 2 byte: VLAN Number
-          cdpinfo.VLAN[1] = handleCdpNumField(cdpData, cdpDataIndex, cdpFieldLength);
+          if (tlv.length < 2)
+            continue;
+          record->nativeVLAN = cdp_number(tlv.value, 2);
           break;
         }
 
-      case 0x000b:
+      case CDP_TLV_DUPLEX:
         {
           // Half or full duplex
           // 1 byte: Duplex
           //  0b0000 000x: 1 = Full Duplex
-          cdpinfo.Dup[1] = handleCdpDuplex(cdpData, cdpDataIndex, cdpFieldLength);
+          if (tlv.length < 1)
+            continue;
+          record->fullDuplex = (tlv.value[0] != 0);
           break;
         }
 
-      case 0x000e:
+      case CDP_TLV_VOICEVLAN:
         {
           // VoIP VLAN Reply / CDP VLAN voice#
           // 1 byte: Data
           // 2 byte: Voice VLAN Number
-          cdpinfo.VoiceVLAN[1] = handleCdpVoiceVLAN(cdpData, cdpDataIndex + 1, cdpFieldLength - 1);
+          if (tlv.length < 3)
+            continue;
+          record->voiceVLAN = cdp_number(tlv.value + 1, 2);
           break;
         }
 
@@ -277,20 +252,20 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
           // Since VLAN IDs are only 12 bit values it is not clear what is requested exactly.
           // Maybe used as bit fields?
 #ifdef DEBUGSERIAL
-          Serial.println("CDP VoIP VLAN query: " + handleCdpNumField(cdpData, cdpDataIndex, cdpFieldLength));
+          Serial.println("CDP VoIP VLAN query: " + String(cdp_number(tlv.value, tlv.length)));
 #endif
-          break;
+          continue;
         }
 
-      case 0x0010:
+      case CDP_TLV_POWERCONS:
         {
           // Power consumption, requested power by end device?
-          String tmpStr = handleCdpNumField(cdpData, cdpDataIndex, cdpFieldLength);
-          if (tmpStr != "0") {
-            cdpinfo.PoECons[1] = tmpStr + "mWh";
-          }
+          // 2 byte: Power in mW
+          if (tlv.length < 2)
+            continue;
+          record->powerConsumption = cdp_number(tlv.value, tlv.length);
 #ifdef DEBUGSERIAL
-          Serial.println("CDP Power consumption: " + cdpinfo.PoECons[1]);
+          Serial.println("CDP Power consumption: " + String(record->powerConsumption) + "mWh");
 #endif
           break;
         }
@@ -299,9 +274,9 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
         {
           // MTU
 #ifdef DEBUGSERIAL
-          Serial.println("CDP MTU: " + handleCdpNumField(cdpData, cdpDataIndex, cdpFieldLength));
+          Serial.println("CDP MTU: " + String(cdp_number(tlv.value, tlv.length)));
 #endif
-          break;
+          continue;
         }
 
       case 0x0012:
@@ -309,9 +284,9 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
           // Trust Bitmap
           // 1 byte: Trust Bitmap
 #ifdef DEBUGSERIAL
-          Serial.println("CDP Trust Bitmap: " + handleCdpNumField(cdpData, cdpDataIndex, cdpFieldLength));
+          Serial.println("CDP Trust Bitmap: " + String(cdp_number(tlv.value, tlv.length)));
 #endif
-          break;
+          continue;
         }
 
       case 0x0013:
@@ -319,30 +294,30 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
           // Untrusted Port CoS
           // 1 byte: Untrust Port CoS
 #ifdef DEBUGSERIAL
-          Serial.println("CDP Untrusted Port CoS: " + handleCdpNumField(cdpData, cdpDataIndex, cdpFieldLength));
+          Serial.println("CDP Untrusted Port CoS: " + String(cdp_number(tlv.value, tlv.length)));
 #endif
-          break;
+          continue;
         }
 
       case 0x0014:
         {
           // System Name
 #ifdef DEBUGSERIAL
-          Serial.println("CDP System Name: " + handleCdpAsciiField(cdpData, cdpDataIndex, cdpFieldLength));
+          Serial.println("CDP System Name: " + pinfo_debugText(tlv.value, tlv.length));
 #endif
-          break;
+          continue;
         }
 
       case 0x0015:
         {
           // System Object Identifier
 #ifdef DEBUGSERIAL
-          Serial.println("CDP System Object Identifier: " + handleCdpNumField(cdpData, cdpDataIndex, cdpFieldLength));
+          Serial.println("CDP System Object Identifier: " + String(cdp_number(tlv.value, tlv.length)));
 #endif
-          break;
+          continue;
         }
 
-      case 0x0016:
+      case CDP_TLV_MGMTADDRESSES:
         {
           // Management Address(es)
           // 4 byte: Number of addresses
@@ -354,18 +329,19 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
           //            0xcc: IP
           //    2 byte: Address length
           //    4 byte: (for IP protocol?): IP address
-          cdpinfo.MgmtIP[1] = handleCdpAddresses(cdpData, cdpDataIndex, cdpFieldLength);
+          if (!cdp_firstIPv4(&tlv, record->mgmtAddress))
+            continue;
           break;
         }
 
-
       case 0x0017:
-        // Location
+        {
+          // Location
 #ifdef DEBUGSERIAL
-        Serial.println("CDP Location: " + handleCdpNumField(cdpData, cdpDataIndex, cdpFieldLength));
+          Serial.println("CDP Location: " + String(cdp_number(tlv.value, tlv.length)));
 #endif
-        break;
-
+          continue;
+        }
 
         /*
       case 0x0018:
@@ -379,26 +355,18 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
         break;
 */
 
-      case 0x001a:
+      case CDP_TLV_POWERAVAIL:
         {
           // Power Available
           // 2 byte: Request ID
           // 2 byte: Management-ID
           // 4 byte: Power Available in mW
           // 4 byte: UNKNOWN? 0xffffffff
-          if (cdpFieldLength < 9) {
-            cdpinfo.PoEAvail[1] = "not available";
-            break;
-          }
-
-          cdpinfo.PoEAvail[1] = handleCdpNumField(cdpData, cdpDataIndex + 4, cdpFieldLength - 8) + "mWh";
-          String tmpStr = handleCdpNumField(cdpData, cdpDataIndex + 4, cdpFieldLength - 8);
-          if (tmpStr != "0") {
-            cdpinfo.PoEAvail[1] = tmpStr + "mWh";
+          if (tlv.length >= 8)
+            record->powerAvailable = cdp_number(tlv.value + 4, 4);
 #ifdef DEBUGSERIAL
-            Serial.println("Power Available: " + cdpinfo.PoEAvail[1]);
+          Serial.println("Power Available: " + String(record->powerAvailable) + "mWh");
 #endif
-          }
           break;
         }
 
@@ -423,9 +391,9 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
           //        0b0000 0x00 = PD Request Spare Pair PoE
           //        0b0000 x000 = PSE Spare Pair PoE
 #ifdef DEBUGSERIAL
-          Serial.println("CDP Spare Pair PoE: " + handleCdpNumField(cdpData, cdpDataIndex, cdpFieldLength));
+          Serial.println("CDP Spare Pair PoE: " + String(cdp_number(tlv.value, tlv.length)));
 #endif
-          break;
+          continue;
         }
 
       case 0x1003:
@@ -433,189 +401,295 @@ PINFO cdp_packet_handler(byte cdpData[], size_t plen) {
           // Radio Channel
           // 1 byte: Platform
 #ifdef DEBUGSERIAL
-          Serial.println("CDP Radio Channel: " + handleCdpAsciiField(cdpData, cdpDataIndex, cdpFieldLength));
+          Serial.println("CDP Radio Channel: " + pinfo_debugText(tlv.value, tlv.length));
 #endif
-          break;
+          continue;
         }
 
       default:
         {
 #ifdef DEBUGSERIAL
-          Serial.println("CDP unhandled type: 0x" + String(cdpFieldType, HEX));
-          Serial.println("CDP field length:   " + String(cdpFieldLength, DEC));
-          for (uint16_t i = 0; i < cdpFieldLength; i++) {
-            String data = "00" + String(cdpData[cdpDataIndex + i], HEX);
-            data = "0x" + data.substring(data.length() - 2);
-            Serial.print(data + " ");
+          Serial.printf("CDP unhandled type: 0x%x\n", tlv.type);
+          Serial.printf("CDP field length:   %u\n", tlv.length);
+          for (uint16_t i = 0; i < tlv.length; i++) {
+            Serial.printf("0x%02x ", tlv.value[i]);
             if (((i + 1) % 8) == 0) Serial.println();
           }
           Serial.println();
 #endif
-          break;
+          continue;
         }
-    }
-    cdpDataIndex += cdpFieldLength;
+    }  // switch( tlv.type )
+
+    // Remember the decoded TLV
+    record->fields |= CDP_FIELD(tlv.type);
+  }  // while( cdp_nextTLV() )
+
+  return true;
+}  // bool cdp_decode()
+
+
+// Digest over the source MAC, the version and the TLVs. The TTL is returned in *ttl,
+// TTL and checksum are not part of the digest.
+uint32_t cdp_digest(const byte cdpData[], uint16_t plen, uint16_t* ttl) {
+  *ttl = 0;
+  if (plen < CDP_HEADER_LEN)
+    return 0;
+
+  *ttl = cdpData[CDP_SNAP_LEN + 1];
+  uint32_t digest = pinfo_hash(PINFO_HASHINIT, cdpData + sizeof(cdp_mac), sizeof(cdp_mac));
+  digest = pinfo_hash(digest, cdpData + CDP_SNAP_LEN, 1);
+  return pinfo_hash(digest, cdpData + CDP_HEADER_LEN, plen - CDP_HEADER_LEN);
+}  // uint32_t cdp_digest()
+
+// Decode the CDP frame and update the received values in info
+void cdp_packet_handler(const byte cdpData[], uint16_t plen, PINFO* info) {
+  CDP_RECORD record;
+
+  if (!cdp_decode(cdpData, plen, &record))
+    return;
+
+  info->proto = pinfo_ProtoCDP;
+  info->protoVer = record.version;
+  info->ttl = record.ttl;
+  info->checksum = record.checksum;
+  info->fields |= PINFO_FIELD(pinfo_Proto) | PINFO_FIELD(pinfo_ProtoVer) | PINFO_FIELD(pinfo_TTL) | PINFO_FIELD(pinfo_Checksum);
+
+  // Get source MAC Address
+  memcpy(info->mac, cdpData + sizeof(cdp_mac), sizeof(info->mac));
+  pinfo_set(info, pinfo_MAC);
+
+  if (record.fields & CDP_FIELD(CDP_TLV_DEVICEID)) {
+    // Split device name into name and domain
+    uint16_t pos = 0;
+    while ((pos < record.deviceID.length) && (record.deviceID.data[pos] != '.'))
+      pos++;
+    pinfo_setText(info, pinfo_SWName, record.deviceID.data, pos);
+    if (pos < record.deviceID.length)
+      pinfo_setText(info, pinfo_SWDomain, record.deviceID.data + pos + 1, record.deviceID.length - pos - 1);
+    else
+      pinfo_setText(info, pinfo_SWDomain, record.deviceID.data, 0);
   }
-  return cdpinfo;
-}
 
-bool byte_array_contains(const byte a[], unsigned int offset, const byte b[], unsigned int length) {
-  for (unsigned int i = offset, j = 0; j < length; ++i, ++j) {
-    if (a[i] != b[j]) {
-      return false;
-    }
+  if (record.fields & CDP_FIELD(CDP_TLV_ADDRESSES)) {
+    memcpy(info->ip, record.address, IP_LEN);
+    pinfo_set(info, pinfo_IP);
   }
-  return true;
-}
 
-String print_mac(const byte a[], unsigned int offset, unsigned int length) {
-  String Mac = "";
-  for (unsigned int i = offset; i < offset + length; ++i) {
-    if (a[i] < 0x10)
-      Mac += ('0');
+  // Strip unnecessary data, only having the last port number
+  if (record.fields & CDP_FIELD(CDP_TLV_PORTID))
+    pinfo_setLastPart(info, pinfo_Port, record.portID.data, record.portID.length);
 
-    Mac += String(a[i], HEX);
+  if (record.fields & CDP_FIELD(CDP_TLV_CAPABILITIES)) {
+    // CDP only knows one mask, the capabilities are enabled
+    info->sysCap = record.capabilities;
+    info->cap = record.capabilities;
+    pinfo_set(info, pinfo_Cap);
   }
-  return Mac;
-}
 
-String CdpCapabilities(String temp) {
-  String output;
+  if (record.fields & CDP_FIELD(CDP_TLV_SWVERSION))
+    pinfo_setText(info, pinfo_SWver, record.swVersion.data, record.swVersion.length);
 
-  if (temp.substring(15, 16) == "1") {
-    output = output + "Router ";
-  }
-  if (temp.substring(14, 15) == "1") {
-    output = output + "Trans_Bridge ";
-  }
-  if (temp.substring(13, 14) == "1") {
-    output = output + "Route_Bridge,";
-  }
-  if (temp.substring(12, 13) == "1") {
-    output = output + "Switch ";
-  }
-  if (temp.substring(11, 12) == "1") {
-    output = output + "Host ";
-  }
-  if (temp.substring(10, 11) == "1") {
-    output = output + "IGMP ";
+  if (record.fields & CDP_FIELD(CDP_TLV_PLATFORM))
+    pinfo_setFirstLine(info, pinfo_Model, record.platform.data, record.platform.length);
+
+  if (record.fields & CDP_FIELD(CDP_TLV_VTPDOMAIN))
+    pinfo_setText(info, pinfo_VTP, record.vtpDomain.data, record.vtpDomain.length);
+
+  if (record.fields & CDP_FIELD(CDP_TLV_NATIVEVLAN)) {
+    info->vlan = record.nativeVLAN;
+    pinfo_set(info, pinfo_VLAN);
   }
-  if (temp.substring(9, 10) == "1") {
-    output = output + "Repeater ";
+
+  if (record.fields & CDP_FIELD(CDP_TLV_DUPLEX)) {
+    info->fullDuplex = record.fullDuplex;
+    pinfo_set(info, pinfo_Dup);
   }
-  if (temp.substring(8, 9) == "1") {
-    output = output + "VoIP Phone ";
+
+  if (record.fields & CDP_FIELD(CDP_TLV_VOICEVLAN)) {
+    info->voiceVLAN = record.voiceVLAN;
+    pinfo_set(info, pinfo_VoiceVLAN);
   }
-  if (temp.substring(7, 8) == "1") {
-    output = output + "RemMgmDev ";
+
+  if ((record.fields & CDP_FIELD(CDP_TLV_POWERCONS)) && (record.powerConsumption != 0)) {
+    info->poeCons = record.powerConsumption;
+    pinfo_set(info, pinfo_PoECons);
   }
-  if (temp.substring(6, 7) == "1") {
-    output = output + "Camera ";
+
+  if (record.fields & CDP_FIELD(CDP_TLV_MGMTADDRESSES)) {
+    memcpy(info->mgmtIP, record.mgmtAddress, IP_LEN);
+    pinfo_set(info, pinfo_MgmtIP);
   }
-  if (temp.substring(5, 6) == "1") {
-    output = output + "2PortMacRelay ";
+
+  // 0 is shown as "not available"
+  if (record.fields & CDP_FIELD(CDP_TLV_POWERAVAIL)) {
+    info->poeAvail = record.powerAvailable;
+    pinfo_set(info, pinfo_PoEAvail);
   }
+}  // void cdp_packet_handler()
 
-  return output;
-}
+// Search the address list of the TLV for the first IPv4 address.
+// Every entry is checked against the length of the TLV before it is read.
+bool cdp_firstIPv4(const CDP_TLV* tlv, byte address[]) {
+  if (tlv->length < 4)
+    return false;
 
-String handleCdpCapabilities(const byte a[], unsigned int offset, unsigned int lengtha) {
-  String temp;
-  for (unsigned int i = offset; i < (offset + lengtha); ++i) {
-    temp = temp + print_binary(a[i], 8);
-  }
-  return CdpCapabilities(temp);
-}
+  uint32_t numOfAddrs = cdp_number(tlv->value, 4);
+  uint16_t offset = 4;
 
-String print_binary(int v, int num_places) {
-  String output;
-  int mask = 0, n;
-  for (n = 1; n <= num_places; n++) {
-    mask = (mask << 1) | 0x0001;
-  }
-  v = v & mask;  // truncate v to specified number of places
+  for (uint32_t i = 0; i < numOfAddrs; ++i) {
+    // Protocol type and protocol length
+    if ((offset + 2) > tlv->length)
+      return false;
+    byte protoType = tlv->value[offset];
+    byte protoLength = tlv->value[offset + 1];
+    offset += 2;
+
+    // Protocol and address length
+    if ((offset + protoLength + 2) > tlv->length)
+      return false;
+    bool isIP = (protoType == 0x01) && (protoLength == 1) && (tlv->value[offset] == 0xcc);
+    offset += protoLength;
+    uint16_t addressLength = cdp_number(tlv->value + offset, 2);
+    offset += 2;
 
-  while (num_places) {
-    if (v & ((0x0001 << num_places) - 1)) {
-      output = output + "1";
-    } else {
-      output = output + "0";
+    // Address
+    if ((offset + addressLength) > tlv->length)
+      return false;
+    if (isIP && (addressLength == IP_LEN)) {
+      memcpy(address, tlv->value + offset, IP_LEN);
+      return true;
     }
-    --num_places;
+    offset += addressLength;
   }
-  return output;
+  return false;
+}  // bool cdp_firstIPv4()
+
+// Big endian number with up to 4 bytes
+uint32_t cdp_number(const byte a[], uint16_t length) {
+  uint32_t num = 0;
+  if (length > 4)
+    length = 4;
+  for (uint16_t i = 0; i < length; ++i)
+    num = (num << 8) | a[i];
+  return num;
 }
 
-String handleCdpNumField(const byte a[], unsigned int offset, unsigned int length) {
-  unsigned long num = 0;
-  String temp;
-  for (unsigned int i = 0; i < length; ++i) {
-    num <<= 8;
-    num += a[offset + i];
+// CDP checksum over the CDP header and TLVs, the 16 bit one's complement sum of RFC 1071.
+// Different from RFC 1071 Cisco adds an odd last byte sign-extended to a 32 bit sum, which wraps
+// and loses one carry for a byte of 0x80 or more. Like Wireshark 0xff00 | (byte - 1) is added then.
+uint16_t cdp_checksum(const byte data[], uint16_t length) {
+  uint32_t sum = 0;
+  uint16_t i = 0;
+  for (; (i + 1) < length; i += 2)
+    sum += (data[i] << 8) | data[i + 1];
+  if (i < length)
+    sum += (data[i] & 0x80) ? (0xff00 | (data[i] - 1)) : data[i];
+  while (sum >> 16)
+    sum = (sum & 0xffff) + (sum >> 16);
+  return ~sum & 0xffff;
+}  // uint16_t cdp_checksum()
+
+// Cached own CDP frame, see cdp_buildFrame()
+static byte cdp_txFrame[CDP_TXMAXLEN];
+static uint16_t cdp_txLength = 0;
+
+// Append a TLV header and return the position of its value, NULL if the TLV does not fit
+static byte* cdp_putTLV(byte frame[], uint16_t* length, bool* overflow, uint16_t type, uint16_t valueLength) {
+  if ((*length + 4 + valueLength) > CDP_TXMAXLEN) {
+    *overflow = true;
+    return NULL;
   }
-  temp = String(num, DEC);
-  return temp;
+  byte* tlv = frame + *length;
+  tlv[0] = type >> 8;
+  tlv[1] = type & 0xff;
+  tlv[2] = (valueLength + 4) >> 8;
+  tlv[3] = (valueLength + 4) & 0xff;
+  *length += 4 + valueLength;
+  return tlv + 4;
 }
 
-String handleCdpVoiceVLAN(const byte a[], unsigned int offset, unsigned int length) {
-  unsigned long num = 0;
-  for (unsigned int i = offset; i < (offset + length); ++i) {
-    num <<= 8;
-    num += a[i];
-  }
-  return String(num, DEC);
+// TLV with a text
+static void cdp_putText(byte frame[], uint16_t* length, bool* overflow, uint16_t type, const char* text) {
+  uint16_t textLength = strlen(text);
+  byte* value = cdp_putTLV(frame, length, overflow, type, textLength);
+  if (value != NULL)
+    memcpy(value, text, textLength);
 }
 
-String handleCdpAddresses(const byte a[], unsigned int offset, unsigned int lengtha) {
-  String temp;
-  unsigned long numOfAddrs = (a[offset] << 24) | (a[offset + 1] << 16) | (a[offset + 2] << 8) | a[offset + 3];
-  offset += 4;
-
-  if (numOfAddrs < 5) {
-    for (unsigned long i = 0; i < numOfAddrs; ++i) {
-      offset++;
-      unsigned int protoLength = a[offset++];
-      offset += protoLength;
-      unsigned int addressLength = (a[offset] << 8) | a[offset + 1];
-      offset += 2;
-      byte address[4];
-      if (addressLength != 4) {
-        return ("");
-      } else {
-        for (unsigned int j = 0; j < addressLength; ++j) {
-          address[j] = a[offset++];
-          temp += address[j];
-          if (j < 3) {
-            temp += ".";
-          }
-        }
-      }
-    }
-
-    return temp;
-  } else {
-    return "CORRUPT_IP";
+// Build the own CDPv2 frame from the MAC address, the device name and the configuration.
+// The frame announces a phone and queries the voice VLAN, which lets a Cisco switch
+// answer with a triggered CDP update instead of waiting for its 60 s interval.
+// Returns false if the frame does not fit into CDP_TXMAXLEN, nothing will be sent in this case.
+bool cdp_buildFrame(const byte mac[], const char* deviceName, const CDP_TXCONFIG* config) {
+  uint16_t length = CDP_HEADER_LEN;
+  bool overflow = false;
+  byte* value;
+
+  // IEEE 802.3 header with LLC/SNAP: DSAP/SSAP 0xaa, UI, OUI Cisco, protocol ID 0x2000
+  memcpy(cdp_txFrame, cdp_mac, 6);
+  memcpy(cdp_txFrame + 6, mac, 6);
+  static const byte snap[] = { 0xaa, 0xaa, 0x03, 0x00, 0x00, 0x0c, 0x20, 0x00 };
+  memcpy(cdp_txFrame + 14, snap, sizeof(snap));
+
+  // CDP version 2, TTL, checksum below
+  cdp_txFrame[CDP_SNAP_LEN] = 2;
+  cdp_txFrame[CDP_SNAP_LEN + 1] = config->ttl;
+  cdp_txFrame[CDP_SNAP_LEN + 2] = 0;
+  cdp_txFrame[CDP_SNAP_LEN + 3] = 0;
+
+  cdp_putText(cdp_txFrame, &length, &overflow, CDP_TLV_DEVICEID, deviceName);
+  cdp_putText(cdp_txFrame, &length, &overflow, CDP_TLV_PORTID, config->portID);
+  if ((value = cdp_putTLV(cdp_txFrame, &length, &overflow, CDP_TLV_CAPABILITIES, 4)) != NULL) {
+    value[0] = (config->capabilities >> 24) & 0xff;
+    value[1] = (config->capabilities >> 16) & 0xff;
+    value[2] = (config->capabilities >> 8) & 0xff;
+    value[3] = config->capabilities & 0xff;
   }
-}
-
-String handleCdpDuplex(const byte a[], unsigned int offset, unsigned int length) {
-  String temp;
-  if (a[offset]) {
-    temp = "Full";
-  } else {
-    temp = "Half";
+  cdp_putText(cdp_txFrame, &length, &overflow, CDP_TLV_SWVERSION, config->swVersion);
+  cdp_putText(cdp_txFrame, &length, &overflow, CDP_TLV_PLATFORM, config->platform);
+  if ((value = cdp_putTLV(cdp_txFrame, &length, &overflow, CDP_TLV_DUPLEX, 1)) != NULL)
+    value[0] = 0x01;
+
+  // VoIP VLAN query: the 4 bytes 0x20 0x02 0x00 0x01 sent by a Yealink W60, see cdp_decode()
+  if ((value = cdp_putTLV(cdp_txFrame, &length, &overflow, CDP_TLV_VOICEQUERY, 4)) != NULL) {
+    value[0] = 0x20;
+    value[1] = 0x02;
+    value[2] = 0x00;
+    value[3] = 0x01;
   }
-  return temp;
-}
 
-String handleCdpAsciiField(byte a[], unsigned int offset, unsigned int lengtha) {
-  int j = 0;
-  char temp[lengtha + 1];
-  for (unsigned int i = offset; i < (offset + lengtha); ++i, ++j) {
-    temp[j] = a[i];
+  // IEEE 802.3 length field and checksum
+  uint16_t frameLength = length - 14;
+  cdp_txFrame[12] = frameLength >> 8;
+  cdp_txFrame[13] = frameLength & 0xff;
+  uint16_t checksum = cdp_checksum(cdp_txFrame + CDP_SNAP_LEN, length - CDP_SNAP_LEN);
+  cdp_txFrame[CDP_SNAP_LEN + 2] = checksum >> 8;
+  cdp_txFrame[CDP_SNAP_LEN + 3] = checksum & 0xff;
+
+  cdp_txLength = overflow ? 0 : length;
+#ifdef DEBUGSERIAL
+  Serial.printf("cdp_buildFrame(): %u bytes%s\n", length, overflow ? ", too long" : "");
+#endif
+  return !overflow;
+}  // bool cdp_buildFrame()
+
+// Send the cached CDP frame to the CDP broadcast address, always untagged
+void send_CDP(uint16_t voiceVLAN, unsigned long* lastCDPsent) {
+  if (cdp_txLength == 0)
+    return;
+
+  memcpy(Ethernet::buffer, cdp_txFrame, cdp_txLength);
+
+  bool wastagged = false;
+  if (ENC28J60::is_VLAN_tagging_enabled()) {
+    ENC28J60::disable_VLAN_tagging();
+    wastagged = true;
+  }
+  ether.packetSend(cdp_txLength);
+  if (wastagged) {
+    ENC28J60::enable_VLAN_tagging(voiceVLAN);
   }
-  temp[lengtha] = '\0';
 
-  String temp1 = temp;
-  return temp1;
-}
+  *lastCDPsent = millis();
+}  // void send_CDP()
@@ -10,30 +10,95 @@ Some details added as description / comments from WireShark
 #include <EtherCard.h>
 #include <Arduino.h>
 #include "Packet_data.h"
+#include "frame_functions.h"
 
 #ifndef CDP_FUNCTIONS_H
 #define CDP_FUNCTIONS_H
 
+// CDP header: 14 byte Ethernet header, 8 byte LLC/SNAP header, version, TTL and checksum
+static const uint16_t CDP_SNAP_LEN = 22;
+static const uint16_t CDP_HEADER_LEN = 26;
+
+// TLV types
+static const uint16_t CDP_TLV_DEVICEID = 0x0001;
+static const uint16_t CDP_TLV_ADDRESSES = 0x0002;
+static const uint16_t CDP_TLV_PORTID = 0x0003;
+static const uint16_t CDP_TLV_CAPABILITIES = 0x0004;
+static const uint16_t CDP_TLV_SWVERSION = 0x0005;
+static const uint16_t CDP_TLV_PLATFORM = 0x0006;
+static const uint16_t CDP_TLV_VTPDOMAIN = 0x0009;
+static const uint16_t CDP_TLV_NATIVEVLAN = 0x000a;
+static const uint16_t CDP_TLV_DUPLEX = 0x000b;
+static const uint16_t CDP_TLV_VOICEVLAN = 0x000e;
+static const uint16_t CDP_TLV_VOICEQUERY = 0x000f;
+static const uint16_t CDP_TLV_POWERCONS = 0x0010;
+static const uint16_t CDP_TLV_MGMTADDRESSES = 0x0016;
+static const uint16_t CDP_TLV_POWERAVAIL = 0x001a;
+
+// Bit in CDP_RECORD.fields for the TLV type, only used for types below 32
+#define CDP_FIELD(type) (1UL << (type))
+
+// View of a single TLV inside the received frame. Nothing is copied, value points into
+// the buffer given to cdp_nextTLV() and is valid as long as it is not changed.
+struct CDP_TLV {
+  uint16_t type;
+  uint16_t length;    // Length of the value, without type and length field
+  const byte* value;
+};
+
+// View of a text or binary value inside the received frame
+struct CDP_VIEW {
+  const byte* data;
+  uint16_t length;
+};
+
+// Decoded CDP frame with a fixed layout. Only the values flagged in fields are valid.
+struct CDP_RECORD {
+  uint8_t version;
+  uint8_t ttl;                // Time to live in seconds
+  uint16_t checksum;
+  uint32_t fields;            // CDP_FIELD() bits of the decoded TLVs
+  CDP_VIEW deviceID;          // Device name including domain
+  CDP_VIEW portID;
+  CDP_VIEW swVersion;
+  CDP_VIEW platform;
+  CDP_VIEW vtpDomain;
+  byte address[IP_LEN];       // First IPv4 address
+  byte mgmtAddress[IP_LEN];   // First IPv4 management address
+  uint32_t capabilities;
+  uint16_t nativeVLAN;
+  uint16_t voiceVLAN;
+  bool fullDuplex;
+  uint32_t powerConsumption;  // mW
+  uint32_t powerAvailable;    // mW, 0 if not available
+};
+
 // Main fuctions
-unsigned int cdp_check_Packet(byte EthBuffer[], unsigned int length);
-PINFO cdp_packet_handler(byte cdpData[], size_t plen);
+bool cdp_nextTLV(const byte cdpData[], uint16_t plen, uint16_t* index, CDP_TLV* tlv);
+eFrameCheck cdp_validate(const byte cdpData[], uint16_t* plen);
+bool cdp_decode(const byte cdpData[], uint16_t plen, CDP_RECORD* record);
+uint32_t cdp_digest(const byte cdpData[], uint16_t plen, uint16_t* ttl);
+void cdp_packet_handler(const byte cdpData[], uint16_t plen, PINFO* info);
 
 // Packet Handling Functions
-String handleCdpCapabilities(const byte a[], unsigned int offset, unsigned int lengtha);
-String handleCdpNumField(const byte a[], unsigned int offset, unsigned int length);
-String handleCdpVoiceVLAN(const byte a[], unsigned int offset, unsigned int length);
-String handleCdpAddresses(const byte a[], unsigned int offset, unsigned int length);
-String handleCdpDuplex(const byte a[], unsigned int offset, unsigned int length);
-String handleCdpAsciiField(byte a[], unsigned int offset, unsigned int lengtha);
-
-// Supporting Functions
-bool byte_array_contains(const byte a[], unsigned int offset, const byte b[], unsigned int length);
-String print_mac(const byte a[], unsigned int offset, unsigned int length);
-String CdpCapabilities(String temp);
-String print_binary(int v, int num_places);
-String print_ip(const byte a[], unsigned int offset, unsigned int length);
-String print_mac(const byte a[], unsigned int offset, unsigned int length);
-char val2dec(byte b);
-String cdp_getHEX(const byte a[], unsigned int offset, unsigned int length);
+bool cdp_firstIPv4(const CDP_TLV* tlv, byte address[]);
+uint32_t cdp_number(const byte a[], uint16_t length);
+uint16_t cdp_checksum(const byte data[], uint16_t length);
+
+// Own CDPv2 announcement
+// The frame is built once by cdp_buildFrame() and cached for send_CDP().
+static const uint16_t CDP_TXMAXLEN = 256;
+
+// Content of the own CDP frame
+struct CDP_TXCONFIG {
+  uint8_t ttl;            // Time to live in seconds
+  const char* portID;     // Port ID
+  uint32_t capabilities;  // Capabilities: 0x10 host, 0x80 phone
+  const char* swVersion;  // Software version
+  const char* platform;   // Platform
+};
+
+bool cdp_buildFrame(const byte mac[], const char* deviceName, const CDP_TXCONFIG* config);
+void send_CDP(uint16_t voiceVLAN, unsigned long* lastCDPsent);
 
 #endif
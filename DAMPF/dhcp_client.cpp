@@ -0,0 +1,457 @@
+/*
+dhcp_client.cpp
+
+DHCP client with independent contexts.
+
+The transaction ID carries the index of the context, so dhcpc_receive() matches an answer to
+its context without a search and ignores answers to an older transaction. All messages are
+built in the EtherCard buffer and only sent by dhcpc_process(), so the loop decides when the
+buffer may be overwritten. A lease context requests the offered address, is renewed after half
+of the lease time and stores the options of the ACK in its option store. A probe context only
+sends a DISCOVER and keeps the address, network mask, gateway and server of the OFFER.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "dhcp_client.h"
+
+// UDP ports
+static const uint16_t DHCPC_SERVER_PORT = 67;
+static const uint16_t DHCPC_CLIENT_PORT = 68;
+
+// Offsets in the BOOTP message
+static const uint8_t DHCPC_BOOTP_OP = 0;
+static const uint8_t DHCPC_BOOTP_XID = 4;
+static const uint8_t DHCPC_BOOTP_FLAGS = 10;
+static const uint8_t DHCPC_BOOTP_CIADDR = 12;
+static const uint8_t DHCPC_BOOTP_YIADDR = 16;
+static const uint8_t DHCPC_BOOTP_CHADDR = 28;
+static const uint8_t DHCPC_BOOTP_COOKIE = 236;
+static const uint32_t DHCPC_COOKIE = 0x63825363UL;
+
+// Minimum BOOTP message size (RFC 1542) and the size with the longest option list sent here
+static const uint16_t DHCPC_BOOTPLEN = 300;
+static const uint16_t DHCPC_MAXBOOTPLEN = 340;
+
+// Longest host name sent in option 12
+static const uint8_t DHCPC_HOSTNAMELEN = 32;
+
+// DHCP message types
+static const uint8_t DHCPC_DISCOVER = 1;
+static const uint8_t DHCPC_OFFER = 2;
+static const uint8_t DHCPC_REQUEST = 3;
+static const uint8_t DHCPC_ACK = 5;
+static const uint8_t DHCPC_NAK = 6;
+static const uint8_t DHCPC_RELEASE = 7;
+
+// Options used here
+static const uint8_t DHCPC_OPT_PAD = 0;
+static const uint8_t DHCPC_OPT_MASK = 1;
+static const uint8_t DHCPC_OPT_ROUTER = 3;
+static const uint8_t DHCPC_OPT_DNS = 6;
+static const uint8_t DHCPC_OPT_HOSTNAME = 12;
+static const uint8_t DHCPC_OPT_REQUESTEDIP = 50;
+static const uint8_t DHCPC_OPT_LEASETIME = 51;
+static const uint8_t DHCPC_OPT_MSGTYPE = 53;
+static const uint8_t DHCPC_OPT_SERVER = 54;
+static const uint8_t DHCPC_OPT_PRL = 55;
+static const uint8_t DHCPC_OPT_CLIENTID = 61;
+static const uint8_t DHCPC_OPT_END = 255;
+
+// Parameters requested for a lease, the options shown on the DHCP pages, and for a probe
+static const byte DHCPC_LEASEPRL[] = { 1, 3, 6, 15, 28, 42, 43, 66, 67, 119, 120, 132, 150, 242 };
+static const byte DHCPC_PROBEPRL[] = { DHCPC_OPT_MASK, DHCPC_OPT_ROUTER };
+
+// Transaction ID: "D", the index of the context and a sequence number
+static const uint32_t DHCPC_XIDPREFIX = 0x44000000UL;
+static const uint32_t DHCPC_XIDPREFIXMASK = 0xff000000UL;
+
+// Lease time in s without option 51, the infinite lease and the longest lease renewed in time,
+// half of it in ms has to fit into millis()
+static const uint32_t DHCPC_DEFAULTLEASE = 3600;
+static const uint32_t DHCPC_INFINITELEASE = 0xffffffffUL;
+static const uint32_t DHCPC_MAXLEASE = 0x400000UL;
+
+static DHCPC_CONTEXT dhcpc_contexts[DHCPC_CONTEXTS];
+static byte dhcpc_mac[ETH_LEN];
+static const char* dhcpc_hostname = NULL;
+static uint16_t dhcpc_sequence = 0;
+
+static inline uint16_t dhcpc_get16(const byte a[]) {
+  return (a[0] << 8) | a[1];
+}
+
+static inline uint32_t dhcpc_get32(const byte a[]) {
+  return ((uint32_t)a[0] << 24) | ((uint32_t)a[1] << 16) | ((uint32_t)a[2] << 8) | a[3];
+}
+
+static inline void dhcpc_put16(byte a[], uint16_t value) {
+  a[0] = value >> 8;
+  a[1] = value & 0xff;
+}
+
+static inline void dhcpc_put32(byte a[], uint32_t value) {
+  dhcpc_put16(a, value >> 16);
+  dhcpc_put16(a + 2, value & 0xffff);
+}
+
+// IPv4 header checksum (RFC 1071)
+static uint16_t dhcpc_ipChecksum(const byte header[], uint8_t length) {
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < length; i += 2)
+    sum += dhcpc_get16(header + i);
+  while ((sum >> 16) != 0)
+    sum = (sum & 0xffff) + (sum >> 16);
+  return ~sum & 0xffff;
+}
+
+static byte* dhcpc_putOption(byte* pos, uint8_t code, const byte data[], uint8_t length) {
+  pos[0] = code;
+  pos[1] = length;
+  memcpy(pos + 2, data, length);
+  return pos + 2 + length;
+}
+
+// Time in ms after which a lease is renewed
+static unsigned long dhcpc_renewTime(uint32_t leaseTime) {
+  if (leaseTime > DHCPC_MAXLEASE)
+    leaseTime = DHCPC_MAXLEASE;
+  return (unsigned long)leaseTime * 500;
+}
+
+// New transaction of a context, answers to the last one are ignored
+static void dhcpc_newTransaction(uint8_t index) {
+  dhcpc_contexts[index].xid = DHCPC_XIDPREFIX | ((uint32_t)index << 16) | dhcpc_sequence++;
+}
+
+// Build a message of the context in the EtherCard buffer and send it. The tagging of EtherCard is
+// disabled while sending, the frames of a context with a VLAN ID have their own tag.
+static void dhcpc_send(const DHCPC_CONTEXT* context, uint8_t msgType, uint16_t voiceVLAN) {
+  uint16_t ipPos = (context->vlan != 0) ? FRAME_VLAN_HEADER_LEN : FRAME_ETH_HEADER_LEN;
+  uint16_t udpPos = ipPos + 20;
+  uint16_t bootpPos = udpPos + 8;
+  byte* frame = Ethernet::buffer;
+  memset(frame, 0, bootpPos + DHCPC_MAXBOOTPLEN);
+
+  // The RELEASE is sent to the server, the other messages are broadcasts
+  bool release = msgType == DHCPC_RELEASE;
+  if (release)
+    memcpy(frame, context->serverMAC, ETH_LEN);
+  else
+    memset(frame, 0xff, ETH_LEN);
+  memcpy(frame + ETH_LEN, dhcpc_mac, ETH_LEN);
+  if (context->vlan != 0) {
+    dhcpc_put16(frame + 12, 0x8100);
+    dhcpc_put16(frame + 14, context->vlan);
+  }
+  dhcpc_put16(frame + ipPos - 2, 0x0800);
+
+  // Broadcast flag, so the answer is received before the address is configured
+  byte* bootp = frame + bootpPos;
+  bootp[DHCPC_BOOTP_OP] = 1;
+  bootp[1] = 1;  // Ethernet
+  bootp[2] = ETH_LEN;
+  dhcpc_put32(bootp + DHCPC_BOOTP_XID, context->xid);
+  if (release)
+    memcpy(bootp + DHCPC_BOOTP_CIADDR, context->ip, IP_LEN);
+  else
+    bootp[DHCPC_BOOTP_FLAGS] = 0x80;
+  memcpy(bootp + DHCPC_BOOTP_CHADDR, dhcpc_mac, ETH_LEN);
+  dhcpc_put32(bootp + DHCPC_BOOTP_COOKIE, DHCPC_COOKIE);
+
+  byte* pos = bootp + DHCPC_BOOTP_COOKIE + 4;
+  pos = dhcpc_putOption(pos, DHCPC_OPT_MSGTYPE, &msgType, 1);
+  byte clientID[ETH_LEN + 1];
+  clientID[0] = 1;  // Ethernet
+  memcpy(clientID + 1, dhcpc_mac, ETH_LEN);
+  pos = dhcpc_putOption(pos, DHCPC_OPT_CLIENTID, clientID, sizeof(clientID));
+  if (msgType == DHCPC_REQUEST)
+    pos = dhcpc_putOption(pos, DHCPC_OPT_REQUESTEDIP, context->ip, IP_LEN);
+  if ((msgType == DHCPC_REQUEST) || release)
+    pos = dhcpc_putOption(pos, DHCPC_OPT_SERVER, context->server, IP_LEN);
+  if (!context->probe && !release && (dhcpc_hostname != NULL)) {
+    size_t length = strlen(dhcpc_hostname);
+    if (length > DHCPC_HOSTNAMELEN)
+      length = DHCPC_HOSTNAMELEN;
+    pos = dhcpc_putOption(pos, DHCPC_OPT_HOSTNAME, (const byte*)dhcpc_hostname, length);
+  }
+  if (context->probe)
+    pos = dhcpc_putOption(pos, DHCPC_OPT_PRL, DHCPC_PROBEPRL, sizeof(DHCPC_PROBEPRL));
+  else if (!release)
+    pos = dhcpc_putOption(pos, DHCPC_OPT_PRL, DHCPC_LEASEPRL, sizeof(DHCPC_LEASEPRL));
+  *pos++ = DHCPC_OPT_END;
+
+  uint16_t bootpLen = pos - bootp;
+  if (bootpLen < DHCPC_BOOTPLEN)
+    bootpLen = DHCPC_BOOTPLEN;
+  uint16_t frameLen = bootpPos + bootpLen;
+
+  byte* ip = frame + ipPos;
+  ip[0] = 0x45;
+  dhcpc_put16(ip + 2, frameLen - ipPos);
+  ip[8] = 64;  // TTL
+  ip[9] = 17;  // UDP
+  if (release) {
+    memcpy(ip + 12, context->ip, IP_LEN);
+    memcpy(ip + 16, context->server, IP_LEN);
+  } else
+    memset(ip + 16, 0xff, IP_LEN);
+  dhcpc_put16(ip + 10, dhcpc_ipChecksum(ip, 20));
+
+  // UDP checksum 0: not calculated
+  byte* udp = frame + udpPos;
+  dhcpc_put16(udp, DHCPC_CLIENT_PORT);
+  dhcpc_put16(udp + 2, DHCPC_SERVER_PORT);
+  dhcpc_put16(udp + 4, frameLen - udpPos);
+
+  bool wastagged = false;
+  if (ENC28J60::is_VLAN_tagging_enabled()) {
+    ENC28J60::disable_VLAN_tagging();
+    wastagged = true;
+  }
+  ether.packetSend(frameLen);
+  if (wastagged)
+    ENC28J60::enable_VLAN_tagging(voiceVLAN);
+}  // void dhcpc_send()
+
+// Own MAC address and the host name sent with the DISCOVERs and REQUESTs of a lease
+void dhcpc_init(const byte mac[], const char* hostname) {
+  memcpy(dhcpc_mac, mac, ETH_LEN);
+  dhcpc_hostname = hostname;
+  dhcpc_reset();
+}
+
+static void dhcpc_start(uint8_t index, uint16_t vlan, unsigned long timeout, unsigned long now) {
+  DHCPC_CONTEXT* context = &dhcpc_contexts[index];
+  DHCP_DATA* options = context->options;
+  memset(context, 0, sizeof(DHCPC_CONTEXT));
+  context->options = options;
+  context->probe = index >= DHCPC_LEASECONTEXTS;
+  context->vlan = vlan;
+  context->state = dhcpc_Selecting;
+  context->pending = true;
+  context->started = now;
+  context->timeout = timeout;
+  dhcpc_newTransaction(index);
+}
+
+// Start a lease in the VLAN, 0 for untagged. The options of the ACK are stored in options, which is
+// cleared now. A running lease of the context is dropped without RELEASE.
+bool dhcpc_lease(uint8_t context, uint16_t vlan, DHCP_DATA* options, unsigned long timeout, unsigned long now) {
+  if ((context >= DHCPC_LEASECONTEXTS) || (options == NULL))
+    return false;
+  dhcp_reset(options);
+  dhcpc_contexts[context].options = options;
+  dhcpc_start(context, vlan, timeout, now);
+  return true;
+}
+
+// Send a DISCOVER to the VLAN from a free probe context. Returns the context or -1 if all are in use.
+int8_t dhcpc_probe(uint16_t vlan, unsigned long timeout, unsigned long now) {
+  for (uint8_t i = DHCPC_LEASECONTEXTS; i < DHCPC_CONTEXTS; i++) {
+    if (dhcpc_contexts[i].state == dhcpc_Idle) {
+      dhcpc_start(i, vlan, timeout, now);
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Give the address of a bound lease back, the stored options are kept
+void dhcpc_release(uint8_t context) {
+  if ((context < DHCPC_LEASECONTEXTS) && (dhcpc_contexts[context].state == dhcpc_Bound))
+    dhcpc_contexts[context].state = dhcpc_Releasing;
+}
+
+// Stop a context, late answers are ignored
+void dhcpc_stop(uint8_t context) {
+  if (context >= DHCPC_CONTEXTS)
+    return;
+  dhcpc_contexts[context].state = dhcpc_Idle;
+  dhcpc_contexts[context].pending = false;
+  dhcpc_newTransaction(context);
+}
+
+// Stop all contexts without RELEASE, used after a link change
+void dhcpc_reset() {
+  for (uint8_t i = 0; i < DHCPC_CONTEXTS; i++)
+    dhcpc_stop(i);
+}
+
+// Send the waiting messages, repeat the messages of the leases and renew them, end the contexts
+// without answer. Sends through the EtherCard buffer.
+void dhcpc_process(unsigned long now, uint16_t voiceVLAN) {
+  for (uint8_t i = 0; i < DHCPC_CONTEXTS; i++) {
+    DHCPC_CONTEXT* context = &dhcpc_contexts[i];
+    switch (context->state) {
+      case dhcpc_Selecting:
+      case dhcpc_Requesting:
+        if ((now - context->started) >= context->timeout) {
+          context->state = dhcpc_Failed;
+          context->pending = false;
+          break;
+        }
+        // A REQUEST without answer starts again with a DISCOVER
+        if (!context->probe && !context->pending && ((now - context->sent) >= DHCPC_RETRY)) {
+          context->state = dhcpc_Selecting;
+          context->pending = true;
+          dhcpc_newTransaction(i);
+        }
+        if (context->pending) {
+          dhcpc_send(context, (context->state == dhcpc_Selecting) ? DHCPC_DISCOVER : DHCPC_REQUEST, voiceVLAN);
+          context->pending = false;
+          context->sent = now;
+        }
+        break;
+
+      case dhcpc_Bound:
+        // Renew after half of the lease time, the lease ends if there is no answer until then
+        if ((context->leaseTime != DHCPC_INFINITELEASE) && ((now - context->bound) >= dhcpc_renewTime(context->leaseTime))) {
+          context->state = dhcpc_Requesting;
+          context->pending = true;
+          context->started = now;
+          context->timeout = dhcpc_renewTime(context->leaseTime);
+          dhcpc_newTransaction(i);
+        }
+        break;
+
+      case dhcpc_Releasing:
+        dhcpc_send(context, DHCPC_RELEASE, voiceVLAN);
+        context->state = dhcpc_Idle;
+        dhcpc_newTransaction(i);
+        break;
+
+      default:
+        break;
+    }
+  }
+}  // void dhcpc_process()
+
+// Check if a received DHCP frame is an answer to one of the contexts and process it.
+// Returns true if the frame belongs to the client.
+bool dhcpc_receive(const byte frame[], uint16_t plen, const FRAME_INFO* info, unsigned long now) {
+  if (info->type != frame_DHCP)
+    return false;
+
+  const byte* ip = frame + info->headerLen;
+  uint16_t udpPos = info->headerLen + (ip[0] & 0x0f) * 4;
+  uint16_t bootpPos = udpPos + 8;
+  if (((bootpPos + DHCPC_BOOTP_COOKIE + 4) > plen) || (dhcpc_get16(frame + udpPos + 2) != DHCPC_CLIENT_PORT))
+    return false;
+
+  const byte* bootp = frame + bootpPos;
+  uint32_t xid = dhcpc_get32(bootp + DHCPC_BOOTP_XID);
+  if (((xid & DHCPC_XIDPREFIXMASK) != DHCPC_XIDPREFIX) || (bootp[DHCPC_BOOTP_OP] != 2))
+    return false;
+
+  // Answers to an older transaction, in another VLAN or to another client are ignored
+  uint8_t index = (xid >> 16) & 0xff;
+  if (index >= DHCPC_CONTEXTS)
+    return true;
+  DHCPC_CONTEXT* context = &dhcpc_contexts[index];
+  if ((xid != context->xid) || (info->vlanID != context->vlan) || (memcmp(bootp + DHCPC_BOOTP_CHADDR, dhcpc_mac, ETH_LEN) != 0)
+      || (dhcpc_get32(bootp + DHCPC_BOOTP_COOKIE) != DHCPC_COOKIE))
+    return true;
+
+  uint8_t msgType = 0;
+  const byte* mask = NULL;
+  const byte* router = NULL;
+  const byte* dns = NULL;
+  const byte* server = NULL;
+  uint32_t leaseTime = DHCPC_DEFAULTLEASE;
+  uint16_t optionsPos = bootpPos + DHCPC_BOOTP_COOKIE + 4;
+  for (uint16_t pos = optionsPos; pos < plen;) {
+    byte option = frame[pos++];
+    if (option == DHCPC_OPT_PAD)
+      continue;
+    if ((option == DHCPC_OPT_END) || (pos >= plen))
+      break;
+    byte len = frame[pos++];
+    if ((pos + len) > plen)
+      break;
+    if ((option == DHCPC_OPT_MSGTYPE) && (len == 1))
+      msgType = frame[pos];
+    else if ((option == DHCPC_OPT_MASK) && (len == IP_LEN))
+      mask = frame + pos;
+    else if ((option == DHCPC_OPT_ROUTER) && (len >= IP_LEN))
+      router = frame + pos;
+    else if ((option == DHCPC_OPT_DNS) && (len >= IP_LEN))
+      dns = frame + pos;
+    else if ((option == DHCPC_OPT_SERVER) && (len == IP_LEN))
+      server = frame + pos;
+    else if ((option == DHCPC_OPT_LEASETIME) && (len == 4))
+      leaseTime = dhcpc_get32(frame + pos);
+    pos += len;
+  }
+
+  // The REQUEST of a lease needs the server identifier
+  if ((context->state == dhcpc_Selecting) && (msgType == DHCPC_OFFER) && (context->probe || (server != NULL))) {
+    memcpy(context->ip, bootp + DHCPC_BOOTP_YIADDR, IP_LEN);
+    if (server != NULL)
+      memcpy(context->server, server, IP_LEN);
+    if (mask != NULL)
+      memcpy(context->mask, mask, IP_LEN);
+    if (router != NULL)
+      memcpy(context->gateway, router, IP_LEN);
+    context->offered = now;
+    if (context->probe)
+      context->state = dhcpc_Offered;
+    else {
+      context->state = dhcpc_Requesting;
+      context->pending = true;
+    }
+  } else if ((context->state == dhcpc_Requesting) && (msgType == DHCPC_ACK)) {
+    memcpy(context->ip, bootp + DHCPC_BOOTP_YIADDR, IP_LEN);
+    memcpy(context->serverMAC, frame + ETH_LEN, ETH_LEN);
+    if (server != NULL)
+      memcpy(context->server, server, IP_LEN);
+    memset(context->mask, 0, IP_LEN);
+    memset(context->gateway, 0, IP_LEN);
+    memset(context->dns, 0, IP_LEN);
+    if (mask != NULL)
+      memcpy(context->mask, mask, IP_LEN);
+    if (router != NULL)
+      memcpy(context->gateway, router, IP_LEN);
+    if (dns != NULL)
+      memcpy(context->dns, dns, IP_LEN);
+    context->leaseTime = leaseTime;
+    context->bound = now;
+    context->state = dhcpc_Bound;
+
+    // Store the options of the ACK, the leased address as option 0, which is not used by DHCP
+    dhcp_reset(context->options);
+    dhcp_setOption(context->options, DHCP_OPT_IP, context->ip, IP_LEN);
+    for (uint16_t pos = optionsPos; pos < plen;) {
+      byte option = frame[pos++];
+      if (option == DHCPC_OPT_PAD)
+        continue;
+      if ((option == DHCPC_OPT_END) || (pos >= plen))
+        break;
+      byte len = frame[pos++];
+      if ((pos + len) > plen)
+        break;
+      DHCPOption(context->options, option, frame + pos, len);
+      pos += len;
+    }
+  } else if ((context->state == dhcpc_Requesting) && (msgType == DHCPC_NAK)) {
+    // Start again with a DISCOVER
+    context->state = dhcpc_Selecting;
+    context->pending = true;
+    dhcpc_newTransaction(index);
+  }
+  return true;
+}  // bool dhcpc_receive()
+
+eDhcpcState dhcpc_state(uint8_t context) {
+  if (context >= DHCPC_CONTEXTS)
+    return dhcpc_Idle;
+  return (eDhcpcState)dhcpc_contexts[context].state;
+}
+
+const DHCPC_CONTEXT* dhcpc_getContext(uint8_t context) {
+  if (context >= DHCPC_CONTEXTS)
+    return NULL;
+  return &dhcpc_contexts[context];
+}
@@ -0,0 +1,76 @@
+/*
+dhcp_client.h
+
+DHCP client with independent contexts. Every context has its own transaction ID, state, option
+store and timers, so the untagged lease, the lease in the voice VLAN and the DISCOVERs of the
+VLAN sweep run at the same time. A context with a VLAN ID sends and receives tagged frames.
+
+2023-12-18: Initial version
+*/
+
+#include <EtherCard.h>
+#include <Arduino.h>
+#include "frame_functions.h"
+#include "DHCPOptions.h"
+
+#ifndef DHCP_CLIENT_H
+#define DHCP_CLIENT_H
+
+// Contexts holding a lease, the same as the option stores in eth_dhcpInfo
+static const uint8_t DHCPC_UNTAGGED = 0;
+static const uint8_t DHCPC_VOICE = 1;
+static const uint8_t DHCPC_LEASECONTEXTS = DHCP_CONTEXTS;
+
+// Contexts which only send a DISCOVER and wait for the OFFER, used by the VLAN sweep
+static const uint8_t DHCPC_PROBECONTEXTS = 64;
+static const uint8_t DHCPC_CONTEXTS = DHCPC_LEASECONTEXTS + DHCPC_PROBECONTEXTS;
+
+// Time in ms between the retries of a DISCOVER or REQUEST of a lease
+static const uint16_t DHCPC_RETRY = 4000;
+
+// State of a context
+enum eDhcpcState {
+  dhcpc_Idle = 0,
+  dhcpc_Selecting,   // DISCOVER sent, waiting for an OFFER
+  dhcpc_Requesting,  // REQUEST sent, waiting for the ACK
+  dhcpc_Bound,       // Lease received
+  dhcpc_Offered,     // OFFER of a probe received
+  dhcpc_Releasing,   // RELEASE waiting to be sent
+  dhcpc_Failed       // No answer before the timeout
+};
+
+// One DHCP client context
+struct DHCPC_CONTEXT {
+  uint8_t state;            // eDhcpcState
+  bool probe;               // Only DISCOVER, the offered address is not requested
+  bool pending;             // DISCOVER or REQUEST waiting to be sent by dhcpc_process()
+  uint16_t vlan;            // 802.1Q VLAN ID, 0 for untagged frames
+  uint32_t xid;
+  DHCP_DATA* options;       // Options of the lease, NULL for probes
+  byte ip[IP_LEN];          // Offered or leased address
+  byte mask[IP_LEN];
+  byte gateway[IP_LEN];
+  byte dns[IP_LEN];
+  byte server[IP_LEN];      // Server identifier
+  byte serverMAC[ETH_LEN];  // Sender of the ACK, the server or a relay agent
+  uint32_t leaseTime;       // Lease time in s
+  unsigned long started;    // millis() when the context was started or the lease is renewed
+  unsigned long timeout;    // ms after started without lease or OFFER
+  unsigned long sent;       // millis() of the last DISCOVER or REQUEST
+  unsigned long offered;    // millis() of the OFFER
+  unsigned long bound;      // millis() of the ACK
+};
+
+void dhcpc_init(const byte mac[], const char* hostname);
+bool dhcpc_lease(uint8_t context, uint16_t vlan, DHCP_DATA* options, unsigned long timeout, unsigned long now);
+int8_t dhcpc_probe(uint16_t vlan, unsigned long timeout, unsigned long now);
+void dhcpc_release(uint8_t context);
+void dhcpc_stop(uint8_t context);
+void dhcpc_reset();
+void dhcpc_process(unsigned long now, uint16_t voiceVLAN);
+bool dhcpc_receive(const byte frame[], uint16_t plen, const FRAME_INFO* info, unsigned long now);
+
+eDhcpcState dhcpc_state(uint8_t context);
+const DHCPC_CONTEXT* dhcpc_getContext(uint8_t context);
+
+#endif
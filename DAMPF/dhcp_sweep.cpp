@@ -0,0 +1,209 @@
+/*
+dhcp_sweep.cpp
+
+Probe a list of VLAN IDs for DHCP servers.
+
+The DISCOVERs are pipelined: every VLAN gets a probe context of the DHCP client, so up to
+DHCPC_PROBECONTEXTS VLANs wait for their OFFER at the same time. New probes are started at the
+configured rate. The VLANs to probe are kept in a bitmap, a range and the VLANs seen in tagged
+frames are added the same way. The leases of the DHCP client are not touched.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "dhcp_sweep.h"
+#include "fmt_functions.h"
+
+// Bitmap of the VLAN IDs to probe
+static const uint16_t SWEEP_BITMAPLEN = (SWEEP_MAXVLAN + 8) / 8;
+
+// Probes started by one call of sweep_process(), so the loop is not blocked
+static const uint8_t SWEEP_MAXBURST = 4;
+
+static byte sweep_vlans[SWEEP_BITMAPLEN];
+static uint16_t sweep_vlanCount = 0;
+static SWEEP_RESULT sweep_results[SWEEP_MAXRESULTS];
+static uint8_t sweep_results_count = 0;
+
+static eSweepState sweep_current = sweep_Idle;
+static int16_t sweep_nextVLAN;
+static uint16_t sweep_sent;
+static uint16_t sweep_count;
+static uint16_t sweep_foundVLANs;
+static uint16_t sweep_rate;
+static unsigned long sweep_startMillis;
+
+// Next VLAN of the list after vlan, -1 after the last one
+static int16_t sweep_next(int16_t vlan) {
+  for (uint16_t next = vlan + 1; next <= SWEEP_MAXVLAN; next++) {
+    if ((sweep_vlans[next >> 3] & (1 << (next & 0x07))) != 0)
+      return next;
+  }
+  return -1;
+}
+
+// Remove all VLANs from the list of a following sweep
+void sweep_clearVLANs() {
+  memset(sweep_vlans, 0, sizeof(sweep_vlans));
+  sweep_vlanCount = 0;
+}
+
+// Add the VLANs firstVLAN to lastVLAN to the list of a following sweep
+bool sweep_addVLANs(uint16_t firstVLAN, uint16_t lastVLAN) {
+  if ((firstVLAN == 0) || (firstVLAN > lastVLAN) || (lastVLAN > SWEEP_MAXVLAN))
+    return false;
+  for (uint16_t vlan = firstVLAN; vlan <= lastVLAN; vlan++) {
+    byte mask = 1 << (vlan & 0x07);
+    if ((sweep_vlans[vlan >> 3] & mask) == 0) {
+      sweep_vlans[vlan >> 3] |= mask;
+      sweep_vlanCount++;
+    }
+  }
+  return true;
+}
+
+// Start a sweep of the listed VLANs with rate DISCOVERs per second.
+// The results of the last sweep are removed.
+bool sweep_start(uint16_t rate, unsigned long now) {
+  if ((sweep_vlanCount == 0) || (rate == 0))
+    return false;
+
+  sweep_stop();
+  sweep_results_count = 0;
+  sweep_nextVLAN = sweep_next(0);
+  sweep_count = sweep_vlanCount;
+  sweep_sent = 0;
+  sweep_foundVLANs = 0;
+  sweep_rate = rate;
+  sweep_startMillis = now;
+  sweep_current = sweep_Running;
+  return true;
+}
+
+// Stop the probes, late OFFERs are ignored
+void sweep_stop() {
+  if (sweep_current == sweep_Running)
+    sweep_current = sweep_Done;
+  for (uint8_t i = DHCPC_LEASECONTEXTS; i < DHCPC_CONTEXTS; i++)
+    dhcpc_stop(i);
+}
+
+// Store the result of a VLAN, sorted by VLAN ID
+static void sweep_storeResult(const SWEEP_RESULT* result) {
+  uint8_t index = 0;
+  while ((index < sweep_results_count) && (sweep_results[index].vlan < result->vlan))
+    index++;
+  if ((index < sweep_results_count) && (sweep_results[index].vlan == result->vlan)) {
+    // A second server in the same VLAN, keep the first one
+    return;
+  }
+  sweep_foundVLANs++;
+  if (sweep_results_count == SWEEP_MAXRESULTS)
+    return;
+  memmove(&sweep_results[index + 1], &sweep_results[index], (sweep_results_count - index) * sizeof(SWEEP_RESULT));
+  sweep_results[index] = *result;
+  sweep_results_count++;
+}
+
+// Collect the OFFERs, free the probes without answer and start the next probes.
+// Called before dhcpc_process(), which sends the DISCOVERs. Returns true once when the sweep has finished.
+bool sweep_process(unsigned long now) {
+  if (sweep_current != sweep_Running)
+    return false;
+
+  bool waiting = false;
+  for (uint8_t i = DHCPC_LEASECONTEXTS; i < DHCPC_CONTEXTS; i++) {
+    const DHCPC_CONTEXT* context = dhcpc_getContext(i);
+    if (context->state == dhcpc_Offered) {
+      SWEEP_RESULT result;
+      result.vlan = context->vlan;
+      result.delay = context->offered - context->sent;
+      memcpy(result.ip, context->ip, IP_LEN);
+      memcpy(result.mask, context->mask, IP_LEN);
+      memcpy(result.gateway, context->gateway, IP_LEN);
+      memcpy(result.server, context->server, IP_LEN);
+      sweep_storeResult(&result);
+      dhcpc_stop(i);
+    } else if (context->state == dhcpc_Failed)
+      dhcpc_stop(i);
+    else if (context->state == dhcpc_Selecting)
+      waiting = true;
+  }
+
+  // Probes due at the configured rate
+  unsigned long due = ((now - sweep_startMillis) * sweep_rate) / 1000 + 1;
+  uint8_t burst = 0;
+  while ((sweep_nextVLAN > 0) && (sweep_sent < due) && (burst < SWEEP_MAXBURST)) {
+    if (dhcpc_probe(sweep_nextVLAN, SWEEP_TIMEOUT, now) < 0)
+      break;
+    sweep_nextVLAN = sweep_next(sweep_nextVLAN);
+    sweep_sent++;
+    burst++;
+    waiting = true;
+  }
+
+  if ((sweep_nextVLAN < 0) && !waiting) {
+    sweep_current = sweep_Done;
+    return true;
+  }
+  return false;
+}  // bool sweep_process()
+
+eSweepState sweep_state() {
+  return sweep_current;
+}
+
+// VLANs a DISCOVER has been sent to
+uint16_t sweep_probed() {
+  return sweep_sent;
+}
+
+uint16_t sweep_total() {
+  return sweep_count;
+}
+
+// VLANs with a DHCP server, including the ones which did not fit into the results
+uint16_t sweep_found() {
+  return sweep_foundVLANs;
+}
+
+uint8_t sweep_resultCount() {
+  return sweep_results_count;
+}
+
+const SWEEP_RESULT* sweep_getResult(uint8_t index) {
+  if (index >= sweep_results_count)
+    return NULL;
+  return &sweep_results[index];
+}
+
+// Print the subnet of a result as "subnet/prefix"
+size_t sweep_printSubnet(const SWEEP_RESULT* result, char* value, size_t size) {
+  byte subnet[IP_LEN];
+  uint8_t prefix = 0;
+  for (uint8_t i = 0; i < IP_LEN; i++) {
+    subnet[i] = result->ip[i] & result->mask[i];
+    for (byte bit = result->mask[i]; bit != 0; bit <<= 1)
+      prefix++;
+  }
+
+  size_t pos = fmt_ipv4(value, size, subnet);
+  pos += fmt_text(value + pos, size - pos, "/");
+  pos += fmt_uint(value + pos, size - pos, prefix);
+  return pos;
+}
+
+// Print a result as "subnet/prefix GW gateway DHCP server delay"
+size_t sweep_printResult(const SWEEP_RESULT* result, char* value, size_t size) {
+  size_t pos = sweep_printSubnet(result, value, size);
+  pos += fmt_text(value + pos, size - pos, " GW ");
+  pos += fmt_ipv4(value + pos, size - pos, result->gateway);
+  pos += fmt_text(value + pos, size - pos, " DHCP ");
+  pos += fmt_ipv4(value + pos, size - pos, result->server);
+  pos += fmt_text(value + pos, size - pos, " ");
+  pos += fmt_uint(value + pos, size - pos, result->delay);
+  pos += fmt_text(value + pos, size - pos, "ms");
+  return pos;
+}  // size_t sweep_printResult()
@@ -0,0 +1,63 @@
+/*
+dhcp_sweep.h
+
+Probe a list of VLAN IDs for DHCP servers. A probe context of the DHCP client sends a tagged
+DISCOVER for each VLAN and the OFFERs are collected into a VLAN -> subnet / gateway map. No lease
+is requested, the offered addresses are not used.
+
+2023-12-18: Initial version
+*/
+
+#include <EtherCard.h>
+#include <Arduino.h>
+#include "dhcp_client.h"
+
+#ifndef DHCP_SWEEP_H
+#define DHCP_SWEEP_H
+
+// Number of VLANs with a DHCP server which are stored, more are counted only
+static const uint8_t SWEEP_MAXRESULTS = 64;
+
+// Highest VLAN ID, 4095 is reserved
+static const uint16_t SWEEP_MAXVLAN = 4094;
+
+// Time in ms a probe waits for the OFFER, so the rate is limited to DHCPC_PROBECONTEXTS per
+// SWEEP_TIMEOUT
+static const uint16_t SWEEP_TIMEOUT = 250;
+
+// Maximum length of a result printed by sweep_printResult() including the terminating zero
+static const uint8_t SWEEP_RESULTLEN = 80;
+
+// State of the sweep
+enum eSweepState {
+  sweep_Idle = 0,
+  sweep_Running,
+  sweep_Done
+};
+
+// OFFER received in a VLAN
+struct SWEEP_RESULT {
+  uint16_t vlan;
+  uint16_t delay;  // ms from DISCOVER to OFFER
+  byte ip[IP_LEN];
+  byte mask[IP_LEN];
+  byte gateway[IP_LEN];
+  byte server[IP_LEN];
+};
+
+void sweep_clearVLANs();
+bool sweep_addVLANs(uint16_t firstVLAN, uint16_t lastVLAN);
+bool sweep_start(uint16_t rate, unsigned long now);
+void sweep_stop();
+bool sweep_process(unsigned long now);
+
+eSweepState sweep_state();
+uint16_t sweep_probed();
+uint16_t sweep_total();
+uint16_t sweep_found();
+uint8_t sweep_resultCount();
+const SWEEP_RESULT* sweep_getResult(uint8_t index);
+size_t sweep_printSubnet(const SWEEP_RESULT* result, char* value, size_t size);
+size_t sweep_printResult(const SWEEP_RESULT* result, char* value, size_t size);
+
+#endif
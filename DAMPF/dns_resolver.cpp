@@ -0,0 +1,352 @@
+/*
+dns_resolver.cpp
+
+Non-blocking DNS resolver for IPv4 addresses.
+
+dns_query() only stores the name, dns_process() sends the queries of all names without
+waiting and repeats them after DNS_TIMEOUT. The answers are matched by dns_receive() with
+the query ID, so the loop keeps receiving frames and handling buttons while the names
+are resolved.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "dns_resolver.h"
+
+// UDP ports
+static const uint16_t DNS_SERVER_PORT = 53;
+static const uint16_t DNS_CLIENT_PORT = 0xda53;
+
+// DNS header, query type and class
+static const uint8_t DNS_HEADERLEN = 12;
+static const uint16_t DNS_FLAG_QR = 0x8000;
+static const uint16_t DNS_FLAG_RD = 0x0100;
+static const uint16_t DNS_RCODE_MASK = 0x000f;
+static const uint16_t DNS_TYPE_A = 1;
+static const uint16_t DNS_CLASS_IN = 1;
+
+// Maximum length of a query: header, name with the length of the first label and the
+// terminating zero, type and class. EtherCard::sendUdp() sends up to 255 bytes.
+static const uint16_t DNS_QUERYLEN = DNS_HEADERLEN + DNS_NAMELEN + 1 + 4;
+static_assert(DNS_QUERYLEN <= 255, "DNS query too long for EtherCard::sendUdp()");
+
+// Queries sent by one call of dns_process(), so the loop is not blocked
+static const uint8_t DNS_MAXBURST = 4;
+
+static DNS_QUERY dns_queries[DNS_MAXQUERIES];
+static DNS_CACHEENTRY dns_cache[DNS_CACHESIZE];
+static uint16_t dns_nextID = 0;
+static bool dns_busy = false;
+
+static inline uint16_t dns_get16(const byte a[]) {
+  return (a[0] << 8) | a[1];
+}
+
+static inline uint32_t dns_get32(const byte a[]) {
+  return ((uint32_t)a[0] << 24) | ((uint32_t)a[1] << 16) | (a[2] << 8) | a[3];
+}
+
+static inline void dns_put16(byte a[], uint16_t value) {
+  a[0] = value >> 8;
+  a[1] = value & 0xff;
+}
+
+static bool dns_isActive(const DNS_QUERY* query) {
+  return (query->state == dns_Waiting) || (query->state == dns_Sent);
+}
+
+static DNS_CACHEENTRY* dns_findCache(const char* name, unsigned long now) {
+  for (uint8_t i = 0; i < DNS_CACHESIZE; i++) {
+    DNS_CACHEENTRY* entry = &dns_cache[i];
+    if (!entry->used)
+      continue;
+    if ((long)(now - entry->expires) >= 0) {
+      entry->used = false;
+      continue;
+    }
+    if (strcasecmp(entry->name, name) == 0)
+      return entry;
+  }
+  return NULL;
+}
+
+// Store the result of a query, a free entry or the entry expiring first is used
+static void dns_storeCache(const DNS_QUERY* query, uint32_t ttl, unsigned long now) {
+  DNS_CACHEENTRY* entry = NULL;
+  for (uint8_t i = 0; i < DNS_CACHESIZE; i++) {
+    DNS_CACHEENTRY* candidate = &dns_cache[i];
+    if (candidate->used && (strcasecmp(candidate->name, query->name) == 0)) {
+      entry = candidate;
+      break;
+    }
+    if ((entry == NULL) || (!candidate->used && entry->used)
+        || (candidate->used && entry->used && ((long)(candidate->expires - entry->expires) < 0)))
+      entry = candidate;
+  }
+
+  if (ttl < DNS_MINCACHETIME)
+    ttl = DNS_MINCACHETIME;
+  if (ttl > DNS_MAXCACHETIME)
+    ttl = DNS_MAXCACHETIME;
+
+  entry->used = true;
+  entry->resolved = (query->state == dns_Resolved);
+  entry->expires = now + (entry->resolved ? ttl : DNS_FAILCACHETIME) * 1000UL;
+  memcpy(entry->ip, query->ip, IP_LEN);
+  strcpy(entry->name, query->name);
+}
+
+// Encode the name as labels, returns the length or 0 if a label is empty or too long
+static uint16_t dns_encodeName(const char* name, byte* buffer) {
+  uint16_t pos = 0;
+  while (*name != '\0') {
+    const char* dot = strchr(name, '.');
+    uint16_t len = (dot != NULL) ? (dot - name) : strlen(name);
+    if ((len == 0) || (len > 63))
+      return 0;
+    buffer[pos++] = len;
+    memcpy(buffer + pos, name, len);
+    pos += len;
+    name += len;
+    if (*name == '.')
+      name++;
+  }
+  buffer[pos++] = 0;
+  return pos;
+}
+
+static bool dns_send(DNS_QUERY* query, const byte dnsIP[]) {
+  byte packet[DNS_QUERYLEN];
+  memset(packet, 0, DNS_HEADERLEN);
+  dns_put16(packet, query->id);
+  dns_put16(packet + 2, DNS_FLAG_RD);
+  dns_put16(packet + 4, 1);  // One question
+
+  uint16_t len = dns_encodeName(query->name, packet + DNS_HEADERLEN);
+  if (len == 0)
+    return false;
+  len += DNS_HEADERLEN;
+  dns_put16(packet + len, DNS_TYPE_A);
+  dns_put16(packet + len + 2, DNS_CLASS_IN);
+  len += 4;
+
+  ether.sendUdp((const char*)packet, len, DNS_CLIENT_PORT, dnsIP, DNS_SERVER_PORT);
+  return true;
+}
+
+// Skip a name in a DNS message, returns the position after it or 0 if it is malformed
+static uint16_t dns_skipName(const byte msg[], uint16_t len, uint16_t pos) {
+  while (pos < len) {
+    byte label = msg[pos];
+    if (label == 0)
+      return pos + 1;
+    // Compressed: two byte pointer, the name ends here
+    if ((label & 0xc0) == 0xc0)
+      return ((pos + 2) <= len) ? (pos + 2) : 0;
+    if ((label & 0xc0) != 0)
+      return 0;
+    pos += label + 1;
+  }
+  return 0;
+}
+
+// Finish a query and store its result in the cache
+static void dns_finish(DNS_QUERY* query, eDnsState state, uint32_t ttl, unsigned long now) {
+  query->state = state;
+  dns_storeCache(query, ttl, now);
+}
+
+// Remove all queries and the cache, used after link-up
+void dns_reset() {
+  dns_cancel();
+  memset(dns_cache, 0, sizeof(dns_cache));
+  dns_nextID = (uint16_t)micros();
+}
+
+// Remove all queries, late answers are ignored
+void dns_cancel() {
+  memset(dns_queries, 0, sizeof(dns_queries));
+  dns_busy = false;
+}
+
+// Start resolving a name, returns the handle of the query or -1 if no query is free.
+// A name which is already queried or cached is not sent again.
+int8_t dns_query(const char* name, unsigned long now) {
+  size_t len = strlen(name);
+  if ((len == 0) || (len >= DNS_NAMELEN))
+    return -1;
+
+  int8_t handle = -1;
+  for (uint8_t i = 0; i < DNS_MAXQUERIES; i++) {
+    if (dns_queries[i].state == dns_Free) {
+      if (handle < 0)
+        handle = i;
+    } else if (strcasecmp(dns_queries[i].name, name) == 0)
+      return i;
+  }
+  if (handle < 0)
+    return -1;
+
+  DNS_QUERY* query = &dns_queries[handle];
+  memset(query, 0, sizeof(DNS_QUERY));
+  memcpy(query->name, name, len + 1);
+
+  const DNS_CACHEENTRY* entry = dns_findCache(name, now);
+  if (entry != NULL) {
+    query->state = entry->resolved ? dns_Resolved : dns_Failed;
+    memcpy(query->ip, entry->ip, IP_LEN);
+    return handle;
+  }
+
+  query->state = dns_Waiting;
+  query->id = dns_nextID++;
+  query->started = now;
+  dns_busy = true;
+  return handle;
+}
+
+// Send waiting queries and handle timeouts. Nothing is sent while canSend is false, e.g. while
+// the MAC address of the DNS server or gateway is unknown; the time still counts as an attempt.
+// Returns true when the last pending query has finished.
+bool dns_process(const byte dnsIP[], bool canSend, unsigned long now) {
+  if (!dns_busy)
+    return false;
+
+  bool noServer = (dnsIP[0] == 0);
+  uint8_t burst = 0;
+  bool pending = false;
+  for (uint8_t i = 0; i < DNS_MAXQUERIES; i++) {
+    DNS_QUERY* query = &dns_queries[i];
+    if (!dns_isActive(query))
+      continue;
+
+    if (noServer) {
+      dns_finish(query, dns_Failed, 0, now);
+      continue;
+    }
+
+    if ((now - query->started) >= DNS_TIMEOUT) {
+      if (++query->attempts >= DNS_ATTEMPTS) {
+        dns_finish(query, dns_Failed, 0, now);
+#ifdef DEBUGSERIAL
+        Serial.printf("dns_process(): %s timed out\n", query->name);
+#endif
+        continue;
+      }
+      query->state = dns_Waiting;
+      query->started = now;
+    }
+
+    if ((query->state == dns_Waiting) && canSend && (burst < DNS_MAXBURST)) {
+      if (!dns_send(query, dnsIP)) {
+        dns_finish(query, dns_Failed, 0, now);
+        continue;
+      }
+      query->state = dns_Sent;
+      query->started = now;
+      burst++;
+    }
+    pending = true;
+  }
+
+  if (pending)
+    return false;
+  dns_busy = false;
+  return true;
+}  // bool dns_process()
+
+// Match an answer to its query, returns true if the frame was a DNS answer for the resolver
+bool dns_receive(const byte frame[], uint16_t plen, const FRAME_INFO* info, unsigned long now) {
+  if (!dns_busy || (info->type != frame_DNS))
+    return false;
+
+  const byte* ip = frame + info->headerLen;
+  uint16_t ipHeaderLen = (ip[0] & 0x0f) * 4;
+  uint16_t udpPos = info->headerLen + ipHeaderLen;
+  if (((udpPos + 8 + DNS_HEADERLEN) > plen) || (dns_get16(frame + udpPos + 2) != DNS_CLIENT_PORT))
+    return false;
+
+  // Limit the message to the UDP length, the frame may be padded
+  const byte* msg = frame + udpPos + 8;
+  uint16_t len = plen - udpPos - 8;
+  uint16_t udpLen = dns_get16(frame + udpPos + 4);
+  if ((udpLen >= 8) && ((udpLen - 8) < len))
+    len = udpLen - 8;
+
+  uint16_t id = dns_get16(msg);
+  uint16_t flags = dns_get16(msg + 2);
+  DNS_QUERY* query = NULL;
+  for (uint8_t i = 0; i < DNS_MAXQUERIES; i++) {
+    if ((dns_queries[i].state == dns_Sent) && (dns_queries[i].id == id)) {
+      query = &dns_queries[i];
+      break;
+    }
+  }
+  if ((query == NULL) || ((flags & DNS_FLAG_QR) == 0))
+    return true;
+
+  // Name error or server failure, the name is not asked again
+  if ((flags & DNS_RCODE_MASK) != 0) {
+    dns_finish(query, dns_Failed, 0, now);
+    return true;
+  }
+
+  uint16_t questions = dns_get16(msg + 4);
+  uint16_t answers = dns_get16(msg + 6);
+  uint16_t pos = DNS_HEADERLEN;
+  for (uint16_t i = 0; (i < questions) && (pos != 0); i++) {
+    pos = dns_skipName(msg, len, pos);
+    if (pos != 0)
+      pos = ((pos + 4) <= len) ? (pos + 4) : 0;
+  }
+
+  // The first address record is used, CNAME records before it are skipped
+  for (uint16_t i = 0; (i < answers) && (pos != 0); i++) {
+    pos = dns_skipName(msg, len, pos);
+    if ((pos == 0) || ((pos + 10) > len))
+      break;
+    uint16_t type = dns_get16(msg + pos);
+    uint16_t dataClass = dns_get16(msg + pos + 2);
+    uint32_t ttl = dns_get32(msg + pos + 4);
+    uint16_t dataLen = dns_get16(msg + pos + 8);
+    pos += 10;
+    if ((pos + dataLen) > len)
+      break;
+    if ((type == DNS_TYPE_A) && (dataClass == DNS_CLASS_IN) && (dataLen == IP_LEN)) {
+      memcpy(query->ip, msg + pos, IP_LEN);
+      dns_finish(query, dns_Resolved, ttl, now);
+      return true;
+    }
+    pos += dataLen;
+  }
+
+  // Answer without address
+  dns_finish(query, dns_Failed, 0, now);
+  return true;
+}  // bool dns_receive()
+
+// Names are queried or waiting to be sent again
+bool dns_pending() {
+  return dns_busy;
+}
+
+eDnsState dns_state(int8_t handle) {
+  if ((handle < 0) || (handle >= DNS_MAXQUERIES))
+    return dns_Free;
+  return (eDnsState)dns_queries[handle].state;
+}
+
+const char* dns_getName(int8_t handle) {
+  if ((handle < 0) || (handle >= DNS_MAXQUERIES))
+    return "";
+  return dns_queries[handle].name;
+}
+
+// Resolved address, NULL if the name is not resolved
+const byte* dns_getIP(int8_t handle) {
+  if (dns_state(handle) != dns_Resolved)
+    return NULL;
+  return dns_queries[handle].ip;
+}
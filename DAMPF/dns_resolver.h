@@ -0,0 +1,73 @@
+/*
+dns_resolver.h
+
+Non-blocking DNS resolver for IPv4 addresses. All names are queried at the same time with
+their own query ID, the answers are matched in the receive path. Results are cached.
+
+2023-12-18: Initial version
+*/
+
+#include <EtherCard.h>
+#include <Arduino.h>
+#include "frame_functions.h"
+
+#ifndef DNS_RESOLVER_H
+#define DNS_RESOLVER_H
+
+// Names resolved at the same time, the DNS domain and the search list fill up to ETH_NTPMAXSOURCES
+static const uint8_t DNS_MAXQUERIES = 10;
+
+// Maximum length of a name including the terminating zero
+static const uint8_t DNS_NAMELEN = 128;
+
+// Time in ms to wait for an answer and number of queries sent per name
+static const uint16_t DNS_TIMEOUT = 1000;
+static const uint8_t DNS_ATTEMPTS = 3;
+
+// Cached names, their time in s is limited to DNS_MINCACHETIME .. DNS_MAXCACHETIME.
+// Names which could not be resolved are cached for DNS_FAILCACHETIME.
+static const uint8_t DNS_CACHESIZE = 8;
+static const uint32_t DNS_MINCACHETIME = 30;
+static const uint32_t DNS_MAXCACHETIME = 3600;
+static const uint32_t DNS_FAILCACHETIME = 60;
+
+// State of a query
+enum eDnsState {
+  dns_Free = 0,
+  dns_Waiting,   // Not sent yet or to be sent again
+  dns_Sent,      // Waiting for the answer
+  dns_Resolved,
+  dns_Failed
+};
+
+// Name to be resolved
+struct DNS_QUERY {
+  uint8_t state;          // eDnsState
+  uint8_t attempts;       // Queries sent or timed out
+  uint16_t id;
+  unsigned long started;  // millis() when the current attempt was started
+  byte ip[IP_LEN];
+  char name[DNS_NAMELEN];
+};
+
+// Answer stored in the cache
+struct DNS_CACHEENTRY {
+  bool used;
+  bool resolved;          // false if the name could not be resolved
+  unsigned long expires;  // millis() when the entry is removed
+  byte ip[IP_LEN];
+  char name[DNS_NAMELEN];
+};
+
+void dns_reset();
+void dns_cancel();
+int8_t dns_query(const char* name, unsigned long now);
+bool dns_process(const byte dnsIP[], bool canSend, unsigned long now);
+bool dns_receive(const byte frame[], uint16_t plen, const FRAME_INFO* info, unsigned long now);
+
+bool dns_pending();
+eDnsState dns_state(int8_t handle);
+const char* dns_getName(int8_t handle);
+const byte* dns_getIP(int8_t handle);
+
+#endif
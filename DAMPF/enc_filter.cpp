@@ -0,0 +1,168 @@
+/*
+enc_filter.cpp
+
+Configure the receive filters of the ENC28J60 and count the received frames per filter.
+
+EtherCard has no access to the hash table filter, so the registers are written directly over SPI.
+The caller has to hold the ENC28J60, see eth_lock(). EtherCard remembers the selected register
+bank, so the bank is restored after each access. Registers see the ENC28J60 data sheet (DS39662).
+
+This module owns ERXFCON. The DHCP client of EtherCard, which switches the broadcast filter in
+the same register, is not used, see dhcp_client.h.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include <SPI.h>
+#include "enc_filter.h"
+
+// SPI clock, the ENC28J60 supports up to 20 MHz
+static const uint32_t ENC_SPICLOCK = 8000000;
+
+// SPI instructions
+static const uint8_t ENC_OP_RCR = 0x00;  // Read control register
+static const uint8_t ENC_OP_WCR = 0x40;  // Write control register
+static const uint8_t ENC_OP_BFS = 0x80;  // Bit field set
+static const uint8_t ENC_OP_BFC = 0xa0;  // Bit field clear
+
+// Registers available in all banks
+static const uint8_t ENC_EIR = 0x1c;
+static const uint8_t ENC_ECON1 = 0x1f;
+static const uint8_t ENC_EIR_RXERIF = 0x01;
+static const uint8_t ENC_ECON1_BSEL = 0x03;
+
+// Bank 1 registers
+static const uint8_t ENC_BANK1 = 0x01;
+static const uint8_t ENC_EHT0 = 0x00;  // Hash table EHT0..EHT7
+static const uint8_t ENC_ERXFCON = 0x18;
+
+// ERXFCON bits, the filters are combined with OR
+static const uint8_t ENC_ERXFCON_UCEN = 0x80;  // Own unicast address
+static const uint8_t ENC_ERXFCON_CRCEN = 0x20;  // Discard frames with bad CRC
+static const uint8_t ENC_ERXFCON_HTEN = 0x04;  // Hash table
+static const uint8_t ENC_ERXFCON_BCEN = 0x01;  // Broadcast
+
+static const byte enc_broadcast[ETH_LEN] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+// Multicast addresses accepted by the hash table filter
+static const byte enc_multicast[][ETH_LEN] = {
+  { 0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e },  // LLDP nearest bridge
+  { 0x01, 0x80, 0xc2, 0x00, 0x00, 0x03 },  // LLDP nearest non-TPMR bridge
+  { 0x01, 0x00, 0x0c, 0xcc, 0xcc, 0xcc }   // CDP
+};
+static const uint8_t ENC_MULTICASTCOUNT = sizeof(enc_multicast) / sizeof(enc_multicast[0]);
+
+static eEncFilter enc_filter = enc_Filtered;
+static ENC_COUNTERS enc_counters;
+
+static uint8_t enc_op(uint8_t op, uint8_t address, uint8_t data) {
+  SPI.beginTransaction(SPISettings(ENC_SPICLOCK, MSBFIRST, SPI_MODE0));
+  digitalWrite(ETH_CS, LOW);
+  SPI.transfer(op | (address & 0x1f));
+  uint8_t result = SPI.transfer(data);
+  digitalWrite(ETH_CS, HIGH);
+  SPI.endTransaction();
+  return result;
+}
+
+// Bit of the hash table for a destination address: bits 28:23 of the Ethernet CRC
+static uint8_t enc_hashBit(const byte mac[]) {
+  uint32_t crc = 0xffffffffUL;
+  for (uint8_t i = 0; i < ETH_LEN; i++) {
+    byte value = mac[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      bool feedback = ((crc >> 31) ^ value) & 0x01;
+      crc <<= 1;
+      value >>= 1;
+      if (feedback)
+        crc ^= 0x04c11db7UL;
+    }
+  }
+  return (crc >> 23) & 0x3f;
+}
+
+// Select bank 1 and return the bank selected before
+static uint8_t enc_selectBank1() {
+  uint8_t bank = enc_op(ENC_OP_RCR, ENC_ECON1, 0) & ENC_ECON1_BSEL;
+  enc_op(ENC_OP_BFC, ENC_ECON1, ENC_ECON1_BSEL);
+  enc_op(ENC_OP_BFS, ENC_ECON1, ENC_BANK1);
+  return bank;
+}
+
+static void enc_restoreBank(uint8_t bank) {
+  enc_op(ENC_OP_BFC, ENC_ECON1, ENC_ECON1_BSEL);
+  if (bank != 0)
+    enc_op(ENC_OP_BFS, ENC_ECON1, bank);
+}
+
+// Write the filter registers in bank 1
+static void enc_writeFilter(const byte hashTable[], uint8_t rxfcon) {
+  uint8_t bank = enc_selectBank1();
+  for (uint8_t i = 0; i < 8; i++)
+    enc_op(ENC_OP_WCR, ENC_EHT0 + i, hashTable[i]);
+  enc_op(ENC_OP_WCR, ENC_ERXFCON, rxfcon);
+  enc_restoreBank(bank);
+}
+
+// Configure the receive filters, needed again after ether.begin()
+void enc_setFilter(eEncFilter filter) {
+  byte hashTable[8];
+  memset(hashTable, 0, sizeof(hashTable));
+  uint8_t rxfcon = ENC_ERXFCON_CRCEN;
+
+  // Broadcasts are always needed for ARP and DHCP in the filtered mode, with only the broadcast
+  // filter enabled nothing else would be received in the promiscuous mode. EtherCard keeps its own
+  // broadcast setting, which decides if it clears the broadcast filter after DHCP.
+  if (filter == enc_Filtered) {
+    ENC28J60::enableBroadcast();
+    for (uint8_t i = 0; i < ENC_MULTICASTCOUNT; i++) {
+      uint8_t hashBit = enc_hashBit(enc_multicast[i]);
+      hashTable[hashBit >> 3] |= 1 << (hashBit & 0x07);
+    }
+    rxfcon |= ENC_ERXFCON_UCEN | ENC_ERXFCON_HTEN | ENC_ERXFCON_BCEN;
+  } else
+    ENC28J60::disableBroadcast();
+
+  enc_writeFilter(hashTable, rxfcon);
+  enc_filter = filter;
+}  // void enc_setFilter()
+
+eEncFilter enc_getFilter() {
+  return enc_filter;
+}
+
+// Count a received frame by the filter that accepted it
+void enc_countFrame(const byte frame[], uint16_t plen) {
+  if (plen < ETH_LEN)
+    return;
+  if (memcmp(frame, EtherCard::mymac, ETH_LEN) == 0) {
+    enc_counters.unicast++;
+    return;
+  }
+  if (memcmp(frame, enc_broadcast, ETH_LEN) == 0) {
+    enc_counters.broadcast++;
+    return;
+  }
+  for (uint8_t i = 0; i < ENC_MULTICASTCOUNT; i++) {
+    if (memcmp(frame, enc_multicast[i], ETH_LEN) == 0) {
+      enc_counters.multicast++;
+      return;
+    }
+  }
+  enc_counters.other++;
+}
+
+// Count and clear a receive buffer overflow, returns true if frames were lost
+bool enc_checkOverflow() {
+  if ((enc_op(ENC_OP_RCR, ENC_EIR, 0) & ENC_EIR_RXERIF) == 0)
+    return false;
+  enc_op(ENC_OP_BFC, ENC_EIR, ENC_EIR_RXERIF);
+  enc_counters.overflows++;
+  return true;
+}
+
+const ENC_COUNTERS* enc_getCounters() {
+  return &enc_counters;
+}
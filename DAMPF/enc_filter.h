@@ -0,0 +1,36 @@
+/*
+enc_filter.h
+
+Configure the receive filters of the ENC28J60 and count the received frames per filter.
+
+2023-12-18: Initial version
+*/
+
+#include <EtherCard.h>
+#include <Arduino.h>
+
+#ifndef ENC_FILTER_H
+#define ENC_FILTER_H
+
+// Receive filter modes
+enum eEncFilter {
+  enc_Filtered = 0,   // Own unicast address, broadcasts and the LLDP / CDP multicast addresses
+  enc_Promiscuous     // All frames, e.g. for analysing a mirror port
+};
+
+// Received frames by destination address and receive errors of the ENC28J60
+struct ENC_COUNTERS {
+  uint32_t unicast;    // Own MAC address
+  uint32_t broadcast;
+  uint32_t multicast;  // LLDP and CDP multicast addresses
+  uint32_t other;      // Promiscuous mode or hash collisions of the multicast filter
+  uint32_t overflows;  // Receive buffer full, EIR.RXERIF
+};
+
+void enc_setFilter(eEncFilter filter);
+eEncFilter enc_getFilter();
+void enc_countFrame(const byte frame[], uint16_t plen);
+bool enc_checkOverflow();
+const ENC_COUNTERS* enc_getCounters();
+
+#endif
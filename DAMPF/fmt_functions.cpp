@@ -0,0 +1,160 @@
+/*
+fmt_functions.cpp
+
+Format addresses and numbers into caller provided buffers without heap allocation.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "fmt_functions.h"
+
+static const char FMT_HEXCHARS[] = "0123456789abcdef";
+
+// Append a single character if there is space left for it and the terminating '\0'
+static inline size_t fmt_char(char* buf, size_t size, size_t pos, char c) {
+  if ((pos + 1) >= size)
+    return pos;
+  buf[pos++] = c;
+  buf[pos] = '\0';
+  return pos;
+}
+
+// Copy a text
+size_t fmt_text(char* buf, size_t size, const char* text) {
+  if (size == 0)
+    return 0;
+  size_t pos = 0;
+  while ((text[pos] != '\0') && ((pos + 1) < size)) {
+    buf[pos] = text[pos];
+    pos++;
+  }
+  buf[pos] = '\0';
+  return pos;
+}
+
+// Decimal number without leading zeros
+size_t fmt_uint(char* buf, size_t size, uint32_t value) {
+  char digits[FMT_UINTLEN];
+  uint8_t count = 0;
+  do {
+    digits[count++] = '0' + (value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  if (size == 0)
+    return 0;
+  buf[0] = '\0';
+  size_t pos = 0;
+  while (count > 0)
+    pos = fmt_char(buf, size, pos, digits[--count]);
+  return pos;
+}
+
+// Hex number with a fixed number of digits, e.g. 8 digits for a 32 bit value
+size_t fmt_hexNumber(char* buf, size_t size, uint32_t value, uint8_t digits) {
+  if (size == 0)
+    return 0;
+  buf[0] = '\0';
+  size_t pos = 0;
+  while (digits > 0) {
+    digits--;
+    pos = fmt_char(buf, size, pos, FMT_HEXCHARS[(value >> (4 * digits)) & 0x0f]);
+  }
+  return pos;
+}
+
+// Binary data as hex string without separators
+size_t fmt_hex(char* buf, size_t size, const byte data[], uint16_t length) {
+  if (size == 0)
+    return 0;
+  if ((2 * (size_t)length) >= size)
+    length = (size - 1) / 2;
+  for (uint16_t i = 0; i < length; i++) {
+    buf[2 * i] = FMT_HEXCHARS[data[i] >> 4];
+    buf[2 * i + 1] = FMT_HEXCHARS[data[i] & 0x0f];
+  }
+  buf[2 * length] = '\0';
+  return 2 * length;
+}
+
+// MAC address, separator '\0' prints it without separators
+size_t fmt_mac(char* buf, size_t size, const byte mac[], char separator) {
+  if (separator == '\0')
+    return fmt_hex(buf, size, mac, ETH_LEN);
+
+  if (size == 0)
+    return 0;
+  buf[0] = '\0';
+  size_t pos = 0;
+  for (byte i = 0; i < ETH_LEN; i++) {
+    if (i > 0)
+      pos = fmt_char(buf, size, pos, separator);
+    pos = fmt_char(buf, size, pos, FMT_HEXCHARS[mac[i] >> 4]);
+    pos = fmt_char(buf, size, pos, FMT_HEXCHARS[mac[i] & 0x0f]);
+  }
+  return pos;
+}
+
+// IPv4 address in dotted decimal notation
+size_t fmt_ipv4(char* buf, size_t size, const byte ip[]) {
+  if (size == 0)
+    return 0;
+  buf[0] = '\0';
+  size_t pos = 0;
+  for (byte i = 0; i < IP_LEN; i++) {
+    if (i > 0)
+      pos = fmt_char(buf, size, pos, '.');
+    pos += fmt_uint(buf + pos, size - pos, ip[i]);
+  }
+  return pos;
+}
+
+// IPv6 address as recommended by RFC 5952: lower case, no leading zeros and
+// the longest run of at least two zero groups replaced by "::"
+size_t fmt_ipv6(char* buf, size_t size, const byte ip[]) {
+  uint16_t groups[8];
+  for (byte i = 0; i < 8; i++)
+    groups[i] = (ip[2 * i] << 8) | ip[2 * i + 1];
+
+  // Find the first longest run of zero groups
+  int8_t zeroStart = -1;
+  byte zeroLength = 0;
+  for (byte i = 0; i < 8;) {
+    if (groups[i] != 0) {
+      i++;
+      continue;
+    }
+    byte start = i;
+    while ((i < 8) && (groups[i] == 0))
+      i++;
+    if (((i - start) > zeroLength) && ((i - start) >= 2)) {
+      zeroStart = start;
+      zeroLength = i - start;
+    }
+  }
+
+  if (size == 0)
+    return 0;
+  buf[0] = '\0';
+  size_t pos = 0;
+  bool separator = false;
+  for (byte i = 0; i < 8; i++) {
+    if (i == zeroStart) {
+      pos = fmt_char(buf, size, pos, ':');
+      pos = fmt_char(buf, size, pos, ':');
+      i += zeroLength - 1;
+      separator = false;
+      continue;
+    }
+    if (separator)
+      pos = fmt_char(buf, size, pos, ':');
+    byte digits = 1;
+    while ((digits < 4) && ((groups[i] >> (4 * digits)) != 0))
+      digits++;
+    pos += fmt_hexNumber(buf + pos, size - pos, groups[i], digits);
+    separator = true;
+  }
+  return pos;
+}  // size_t fmt_ipv6()
@@ -0,0 +1,32 @@
+/*
+fmt_functions.h
+
+Format addresses and numbers into caller provided buffers without heap allocation.
+Like std::to_chars every function returns the number of characters written, so
+several values can be appended with buf + pos and size - pos. The result is always
+terminated with '\0' and cut at size - 1 characters.
+
+2023-12-18: Initial version
+*/
+
+#include <EtherCard.h>
+#include <Arduino.h>
+
+#ifndef FMT_FUNCTIONS_H
+#define FMT_FUNCTIONS_H
+
+// Buffer sizes including the terminating '\0'
+static const size_t FMT_UINTLEN = 11;  // "4294967295"
+static const size_t FMT_MACLEN = 18;   // "ca:fe:c0:ff:ee:00"
+static const size_t FMT_IPV4LEN = 16;  // "255.255.255.255"
+static const size_t FMT_IPV6LEN = 40;  // "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"
+
+size_t fmt_text(char* buf, size_t size, const char* text);
+size_t fmt_uint(char* buf, size_t size, uint32_t value);
+size_t fmt_hexNumber(char* buf, size_t size, uint32_t value, uint8_t digits);
+size_t fmt_hex(char* buf, size_t size, const byte data[], uint16_t length);
+size_t fmt_mac(char* buf, size_t size, const byte mac[], char separator);
+size_t fmt_ipv4(char* buf, size_t size, const byte ip[]);
+size_t fmt_ipv6(char* buf, size_t size, const byte ip[]);
+
+#endif
@@ -0,0 +1,180 @@
+/*
+frame_functions.cpp
+
+Classify received Ethernet frames once and route them to the matching decoder.
+Only integer compares are used, so rejecting the frames of other protocols in
+promiscuous mode is as cheap as possible.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "frame_functions.h"
+
+// Ethernet types
+static const uint16_t FRAME_TYPE_IPV4 = 0x0800;
+static const uint16_t FRAME_TYPE_ARP = 0x0806;
+static const uint16_t FRAME_TYPE_VLAN = 0x8100;
+static const uint16_t FRAME_TYPE_LLDP = 0x88cc;
+
+// Values up to 1500 in the Ethernet type field are the length of an IEEE 802.3 frame
+static const uint16_t FRAME_MAX_8023_LEN = 1500;
+
+// LLDP destination addresses 01:80:c2:00:00:0e, 01:80:c2:00:00:03 and 01:80:c2:00:00:00
+static const uint32_t FRAME_LLDP_MAC_HI = 0x0180c200;
+static const uint16_t FRAME_LLDP_MAC_LO[] = { 0x000e, 0x0003, 0x0000 };
+
+// CDP destination address 01:00:0c:cc:cc:cc
+static const uint32_t FRAME_CDP_MAC_HI = 0x01000ccc;
+static const uint16_t FRAME_CDP_MAC_LO = 0xcccc;
+
+// LLC/SNAP header of CDP: DSAP 0xaa, SSAP 0xaa, control 0x03, OUI 00:00:0c (Cisco), PID 0x2000
+static const uint32_t FRAME_CDP_SNAP_HI = 0xaaaa0300;
+static const uint32_t FRAME_CDP_SNAP_LO = 0x000c2000;
+
+// IPv4 / UDP values for DHCP, DNS and NTP
+static const uint8_t FRAME_IP_PROTO_UDP = 17;
+static const uint16_t FRAME_DHCP_SERVER_PORT = 67;
+static const uint16_t FRAME_DNS_SERVER_PORT = 53;
+static const uint16_t FRAME_NTP_SERVER_PORT = 123;
+
+// Frame types which can be decided by the Ethernet type alone
+struct FRAME_RULE {
+  uint16_t etherType;
+  eFrameType type;
+};
+
+static const FRAME_RULE frame_rules[] = {
+  { FRAME_TYPE_LLDP, frame_LLDP },
+  { FRAME_TYPE_IPV4, frame_DHCP },  // Only UDP from the DHCP, DNS or NTP server port, see below
+  { FRAME_TYPE_ARP, frame_ARP },
+};
+
+static inline uint16_t frame_get16(const byte a[]) {
+  return (a[0] << 8) | a[1];
+}
+
+static inline uint32_t frame_get32(const byte a[]) {
+  return ((uint32_t)a[0] << 24) | ((uint32_t)a[1] << 16) | (a[2] << 8) | a[3];
+}
+
+// Classify the frame by destination MAC, Ethernet type and LLC/SNAP header.
+// Tagged frames are recognized by the 802.1Q header and classified by the inner type.
+eFrameType frame_classify(const byte frame[], uint16_t plen, FRAME_INFO* info) {
+  info->type = frame_Other;
+  info->headerLen = FRAME_ETH_HEADER_LEN;
+  info->vlanID = 0;
+
+  if (plen < FRAME_ETH_HEADER_LEN)
+    return info->type;
+
+  uint32_t dstHi = frame_get32(frame);
+  uint16_t dstLo = frame_get16(frame + 4);
+  uint16_t etherType = frame_get16(frame + 12);
+
+  if (etherType == FRAME_TYPE_VLAN) {
+    if (plen < FRAME_VLAN_HEADER_LEN)
+      return info->type;
+    info->vlanID = frame_get16(frame + 14) & 0x0fff;
+    info->headerLen = FRAME_VLAN_HEADER_LEN;
+    etherType = frame_get16(frame + 16);
+  }
+
+  const byte* payload = frame + info->headerLen;
+  uint16_t payloadLen = plen - info->headerLen;
+
+  // IEEE 802.3 frame with LLC/SNAP header, only CDP is of interest
+  if (etherType <= FRAME_MAX_8023_LEN) {
+    if ((dstHi == FRAME_CDP_MAC_HI) && (dstLo == FRAME_CDP_MAC_LO) && (payloadLen >= 8)
+        && (frame_get32(payload) == FRAME_CDP_SNAP_HI) && (frame_get32(payload + 4) == FRAME_CDP_SNAP_LO))
+      info->type = frame_CDP;
+    return info->type;
+  }
+
+  eFrameType type = frame_Other;
+  for (byte i = 0; i < (sizeof(frame_rules) / sizeof(frame_rules[0])); i++) {
+    if (frame_rules[i].etherType == etherType) {
+      type = frame_rules[i].type;
+      break;
+    }
+  }
+
+  switch (type) {
+    case frame_LLDP:
+      {
+        if (dstHi != FRAME_LLDP_MAC_HI)
+          return info->type;
+        for (byte i = 0; i < (sizeof(FRAME_LLDP_MAC_LO) / sizeof(FRAME_LLDP_MAC_LO[0])); i++) {
+          if (dstLo == FRAME_LLDP_MAC_LO[i]) {
+            info->type = frame_LLDP;
+            break;
+          }
+        }
+        break;
+      }
+
+    case frame_DHCP:
+      {
+        // IPv4 header: version / header length, ..., protocol at offset 9
+        // UDP header: source port, destination port
+        if (payloadLen < 20)
+          return info->type;
+        uint16_t ipHeaderLen = (payload[0] & 0x0f) * 4;
+        if ((payload[9] != FRAME_IP_PROTO_UDP) || (payloadLen < (ipHeaderLen + 8)))
+          return info->type;
+        uint16_t srcPort = frame_get16(payload + ipHeaderLen);
+        if (srcPort == FRAME_DHCP_SERVER_PORT)
+          info->type = frame_DHCP;
+        else if (srcPort == FRAME_DNS_SERVER_PORT)
+          info->type = frame_DNS;
+        else if (srcPort == FRAME_NTP_SERVER_PORT)
+          info->type = frame_NTP;
+        break;
+      }
+
+    default:
+      {
+        info->type = type;
+        break;
+      }
+  }
+
+  return info->type;
+}  // eFrameType frame_classify()
+
+// Accepted and rejected frames per frame type
+static FRAME_COUNTERS frame_counters[FRAME_TYPECOUNT];
+
+// Count the result of a structural check, returns true if the frame is valid
+bool frame_count(eFrameType type, eFrameCheck check) {
+  if (type >= FRAME_TYPECOUNT)
+    return check == frame_Valid;
+
+  FRAME_COUNTERS* counters = &frame_counters[type];
+  switch (check) {
+    case frame_Valid:
+      counters->accepted++;
+      break;
+    case frame_Truncated:
+      counters->truncated++;
+      break;
+    case frame_Malformed:
+      counters->malformed++;
+      break;
+    case frame_BadChecksum:
+      counters->badChecksum++;
+      break;
+  }
+  return check == frame_Valid;
+}  // bool frame_count()
+
+const FRAME_COUNTERS* frame_getCounters(eFrameType type) {
+  if (type >= FRAME_TYPECOUNT)
+    return NULL;
+  return &frame_counters[type];
+}
+
+void frame_resetCounters() {
+  memset(frame_counters, 0, sizeof(frame_counters));
+}
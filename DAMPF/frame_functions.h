@@ -0,0 +1,59 @@
+/*
+frame_functions.h
+
+Classify received Ethernet frames once and route them to the matching decoder.
+
+2023-12-18: Initial version
+*/
+
+#include <EtherCard.h>
+#include <Arduino.h>
+
+#ifndef FRAME_FUNCTIONS_H
+#define FRAME_FUNCTIONS_H
+
+// Ethernet header without and with 802.1Q VLAN tag
+static const uint16_t FRAME_ETH_HEADER_LEN = 14;
+static const uint16_t FRAME_VLAN_HEADER_LEN = 18;
+
+// Types of received frames
+enum eFrameType {
+  frame_Other = 0,
+  frame_LLDP = 1,
+  frame_CDP = 2,
+  frame_DHCP = 3,
+  frame_ARP = 4,
+  frame_DNS = 5,
+  frame_NTP = 6
+};
+static const uint8_t FRAME_TYPECOUNT = 7;
+
+// Result of the structural checks of the LLDP and CDP decoders
+enum eFrameCheck {
+  frame_Valid = 0,
+  frame_Truncated = 1,    // The frame ends inside a TLV or before the length given in the header
+  frame_Malformed = 2,    // Wrong TLV length, order or missing mandatory TLV
+  frame_BadChecksum = 3
+};
+
+// Counters of the accepted and rejected frames per frame type
+struct FRAME_COUNTERS {
+  uint32_t accepted;
+  uint32_t truncated;
+  uint32_t malformed;
+  uint32_t badChecksum;
+};
+
+// Result of frame_classify()
+struct FRAME_INFO {
+  eFrameType type;
+  uint16_t headerLen;  // Length of the Ethernet header, including the VLAN tag
+  uint16_t vlanID;     // VLAN ID of a tagged frame, 0 if untagged
+};
+
+eFrameType frame_classify(const byte frame[], uint16_t plen, FRAME_INFO* info);
+bool frame_count(eFrameType type, eFrameCheck check);
+const FRAME_COUNTERS* frame_getCounters(eFrameType type);
+void frame_resetCounters();
+
+#endif
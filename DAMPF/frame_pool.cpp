@@ -0,0 +1,52 @@
+/*
+frame_pool.cpp
+
+Pool of reference-counted buffers for received Ethernet frames.
+
+The receive task allocates on one core and the loop releases on the other, so the reference
+counters are only changed with atomic operations. A buffer is taken by switching its counter
+from 0 to 1 and is free again when the last holder releases it.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "frame_pool.h"
+
+static FRAME_BUFFER pool_buffers[POOL_BUFFERS];
+
+// Free buffer with one reference, NULL if all buffers are in use
+FRAME_BUFFER* pool_alloc() {
+  for (uint8_t i = 0; i < POOL_BUFFERS; i++) {
+    uint8_t expected = 0;
+    if (__atomic_compare_exchange_n(&pool_buffers[i].refs, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      pool_buffers[i].length = 0;
+      pool_buffers[i].tagged = false;
+      return &pool_buffers[i];
+    }
+  }
+  return NULL;
+}
+
+// Additional holder of the buffer, e.g. a frame kept after decoding
+void pool_retain(FRAME_BUFFER* buffer) {
+  __atomic_add_fetch(&buffer->refs, 1, __ATOMIC_RELAXED);
+}
+
+// Drop one reference, the last one frees the buffer
+void pool_release(FRAME_BUFFER* buffer) {
+  if (buffer == NULL)
+    return;
+  __atomic_sub_fetch(&buffer->refs, 1, __ATOMIC_RELEASE);
+}
+
+// Buffers currently in use
+uint8_t pool_inUse() {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < POOL_BUFFERS; i++) {
+    if (__atomic_load_n(&pool_buffers[i].refs, __ATOMIC_RELAXED) != 0)
+      count++;
+  }
+  return count;
+}
@@ -0,0 +1,34 @@
+/*
+frame_pool.h
+
+Pool of reference-counted buffers for received Ethernet frames. The receive task fills a buffer,
+the frame ring hands it to the loop and the decoders read the frame in place.
+
+2023-12-18: Initial version
+*/
+
+#include <Arduino.h>
+
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+// Number of buffers, shared by the frames in the ring and the frame the loop decodes
+static const uint8_t POOL_BUFFERS = 8;
+
+// Maximum frame length with VLAN tag, the same as ETH_BUFFERSIZE
+static const uint16_t POOL_FRAMELEN = 1522;
+
+// One frame buffer
+struct FRAME_BUFFER {
+  uint8_t refs;       // Holders of the buffer, free if 0
+  bool tagged;        // Received with VLAN tag, see ENC28J60::packet_Received_Was_Tagged()
+  uint16_t length;
+  byte frame[POOL_FRAMELEN];
+};
+
+FRAME_BUFFER* pool_alloc();
+void pool_retain(FRAME_BUFFER* buffer);
+void pool_release(FRAME_BUFFER* buffer);
+uint8_t pool_inUse();
+
+#endif
@@ -0,0 +1,76 @@
+/*
+frame_ring.cpp
+
+Lock-free single-producer / single-consumer ring of received Ethernet frames.
+
+Only the producer writes ring_head and only the consumer writes ring_tail. The frame and its slot
+are written before the head is published with release order and read after the head is loaded
+with acquire order, so no lock is needed between the receive task and the loop on the other core.
+The ring only passes pointers, the frames stay in the buffers of the frame pool.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "frame_ring.h"
+
+static_assert((RING_SLOTS & (RING_SLOTS - 1)) == 0, "RING_SLOTS must be a power of two");
+static const uint8_t RING_MASK = RING_SLOTS - 1;
+
+static FRAME_BUFFER* ring_slots[RING_SLOTS];
+static RING_COUNTERS ring_counters;
+
+// Free running indices, the slot is index & RING_MASK
+static uint8_t ring_head = 0;
+static uint8_t ring_tail = 0;
+
+// Buffer of the pool for the next frame, NULL if the ring is full or no buffer is free. The frame
+// is dropped and counted then.
+FRAME_BUFFER* ring_reserve() {
+  uint8_t tail = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+  FRAME_BUFFER* buffer = NULL;
+  if ((uint8_t)(ring_head - tail) < RING_SLOTS)
+    buffer = pool_alloc();
+  if (buffer == NULL)
+    ring_counters.dropped++;
+  return buffer;
+}
+
+// Publish the frame written to the buffer of ring_reserve(), the loop takes over the reference
+void ring_commit(FRAME_BUFFER* buffer) {
+  ring_slots[ring_head & RING_MASK] = buffer;
+  uint8_t head = ring_head + 1;
+  __atomic_store_n(&ring_head, head, __ATOMIC_RELEASE);
+
+  ring_counters.received++;
+  uint8_t count = head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+  if (count > ring_counters.highWater)
+    ring_counters.highWater = count;
+}
+
+// Oldest frame in the ring, NULL if it is empty
+FRAME_BUFFER* ring_pop() {
+  uint8_t tail = ring_tail;
+  if (__atomic_load_n(&ring_head, __ATOMIC_ACQUIRE) == tail)
+    return NULL;
+  FRAME_BUFFER* buffer = ring_slots[tail & RING_MASK];
+  __atomic_store_n(&ring_tail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+  return buffer;
+}
+
+// Drop all waiting frames, e.g. the frames of the last link
+void ring_flush() {
+  FRAME_BUFFER* buffer;
+  while ((buffer = ring_pop()) != NULL)
+    pool_release(buffer);
+}
+
+// Frames waiting in the ring
+uint8_t ring_count() {
+  return __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE) - ring_tail;
+}
+
+const RING_COUNTERS* ring_getCounters() {
+  return &ring_counters;
+}
@@ -0,0 +1,38 @@
+/*
+frame_ring.h
+
+Lock-free single-producer / single-consumer ring of received Ethernet frames. The receive task
+copies the frames from the ENC28J60 into buffers of the frame pool, the ring hands the buffers
+to the loop for decoding.
+
+2023-12-18: Initial version
+*/
+
+#include <Arduino.h>
+#include "frame_pool.h"
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+// Number of slots, must be a power of two
+static const uint8_t RING_SLOTS = 8;
+
+// Counters of the receive task
+struct RING_COUNTERS {
+  uint32_t received;  // Frames put into the ring
+  uint32_t dropped;   // Frames dropped because the ring was full or no buffer was free
+  uint8_t highWater;  // Maximum number of frames waiting in the ring
+};
+
+// Producer: the receive task
+FRAME_BUFFER* ring_reserve();
+void ring_commit(FRAME_BUFFER* buffer);
+
+// Consumer: the loop, the buffer of ring_pop() is released with pool_release()
+FRAME_BUFFER* ring_pop();
+void ring_flush();
+
+uint8_t ring_count();
+const RING_COUNTERS* ring_getCounters();
+
+#endif
@@ -0,0 +1,73 @@
+/*
+link_timeline.cpp
+
+Time from Ethernet link-up to the discovery milestones.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "link_timeline.h"
+
+// Labels of the milestones, one per eTimelineEvent
+static const char* const TIMELINE_LABELS[timeline_EventCount] = {
+  "DHCP discover",
+  "DHCP offer",
+  "DHCP bound",
+  "LLDP",
+  "LLDP policy",
+  "CDP",
+  "CDP voice",
+  "Voice VLAN",
+  "Voice bound",
+  "DNS done",
+  "NTP OK"
+};
+
+static bool timeline_started = false;
+static unsigned long timeline_linkUp = 0;
+
+// Milliseconds from link-up to the milestone, 0 if it was not reached yet
+static uint32_t timeline_delays[timeline_EventCount];
+
+// Start a new timeline at link-up, the milestones of the last link are removed
+void timeline_start(unsigned long now) {
+  memset(timeline_delays, 0, sizeof(timeline_delays));
+  timeline_linkUp = now;
+  timeline_started = true;
+}
+
+// Record a milestone, returns true if it was reached for the first time since link-up
+bool timeline_mark(eTimelineEvent event, unsigned long now) {
+  if (!timeline_started || (event >= timeline_EventCount) || (timeline_delays[event] != 0))
+    return false;
+
+  // At least 1 ms, 0 is used for "not reached"
+  uint32_t delay = now - timeline_linkUp;
+  timeline_delays[event] = (delay == 0) ? 1 : delay;
+  return true;
+}
+
+// Milliseconds from link-up to the milestone, 0 if it was not reached yet
+uint32_t timeline_get(eTimelineEvent event) {
+  if (event >= timeline_EventCount)
+    return 0;
+  return timeline_delays[event];
+}
+
+// Number of milestones reached since link-up
+uint8_t timeline_count() {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < timeline_EventCount; i++) {
+    if (timeline_delays[i] != 0)
+      count++;
+  }
+  return count;
+}
+
+const char* timeline_label(eTimelineEvent event) {
+  if (event >= timeline_EventCount)
+    return "";
+  return TIMELINE_LABELS[event];
+}
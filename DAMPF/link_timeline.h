@@ -0,0 +1,37 @@
+/*
+link_timeline.h
+
+Time from Ethernet link-up to the discovery milestones: DHCP, LLDP, CDP, voice VLAN, DNS and NTP.
+Only the first occurrence of a milestone after link-up is recorded.
+
+2023-12-18: Initial version
+*/
+
+#include <Arduino.h>
+
+#ifndef LINK_TIMELINE_H
+#define LINK_TIMELINE_H
+
+// Milestones after link-up. The order is the order on the timeline page and in the SD export.
+enum eTimelineEvent {
+  timeline_DhcpDiscover = 0,  // First DHCP DISCOVER sent
+  timeline_DhcpOffer,         // First OFFER received, REQUEST sent
+  timeline_DhcpBound,         // ACK received, untagged lease bound
+  timeline_FirstLLDP,         // First LLDP neighbor
+  timeline_LldpPolicy,        // First LLDP-MED network policy
+  timeline_FirstCDP,          // First CDP neighbor
+  timeline_CdpVoice,          // First CDP voice VLAN
+  timeline_VoiceVLAN,         // Voice VLAN learned from LLDP or CDP
+  timeline_VoiceBound,        // Tagged lease in the voice VLAN bound
+  timeline_DnsDone,           // DNS lookups of the NTP sources finished
+  timeline_NtpOK,             // Time received from NTP
+  timeline_EventCount
+};
+
+void timeline_start(unsigned long now);
+bool timeline_mark(eTimelineEvent event, unsigned long now);
+uint32_t timeline_get(eTimelineEvent event);
+uint8_t timeline_count();
+const char* timeline_label(eTimelineEvent event);
+
+#endif
@@ -1,4 +1,4 @@
-/* 
+/*
 lldp_functions.cpp
 
 Evaluate received LLDP packages
@@ -13,1146 +13,668 @@ https://www.ieee802.org/3/frame_study/0409/blatherwick_1_0409.pdf
 #include <Arduino.h>
 #include "lldp_functions.h"
 #include "Packet_data.h"
-
-PINFO lldpinfo;
-
-int lldpIPaddr = 0;
+#include "neighbor_table.h"
+#include "fmt_functions.h"
 
 // LLDP broadcast address
 const byte lldp_mac[] = { 0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e };
 
-byte lldp_encbuff[1500];
-
-#ifdef DEBUGSENDLLDP
-// Use the following variables from the main sketch
-extern byte eth_buffcheck[];
-extern PINFO eth_lldpPacket;
-#endif
-
-unsigned int lldp_check_Packet(byte lldp_encbuff[], unsigned int length) {
-  if (length > 0) {
-    if (length > sizeof(lldp_encbuff))
-      length = sizeof(lldp_encbuff);
-
-    unsigned int lldpDataIndex = 0;
-    if (lldp_byte_array_contains(lldp_encbuff, lldpDataIndex, lldp_mac, sizeof(lldp_mac))) {
-      // LDDP Packet found and is now getting processed
-#ifdef DEBUGSERIAL
-      Serial.println("\n\nLLDP Packet Recieved");
-#endif
+// Read the TLV at *index and advance *index to the next one.
+// https://en.wikipedia.org/wiki/Link_Layer_Discovery_Protocol#Frame_structure
+// TLV structure
+// Type    Length  Value
+// 7 bits  9 bits  0-511 octets
+// Custom TLVs (type 127) start with a 3 byte OUI and a 1 byte subtype.
+// Returns false at the end of the LLDPDU or if the TLV does not fit into plen,
+// so a truncated or malformed frame never leads to reading beyond the buffer.
+bool lldp_nextTLV(const byte lldpData[], uint16_t plen, uint16_t* index, LLDP_TLV* tlv) {
+  uint16_t pos = *index;
+  if ((pos + 2) > plen)
+    return false;
+
+  tlv->type = lldpData[pos] >> 1;
+  tlv->length = ((lldpData[pos] & 0x01) << 8) | lldpData[pos + 1];
+  pos += 2;
+
+  if ((tlv->type == LLDP_TLV_END) || ((pos + tlv->length) > plen))
+    return false;
+
+  tlv->value = lldpData + pos;
+  tlv->oui = 0;
+  tlv->subtype = 0;
+  tlv->data = tlv->value;
+  tlv->dataLength = tlv->length;
+
+  if (tlv->type == LLDP_TLV_CUSTOM) {
+    if (tlv->length < 4)
+      return false;
+    tlv->oui = ((uint32_t)tlv->value[0] << 16) | (tlv->value[1] << 8) | tlv->value[2];
+    tlv->subtype = tlv->value[3];
+    tlv->data = tlv->value + 4;
+    tlv->dataLength = tlv->length - 4;
+  }
 
-      lldpDataIndex += sizeof(lldp_mac);  // Increment index the length of the source MAC address
+  *index = pos + tlv->length;
+  return true;
+}  // bool lldp_nextTLV()
+
+// Check the structure of the LLDPDU before it is decoded. IEEE 802.1AB requires Chassis ID,
+// Port ID and TTL as the first three TLVs, each only once, and the End of LLDPDU TLV.
+// A TLV chain running past plen is reported as truncated, e.g. a frame clipped to the buffer size.
+eFrameCheck lldp_validate(const byte lldpData[], uint16_t plen) {
+  uint16_t pos = LLDP_HEADER_LEN;
+  uint8_t count = 0;
+
+  while (true) {
+    if ((pos + 2) > plen)
+      return frame_Truncated;
+
+    uint8_t type = lldpData[pos] >> 1;
+    uint16_t length = ((lldpData[pos] & 0x01) << 8) | lldpData[pos + 1];
+    pos += 2;
+    if ((pos + length) > plen)
+      return frame_Truncated;
+
+    if (type == LLDP_TLV_END)
+      return ((count >= 3) && (length == 0)) ? frame_Valid : frame_Malformed;
+
+    switch (type) {
+      case LLDP_TLV_CHASSIS:
+      case LLDP_TLV_PORT:
+        // Subtype and 1 to 255 byte ID, at the expected position
+        if ((count != (type - LLDP_TLV_CHASSIS)) || (length < 2) || (length > 256))
+          return frame_Malformed;
+        break;
+      case LLDP_TLV_TTL:
+        if ((count != 2) || (length < 2))
+          return frame_Malformed;
+        break;
+      case LLDP_TLV_CUSTOM:
+        if ((count < 3) || (length < 4))
+          return frame_Malformed;
+        break;
+      default:
+        if (count < 3)
+          return frame_Malformed;
+        break;
+    }
 
-      // Get source MAC Address
-      byte* macFrom = lldp_encbuff + lldpDataIndex;
-      lldpinfo.MAC[1] = lldp_print_mac(macFrom, 0, 6);
-      lldpDataIndex += sizeof(lldp_mac);  // Increment index the length of the MAC address
-      lldpDataIndex += 2;
-      return lldpDataIndex;
-    } else {
-      return (0);
+    pos += length;
+    count++;
+  }
+}  // eFrameCheck lldp_validate()
+
+
+// Digest over the source MAC and all TLVs except the TTL, which is returned in *ttl.
+// Switches repeat the same advertisement, an unchanged digest means the content is the same.
+uint32_t lldp_digest(const byte lldpData[], uint16_t plen, uint16_t* ttl) {
+  LLDP_TLV tlv;
+  uint16_t lldpDataIndex = LLDP_HEADER_LEN;
+  uint32_t digest = pinfo_hash(PINFO_HASHINIT, lldpData + sizeof(lldp_mac), sizeof(lldp_mac));
+
+  *ttl = NEIGHBOR_DEFAULTTTL;
+  while (lldp_nextTLV(lldpData, plen, &lldpDataIndex, &tlv)) {
+    if (tlv.type == LLDP_TLV_TTL) {
+      if (tlv.length >= 2)
+        *ttl = (tlv.value[0] << 8) | tlv.value[1];
+      continue;
     }
+    // Header and value of the TLV
+    digest = pinfo_hash(digest, tlv.value - 2, tlv.length + 2);
   }
-  return (0);
-}
+  return digest;
+}  // uint32_t lldp_digest()
 
+// Decode the LLDP frame and update the received values in info.
+// Strings are only created for the values which are shown or exported.
+void lldp_packet_handler(const byte lldpData[], uint16_t plen, PINFO* info) {
+  LLDP_TLV tlv;
+  uint16_t lldpDataIndex = LLDP_HEADER_LEN;
 
-bool lldp_byte_array_contains(const byte a[], unsigned int offset, const byte b[], unsigned int length) {
-  for (unsigned int i = offset, j = 0; j < length; ++i, ++j) {
-    if (a[i] != b[j])
-      return false;
-  }
-  return true;
-}
-
+  info->proto = pinfo_ProtoLLDP;
+  pinfo_set(info, pinfo_Proto);
 
-PINFO lldp_packet_handler(byte lldpData[], uint16_t plen) {
-  lldpinfo.Proto[1] = "LLDP";
-  byte* macFrom = lldpData + sizeof(lldp_mac);
-  lldp_print_mac(macFrom, 0, 6);
-  unsigned int lldpDataIndex = 14;
-  uint32_t OUI;
-  uint8_t OUIsubType;
-
-  while (lldpDataIndex < plen) {
-    // https://en.wikipedia.org/wiki/Link_Layer_Discovery_Protocol#Frame_structure
-    // TLV structure
-    // Type    Length  Value
-    // 7 bits  9 bits  0-511 octets
-
-    // read all remaining TLV fields
-    unsigned int lldpFieldType = lldpData[lldpDataIndex] >> 1;
-    unsigned int lldpFieldLength = (lldpData[lldpDataIndex] & 0x01) << 8;
-    lldpDataIndex += 1;
-    lldpFieldLength += lldpData[lldpDataIndex];
-    lldpDataIndex += 1;
-
-    switch (lldpFieldType) {
-      case 0x0000:
-        // End of LLDPDU
-        break;
+  // Get source MAC Address
+  memcpy(info->mac, lldpData + sizeof(lldp_mac), sizeof(info->mac));
+  pinfo_set(info, pinfo_MAC);
 
-      case 0x0001:
+  while (lldp_nextTLV(lldpData, plen, &lldpDataIndex, &tlv)) {
+    switch (tlv.type) {
+      case LLDP_TLV_CHASSIS:
         {
-          // Chassis ID / Chassis Type
-          lldpinfo.ChassisID[1] = handlePortSubtype(lldpData, lldpDataIndex, lldpFieldLength);
+          // Chassis ID
+          // 1 byte: Subtype
+          //   4: MAC address
+          //   5: Network address
+          //   1-3, 6, 7: Chassis component, Interface alias, Port component, Interface name, Locally assigned
+          if (tlv.length < 2)
+            break;
+          if (tlv.value[0] == 4)
+            pinfo_setHex(info, pinfo_ChassisID, tlv.value + 1, tlv.length - 1);
+          else if (tlv.value[0] == 5)
+            lldp_addressField(info, pinfo_ChassisID, tlv.value + 1, tlv.length - 1);
+          else
+            pinfo_setText(info, pinfo_ChassisID, tlv.value + 1, tlv.length - 1);
           break;
         }
 
-      case 0x0002:
+      case LLDP_TLV_PORT:
         {
           // Port / Port ID
-          // Strip unnecessary data, only having the last port number
-          String tmpStr = handlePortSubtype(lldpData, lldpDataIndex, lldpFieldLength);
-          if (tmpStr.indexOf('/') > 0) {
-            tmpStr = tmpStr.substring(tmpStr.lastIndexOf('/') + 1);
-          }
-          lldpinfo.Port[1] = tmpStr;
+          // https://docs.zephyrproject.org/latest/reference/kconfig/CONFIG_NET_LLDP_PORT_ID_SUBTYPE.html
+          // 1 byte: Subtype
+          //   3: MAC address
+          //   4: Network address
+          //   1, 2, 5-7: Interface alias, Port component, Interface name, Agent circuit ID, Locally assigned
+          if (tlv.length < 2)
+            break;
+          if (tlv.value[0] == 3)
+            pinfo_setHex(info, pinfo_Port, tlv.value + 1, tlv.length - 1);
+          else if (tlv.value[0] == 4)
+            lldp_addressField(info, pinfo_Port, tlv.value + 1, tlv.length - 1);
+          else
+            pinfo_setLastPart(info, pinfo_Port, tlv.value + 1, tlv.length - 1);  // Strip unnecessary data, only having the last port number
           break;
         }
 
-      case 0x0003:
+      case LLDP_TLV_TTL:
         {
           // TTL - Time to live
           // 16 bit value in seconds
-          lldpinfo.TTL[1] = lldp_handleCdpNumField(lldpData, lldpDataIndex, lldpFieldLength);
+          if (tlv.length < 2)
+            break;
+          info->ttl = (tlv.value[0] << 8) | tlv.value[1];
+          pinfo_set(info, pinfo_TTL);
           break;
         }
 
-      case 0x0004:
+      case LLDP_TLV_PORTDESC:
         {
           // Port Description
           // Strip unnecessary data, only having the last port number
-          String tmpStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-          if (tmpStr.indexOf('/') > 0) {
-            tmpStr = tmpStr.substring(tmpStr.lastIndexOf('/') + 1);
-          }
-          lldpinfo.PortDesc[1] = tmpStr;
+          pinfo_setLastPart(info, pinfo_PortDesc, tlv.value, tlv.length);
           break;
         }
 
-      case 0x0005:
+      case LLDP_TLV_SYSNAME:
         {
           // Device Name
           // Split device name into name and domain
-          String tmpStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-          byte pos = tmpStr.indexOf('.');
-          if (pos > 0) {
-            lldpinfo.SWName[1] = tmpStr.substring(0, pos);
-            lldpinfo.SWDomain[1] = tmpStr.substring(pos + 1);
-          } else {
-            lldpinfo.SWName[1] = tmpStr;
-            lldpinfo.SWDomain[1] = "";
-          }
+          uint16_t pos = 0;
+          while ((pos < tlv.length) && (tlv.value[pos] != '.'))
+            pos++;
+          pinfo_setText(info, pinfo_SWName, tlv.value, pos);
+          if (pos < tlv.length)
+            pinfo_setText(info, pinfo_SWDomain, tlv.value + pos + 1, tlv.length - pos - 1);
+          else
+            pinfo_setText(info, pinfo_SWDomain, tlv.value, 0);
           break;
         }
 
-      case 0x0006:
+      case LLDP_TLV_SYSDESC:
         {
           // Model Name / System Description
-          String tmpStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-          uint16_t tmp16 = tmpStr.indexOf("\n");
-          tmpStr = tmpStr.substring(0, tmp16 - 1);
-          if (lldpinfo.Model[1] == "-")
-            lldpinfo.Model[1] = tmpStr;
+          // Only the first line is used and only if the LLDP-MED inventory did not provide a model name
+          if (pinfo_isSet(info, pinfo_Model))
+            break;
+          pinfo_setFirstLine(info, pinfo_Model, tlv.value, tlv.length);
           break;
         }
 
-      case 0x0007:
+      case LLDP_TLV_CAPABILITIES:
         {
           // System Capabilities
-          handlelldpCapabilities(lldpData, lldpDataIndex + 2, lldpFieldLength - 2);
+          // 2 byte: System capabilities
+          // 2 byte: Enabled capabilities
+          if (tlv.length < 4)
+            break;
+          info->sysCap = (tlv.value[0] << 8) | tlv.value[1];
+          info->cap = (tlv.value[2] << 8) | tlv.value[3];
+          info->fields |= PINFO_FIELD(pinfo_SysCap) | PINFO_FIELD(pinfo_Cap);
           break;
         }
 
-      case 0x0008:
+      case LLDP_TLV_MGMTADDR:
         {
           // Management IP Address
-          lldpinfo.IP[1] = handleManagementSubtype(lldpData, lldpDataIndex, lldpFieldLength);
+          // 1 byte: Address string length (subtype + address)
+          // 1 byte: Address subtype, https://github.com/boundary/wireshark/blob/master/epan/dissectors/packet-lldp.c
+          //   1: IPv4
+          //   2: IPv6
+          //   [Other]: MAC
+          // n byte: Address
+          if ((tlv.length < 1) || (tlv.value[0] < 2) || (tlv.value[0] >= tlv.length))
+            break;
+          // Only IPv4 addresses are shown
+          if ((tlv.value[0] != 5) || (tlv.value[1] != 1))
+            break;
+          memcpy(info->ip, tlv.value + 2, IP_LEN);
+          pinfo_set(info, pinfo_IP);
           break;
         }
 
-      case 0x007f:  // Custom TLVs
+      case LLDP_TLV_CUSTOM:
         {
-          // Custom TLVs
-          // https://www.ieee802.org/3/frame_study/0409/blatherwick_1_0409.pdf
-          // 3 byte: Organizationally Unique Identifier (OUI)
-          // 1 byte: Group-defined TLV subtype
-          // 0 < n < 507 bytes: Group defined information string
-          OUI = (lldpData[lldpDataIndex + 0] << 16) + (lldpData[lldpDataIndex + 1] << 8) + (lldpData[lldpDataIndex + 2]);
-          OUIsubType = lldpData[lldpDataIndex + 3];
-          lldpDataIndex += 4;
-          lldpFieldLength -= 4;
-#ifdef DEBUGSERIAL
-          Serial.println("\n\nLLDP custom type OUI:     " + String(OUI, HEX));
-          Serial.println("LLDP custom type subtype: " + String(OUIsubType, HEX));
-          Serial.println("LLDP custom data length:  " + String(lldpFieldLength, DEC));
-          Serial.println("lldp custom field:");
-          for (uint16_t i = 0; i < lldpFieldLength; i++) {
-            String data = "00" + String(lldpData[lldpDataIndex + i], HEX);
-            data = "0x" + data.substring(data.length() - 2);
-            Serial.print(data + " ");
-          }
-          Serial.println("\n\n");
-#endif
-
-          switch (OUI) {
-              // OUIs from https://wiki.wireshark.org/LinkLayerDiscoveryProtocol
-              // 00-12-0F - IEEE 802.3
-              // 00-12-BB - TIA TR-41 Committee - Media Endpoint Discovery (LLDP-MED, ANSI/TIA-1057)
-              // 00-0E-CF - PROFIBUS International (PNO) Extension for PROFINET discovery information
-              // 00-80-c2 - IEEE 802.1
-              // 30-B2-16 - Hytec Geraetebau GmbH Extensions
-
-            case 0x00120f:  // IEEE 802.3
-              {
-#ifdef DEBUGSERIAL
-                Serial.println("\n\nLLDP custom type OUI:     " + String(OUI, HEX));
-                Serial.println("LLDP custom type subtype: " + String(OUIsubType, HEX));
-                Serial.println("LLDP custom data length:  " + String(lldpFieldLength, DEC));
-                Serial.println("lldp custom field:");
-                for (uint16_t i = 0; i < lldpFieldLength; i++) {
-                  String data = "00" + String(lldpData[lldpDataIndex + i], HEX);
-                  data = "0x" + data.substring(data.length() - 2);
-                  Serial.print(data + " ");
-                }
-                Serial.println("\n\n");
-#endif
-
-                switch (OUIsubType) {
-                    // Annex G of the LLDP specification defines the following set of IEEE 802.3 Organizationally Specific TLVs:
-                    // https://www.ieee802.org/3/frame_study/0409/blatherwick_1_0409.pdf
-                    // MAC/PHY Configuration/Status TLV (OUI = 00-12-0f, Subtype = 1)
-                    // Subtype 1: MAC/PHY Configuration/Status
-                    // Subtype 2: MDI Power Support (MDI=Media Dependent Interface)
-                    // Subtype 3: Link Aggregation
-                    // Subtype 4: Maximum Frame Size
-                    // Subtype 5: Energy-Efficient Ethernet
-                    // Subtype 6: unknown
-                    // Subtype 7: IEEE 802.3br Frame Preemption Protocol
-
-                  case 1:  // MAC/PHY Configuration/Status
-                    {
-                      // 1 byte: Auto-Negotiation Support/Status:
-                      //         0b0000 000x = Auto-Negotiation: 1=Supported
-                      //         0b0000 00x0 = Auto-Negotiation: 1=Enabled
-                      // 2 byte: PMD Auto-Negotiation Advertised Capability
-                      //         0b0000 0000 0000 000x = 1000BASE-T (full duplex mode)
-                      //         0b0000 0000 0000 00x0 = 1000BASE-T (half duplex mode)
-                      //         0b0000 0000 0000 0x00 = 1000BASE-X (-LX, -SX, -CX full duplex mode)
-                      //         0b0000 0000 0000 x000 = 1000BASE-X (-LX, -SX, -CX half duplex mode)
-                      //         0b0000 0000 000x 0000 = Asymmetric and Symmetric PAUSE (for full-duplex links)
-                      //         0b0000 0000 00x0 0000 = Symmetric PAUSE (for full-duplex links)
-                      //         0b0000 0000 0x00 0000 = Asymmetric PAUSE (for full-duplex links)
-                      //         0b0000 0000 x000 0000 = PAUSE (for full-duplex links)
-                      //         0b0000 000x 0000 0000 = 100BASE-T2 (full duplex mode)
-                      //         0b0000 00x0 0000 0000 = 100BASE-T2 (half duplex mode)
-                      //         0b0000 0x00 0000 0000 = 100BASE-TX (full duplex mode)
-                      //         0b0000 x000 0000 0000 = 100BASE-TX (half duplex mode)
-                      //         0b000x 0000 0000 0000 = 100BASE-T4
-                      //         0b00x0 0000 0000 0000 = 10BASE-T (full duplex mode)
-                      //         0b0x00 0000 0000 0000 = 10BASE-T (half duplex mode)
-                      //         0bx000 0000 0000 0000 = Other or unknown
-                      // 2 byte: Operational MAU Type: (0x0000) = Other or unknown
-#ifdef DEBUGSERIAL
-                      byte autoNeg = lldpData[lldpDataIndex + 0];
-                      String autoNegStr = "Auto negotiation ";
-                      if (autoNeg & (0x01 == 0)) autoNegStr += "not ";
-                      autoNegStr += "supported / ";
-                      if (autoNeg & (0x02 == 0)) autoNegStr += "not ";
-                      autoNegStr += "enabled";
-
-                      uint16_t autoNegAdvCap = (lldpData[lldpDataIndex + 1] << 8) | lldpData[lldpDataIndex + 2];
-                      Serial.println(autoNegStr);
-                      Serial.println("PMD Auto-Negotiation Advertised Capability: " + String(autoNegAdvCap, BIN));
-#endif
-                      break;
-                    }  // case 1: MAC/PHY Configuration/Status
-
-                  case 2:  // MDI Power Support
-                    {
-                      // 1 byte: Port Class, Support capability, Enabled (pethPsePortAdminEnable), Pair control ability (pethPsePortPowerPairContolAbility)
-                      //   bit 0: Port class: 1 = PSE, 0 = PD
-                      //   bit 1: Power Sourcing Equipment (PSE): MDI power support: 1 = supported, 0 = not supported
-                      //   bit 2: PSE MDI power state: 1 = enabled, 0 = disabled
-                      //   bit 3: PSE pairs control ability: 1 = pair selection can be controlled, 0 = pair selection can not be controlled
-                      //   bit 4-7: reserved for future use
-                      //
-                      // 1 byte: Power Pairs as defined in pethPsePortPowerPairs:
-                      //   bit 1: signal pairs only are in use
-                      //   bit 2: spare pairs only are in use. or binary coded?
-                      //
-                      // 1 byte: Power Class as defined in pethPsePortPowerClassification:
-                      //   0: not available?
-                      //   1: Class 0: 0.44W to 12.95W, max Power 15.4W
-                      //   2: Class 1: 0.44W to 3.84W, max Power 4.00W
-                      //   3: Class 2: 3.84W to 6.49W, max Power 7.00W
-                      //   4: Class 3: 6.49W to 12.95W, max Power 15.4W
-                      //   5: Class 4: 12.95W to 25.5W, max Power 30W
-                      //   6: Class 5: 40W,, max Power 45W
-                      //   7: Class 6: 51W,, max Power 60W
-                      //   8: Class 7: 62W,, max Power 75W
-                      //   9: Class 8: 71.3W,, max Power 99W
-                      // 1 byte: Type/source priority
-                      //   0b000000xx power priority: 11=low;10=high;01=critical;00=unknown
-                      //   0b0000xx00 reserved
-                      //   0b00xx0000 power source
-                      //   0b0x000000 power type: 1=PD; 0=PSE
-                      //   0bx0000000 power type: 1=Type 1; 0=Type 2
-                      // 2 byte: PD requested power value, 0–25.5 W in 0.1 W steps
-                      // 2 byte: PSE allocated power value, 0–25.5 W in 0.1 W steps
-
-#ifdef DEBUGSERIAL
-                      byte portClass = lldpData[lldpDataIndex + 0];
-                      String portClassStr;
-                      if ((portClass & 0x01) == 0x01)
-                        portClassStr += "PSE";
-                      else
-                        portClassStr += "PD";
-                      portClassStr += "\nMDI power ";
-                      if ((portClass & 0x02) == 0x02)
-                        portClassStr += "";
-                      else
-                        portClassStr += "not";
-                      portClassStr += " supported\nPSE MDI power state: ";
-                      if ((portClass & 0x04) == 0x04)
-                        portClassStr += "enabled";
-                      else
-                        portClassStr += "disabled";
-                      portClassStr += "\nPSE pairs control ability: pair selection can ";
-                      if ((portClass & 0x08) == 0x08)
-                        portClassStr += "";
-                      else
-                        portClassStr += "not ";
-                      portClassStr += "be controlled";
-
-                      // The PSE power pair field shall contain an integer value as defined by the pethPsePortPowerPairs object in IETF RFC 3621.
-                      byte powerPairs = lldpData[lldpDataIndex + 1];
-
-                      // The power class field shall contain an integer value as defined by the pethPsePortPowerClassifications object in IETF RFC 3621.
-                      byte powerClass = lldpData[lldpDataIndex + 2];
-
-                      switch (powerClass) {
-                        case 0:
-                          lldpinfo.PoEAvail[1] = "n/a";
-                          break;
-                        case 1:
-                          lldpinfo.PoEAvail[1] = "0.44W-12.95W";
-                          break;
-                        case 2:
-                          lldpinfo.PoEAvail[1] = "0.44W-3.84W";
-                          break;
-                        case 3:
-                          lldpinfo.PoEAvail[1] = "3.84W-6.49W";
-                          break;
-                        case 4:
-                          lldpinfo.PoEAvail[1] = "6.49W-12.95W";
-                          break;
-                        case 5:
-                          lldpinfo.PoEAvail[1] = "12.95W-25.5W";
-                          break;
-                        case 6:
-                          lldpinfo.PoEAvail[1] = "40W";
-                          break;
-                        case 7:
-                          lldpinfo.PoEAvail[1] = "51W";
-                          break;
-                        case 8:
-                          lldpinfo.PoEAvail[1] = "62W";
-                          break;
-                        case 9:
-                          lldpinfo.PoEAvail[1] = "71.3W";
-                          break;
-                        default:
-                          break;
-                      }
-                      byte typeSourcePrio = lldpData[lldpDataIndex + 3];
-
-                      Serial.println(portClassStr);
-                      Serial.println("\nPower pairs: " + String(powerPairs) + " / 1=signal pairs only are in use, 2=spare pairs only are in use");
-                      Serial.println("\nPower class: " + String(powerClass - 1) + " (0-9): " + lldpinfo.PoEAvail[1]);
-                      Serial.println("\nType Source Prio: " + String(typeSourcePrio));
-
-                      uint16_t pdReqPower = (lldpData[lldpDataIndex + 4] << 8) | lldpData[lldpDataIndex + 5];
-                      String pdReqPowerStr = String((float)(pdReqPower) / 10.0) + "Wh";
-                      uint16_t pdAllocPower = (lldpData[lldpDataIndex + 6] << 8) | lldpData[lldpDataIndex + 7];
-                      String pdAllocPowerStr = String((float)(pdAllocPower) / 10.0) + "Wh";
-                      Serial.println("\nPD requested power: " + pdReqPowerStr);
-                      Serial.println("\nPSE allocated power: " + pdAllocPowerStr);
-#endif
-                      break;
-                    }  // case 2: MDI Power Support
-
-                  case 3:  // Link Aggregation
-                    {
-                      // 1 byte: Capability and Status: Bit mask for capability and current aggregation status
-                      //         bit 0 Aggregation capability 0 = not capable of being aggregated, 1 = capable of being aggregated
-                      //         bit 1 Aggregation status 0 = not currently in aggregation, 1 = currently in aggregation
-                      // 4 byte: Port Identifier, derived from ifNumber in ifIndex (aAggPortID)
-#ifdef DEBUGSERIAL
-                      byte capStat = lldpData[lldpDataIndex + 0];
-                      uint32_t portID = (lldpData[lldpDataIndex + 1] << 24) | (lldpData[lldpDataIndex + 2] << 16) | (lldpData[lldpDataIndex + 3] << 8) | lldpData[lldpDataIndex + 4];
-                      Serial.println("Link Aggregation:\nCapability and Status: " + String(capStat) + "\nPort ID: " + String(portID));
-#endif
-                      break;
-                    }  // case 3: Link Aggregation
-
-                  case 4:  // Maximum Frame Size
-                    {
-                      // 2 byte: - Basic MAC frame size (subclause 3.1.1) is 1518
-                      //         - Tagged MAC frame size (subclause 3.5) is 1522
-                      //         - Other frame sizes are implementation dependent0
-#ifdef DEBUGSERIAL
-                      uint16_t frameSize = (lldpData[lldpDataIndex + 0] << 8) | lldpData[lldpDataIndex + 1];
-                      Serial.println("Maximum frame size:: " + String(frameSize));
-#endif
-                      break;
-                    }  // case 4: Maximum Frame Size
-
-                  case 5:  // Energy-Efficient Ethernet
-                    {
-#ifdef DEBUGSERIAL
-                      Serial.println("CDP: unhandled Energy efficient Ethernet subtype");
-#endif
-                      break;
-                    }
-
-                  case 7:  // IEEE 802.3br Frame Preemption Protocol
-                    {
-#ifdef DEBUGSERIAL
-                      Serial.println("CDP: unhandled IEEE 802.3br Frame Preemption Protocol");
-#endif
-                      break;
-                    }
-
-                  default:
-                    {
-                      break;
-                    }
-                }  // switch( OUIsubType )
-
-                break;
-              }  // case 0x00120f: IEEE 802.3
-
-              // #######################################################
-
-            case 0x0012bb:  // TIA TR-41 Committee - Media Endpoint Discovery (LLDP-MED, ANSI/TIA-1057)
-              {
-                // 0x0012bb: Telecommunications In Media Subtype
-                // The LLDP-MED specification defines the following set of TIA Organizationally Specific TLVs:
-                // LLDP-MED Capabilities TLV (OUI = 00-12-BB, Subtype = 1)
-                // Network Policy TLV (OUI = 00-12-BB, Subtype = 2)
-                // Location Identification TLV (OUI = 00-12-BB, Subtype = 3)
-                // Extended Power-via-MDI TLV (OUI = 00-12-BB, Subtype = 4)
-                // Inventory - Hardware Revision TLV (OUI = 00-12-BB, Subtype = 5)
-                // Inventory - Firmware Revision TLV (OUI = 00-12-BB, Subtype = 6)
-                // Inventory - Software Revision TLV (OUI = 00-12-BB, Subtype = 7)
-                // Inventory - Serial Number TLV (OUI = 00-12-BB, Subtype = 8)
-                // Inventory - Manufacturer Name TLV (OUI = 00-12-BB, Subtype = 9)
-                // Inventory - Model Name TLV (OUI = 00-12-BB, Subtype = 10)
-                // Inventory - Asset ID TLV (OUI = 00-12-BB, Subtype = 11)
-                switch (OUIsubType) {
-                  case 1:  // LLDP-MED Capabilities TLV
-                    {
-                      // 2 byte: Capabilities
-                      //         0b0000 0000 0000 000x = 0x0001 LLPD-MED Capabilities
-                      //         0b0000 0000 0000 00x0 = 0x0002 Network policy
-                      //         0b0000 0000 0000 0x00 = 0x0004 Location Identification
-                      //         0b0000 0000 0000 x000 = 0x0008 Extended Power via MDI-PSE
-                      //         0b0000 0000 000x 0000 = 0x0010 Extended Power via MDI-PD
-                      //         0b0000 0000 00x0 0000 = 0x0020 Inventory
-                      // 1 byte: Class Type
-                      //         0: Type Not Defined
-                      //         1: Endpoint Class I
-                      //         2: Endpoint Class II
-                      //         3: Endpoint Class III
-                      //         4: Network Connectivity
-#ifdef DEBUGSERIAL
-                      uint16_t tmp16 = (lldpData[lldpDataIndex + 0] << 8) | lldpData[lldpDataIndex + 1];
-                      String tmpStr = "Capabilities:\n";
-                      if ((tmp16 & 0x001) != 0) tmpStr += "LLPD-MED\n";
-                      if ((tmp16 & 0x002) != 0) tmpStr += "Network policy\n";
-                      if ((tmp16 & 0x004) != 0) tmpStr += "Location Identification\n";
-                      if ((tmp16 & 0x008) != 0) tmpStr += "Extended Power via MDI-PSE\n";
-                      if ((tmp16 & 0x010) != 0) tmpStr += "Extended Power via MDI-PD\n";
-                      if ((tmp16 & 0x020) != 0) tmpStr += "Inventory";
-                      Serial.println(tmpStr + "\n");  // Capabilities
-
-                      uint8_t tmp8 = lldpData[lldpDataIndex + 2];
-                      tmpStr = "Class type: ";
-                      switch (tmp8) {
-                        case 0:
-                          tmpStr += " Type Not Defined";
-                          break;
-                        case 1:
-                          tmpStr += "Endpoint Class I";
-                          break;
-                        case 2:
-                          tmpStr += "Endpoint Class II";
-                          break;
-                        case 3:
-                          tmpStr += "Endpoint Class III";
-                          break;
-                        case 4:
-                          tmpStr += "Network Connectivity";
-                          break;
-                        default:
-                          tmpStr += "unknown type " + String(tmp8);
-                          break;
-                      }
-
-                      Serial.println(tmpStr);  // Class type
-#endif
-                      break;
-                    }  // case 1: LLDP-MED Capabilities TLV
-
-                  case 2:  // Network Policy
-                    {
-                      // 1 byte: Media application
-                      //         0: Reserved
-                      //         1: Voice
-                      //         2: Voice Signaling
-                      //         3: Guest Voice
-                      //         4: Guest Voice Signaling
-                      //         5: Softphone Voice
-                      //         6: Video Conferencing
-                      //         7: Streaming Video
-                      //         8: Video Signaling
-                      // 3 byte: Flags
-                      //         0x00003F DSCP Priority
-                      //         0x0001C0 Media L2 Priority
-                      //         0x1FFE00 Media VLAN ID
-                      //         0x400000 Media tag flag: tagged VLAN if set
-                      //         0x800000 Media policy flag
-                      if (lldpFieldLength < 4) {
-#ifdef DEBUGSERIAL
-                        Serial.println("TLV length too short.");
-#endif
-                        break;
-                      }
-                      byte mediaApplication = lldpData[lldpDataIndex];
-                      String tmpStr = "Media application: ";
-                      switch (mediaApplication) {
-                        case 0:
-                          tmpStr += "Reserved";
-                          break;
-                        case 1:
-                          tmpStr += "Voice";
-                          break;
-                        case 2:
-                          tmpStr += "Voice Signaling";
-                          break;
-                        case 3:
-                          tmpStr += "Guest Voice";
-                          break;
-                        case 4:
-                          tmpStr += "Guest Voice Signaling";
-                          break;
-                        case 5:
-                          tmpStr += "Softphone Voice";
-                          break;
-                        case 6:
-                          tmpStr += "Video Conferencing";
-                          break;
-                        case 7:
-                          tmpStr += "Streaming Video";
-                          break;
-                        case 8:
-                          tmpStr += "Video Signaling";
-                          break;
-                        default:
-                          tmpStr += "unknown";
-                          break;
-                      }
-
-                      uint32_t tmp32 = (lldpData[lldpDataIndex + 1] << 16) | (lldpData[lldpDataIndex + 2] << 8) | lldpData[lldpDataIndex + 3];
-#ifdef DEBUGSERIAL
-                      byte mediaPolicyFlag = (tmp32 & 0x800000) >> 23;
-#endif
-                      byte mediaTagFlag = (tmp32 & 0x400000) >> 22;
-                      uint16_t mediaVlanID = (tmp32 & 0x1FFE00) >> 9;
-#ifdef DEBUGSERIAL
-                      byte mediaL2Prio = (tmp32 & 0x0001C0) >> 6;
-                      byte dscp = (tmp32 & 0x00003F);
-#endif
-
-#ifdef DEBUGSERIAL
-                      Serial.println(tmpStr);
-                      Serial.println("Media Policy Flag: " + String(mediaPolicyFlag));
-                      Serial.println("Media Tag Flag:    " + String(mediaTagFlag));
-                      Serial.println("Media VLan ID:     " + String(mediaVlanID));
-                      Serial.println("Media L2 Prio:     " + String(mediaL2Prio));
-                      Serial.println("Media l2 DSCP:     " + String(dscp));
-#endif
-                      if ((mediaTagFlag == 1) && (mediaVlanID != 0)) {
-                        lldpinfo.VoiceVLAN[1] = String(mediaVlanID);
-                      }
-                      break;
-                    }  // case 2: Network Policy
-
-                  case 3:  // Location Identification
-                    {
-                      // complex format, usefull here?
-                      // 1 byte: Location data format:
-                      //   0: invalid
-                      //   1: Coordinate-based LCI => complex calculation, will be skipped
-                      //   2: Civic Address LCI
-                      //   3: ECS ELIN
-                      byte locFormat = lldpData[lldpDataIndex++];
-                      switch (locFormat) {
-                        case 2:  // Civic Address LCI
-                          {
-                            byte len = lldpData[lldpDataIndex++];
-
-                            // Address owner
-                            byte addressOwnerVal = lldpData[lldpDataIndex++];
-                            String addressOwner;
-                            if (addressOwnerVal == 0)
-                              addressOwner = "Location of the DHCP server";
-                            else if (addressOwnerVal == 1)
-                              addressOwner = "Location of the network element believed to be closest to the client";
-                            else if (addressOwnerVal == 2)
-                              addressOwner = "Location of the client";
-                            else
-                              addressOwner = "Invalid address owner value: " + String(addressOwnerVal);
-                            len--;
-
-                            String country = handlelldpAsciiField(lldpData, lldpDataIndex, 2);
-                            len -= 2;
-
-                            String addressStr;
-                            while (len > 0) {
-                              byte addressType = lldpData[lldpDataIndex++];
-                              len--;
-                              addressStr += handleAddressType(addressType);
-
-                              byte addressLen = lldpData[lldpDataIndex++];
-                              len--;
-                              addressStr += handlelldpAsciiField(lldpData, lldpDataIndex, addressLen);
-                              len -= addressLen;
-
-                              if (len > 0)
-                                addressStr += "\n";
-                            }  // while( len > 0 )
+          lldp_customTLV(&tlv, info);
+          break;
+        }
 
-#ifdef DEBUGSERIAL
-                            Serial.println("Address owner: " + addressOwner);
-                            Serial.println("Country: " + country);
-                            Serial.println("Address:\n" + addressStr);
-#endif
-                            break;
-                          }  // case 2: Civic Address LCI
+        // #######################################################
 
-                        case 3:  // ECS ELIN
-                          {
-                            String addressStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength - 1);
+      default:
+        {
 #ifdef DEBUGSERIAL
-                            Serial.println("ECS ELIN Address: " + addressStr);
+          Serial.printf("LLDP unhandled type: 0x%x\n", tlv.type);
+          Serial.printf("LLDP field length:   %u\n", tlv.length);
 #endif
-
-                            break;
-                          }  // case 3: ECS ELIN
-
-                        case 0:   // invalid
-                        case 1:   // Coordinate-based LCI
-                        default:  // unknown
-                          break;
-                      }  // switch( locFormat )
-                      break;
-                    }  // case 3: Location Identification
-
-                  case 4:  // Extended Power-via-MDI
-                    {
-                      // 1 byte: Power type (& 0xc0)
-                      //          0bxx00 0000 = 0xc0: PD Device or PSE Device
-                      //         Power Source
-                      //          0b00xx 0000 = 0x30: Power source depending on device
-                      //         Power Priority
-                      //          0b0000 xxxx = 0x0f
-                      //          0b0000 0000 = 0x00: Unknown
-                      //          0b0000 0001 = 0x01: Critical
-                      //          0b0000 0010 = 0x02: High
-                      //          0b0000 0011 = 0x03: Low
-                      // 2 byte: Power in 0.1 W steps
-                      byte powerType = lldpData[lldpDataIndex];
-                      String tmpStr = "Power type: ";
-                      if (((powerType & 0xc0) == 0) || ((powerType & 0xc0) == 0x80)) {
-                        tmpStr += "Power Source Equipment\n";
-                        if ((powerType & 0x10) != 0)
-                          tmpStr += "Primary Power Source\n";
-                        else if ((powerType & 0x20) != 0)
-                          tmpStr += "Backup Power Source\n";
-                      } else if (((powerType & 0xc0) == 0x40) || ((powerType & 0xc0) == 0xc0)) {
-                        tmpStr += "Powered Device\n";
-                        if ((powerType & 0x30) == 0x30)
-                          tmpStr += "PSE and Local\n";
-                        else if ((powerType & 0x10) != 0)
-                          tmpStr += "PSE\n";
-                        else if ((powerType & 0x20) != 0)
-                          tmpStr += "Local\n";
-                      }
-
-                      tmpStr += "Power Priority ";
-                      switch (powerType & 0x0f) {
-                        case 1:
-                          tmpStr += "Critical";
-                          break;
-
-                        case 2:
-                          tmpStr += "High";
-                          break;
-
-                        case 3:
-                          tmpStr += "Low";
-                          break;
-
-                        default:
-                          tmpStr += "Unknown";
-                          break;
-                      }
-#ifdef DEBUGSERIAL
-                      Serial.println(tmpStr);
+          break;
+        }
+    }  // switch( tlv.type )
+  }    // while( lldp_nextTLV() )
+}  // void lldp_packet_handler()
+
+
+// Organizationally specific TLVs
+// https://www.ieee802.org/3/frame_study/0409/blatherwick_1_0409.pdf
+// 3 byte: Organizationally Unique Identifier (OUI)
+// 1 byte: Group-defined TLV subtype
+// 0 < n < 507 bytes: Group defined information string
+// OUIs from https://wiki.wireshark.org/LinkLayerDiscoveryProtocol
+// 00-12-0F - IEEE 802.3
+// 00-12-BB - TIA TR-41 Committee - Media Endpoint Discovery (LLDP-MED, ANSI/TIA-1057)
+// 00-80-C2 - IEEE 802.1
+//
+// Every decoder stores the values in PINFO_LLDPORG. The decoder table below checks the
+// minimum length of the information string, so the decoders can read it without checks.
+
+// IEEE 802.3 MAC/PHY Configuration/Status
+// 1 byte: Auto-Negotiation Support/Status: bit 0 supported, bit 1 enabled
+// 2 byte: PMD Auto-Negotiation Advertised Capability
+// 2 byte: Operational MAU Type: (0x0000) = Other or unknown
+static bool lldp_orgMacPhy(const byte data[], uint16_t /* length */, PINFO* info) {
+  info->lldp.autoNeg = data[0] & 0x03;
+  info->lldp.autoNegAdvCap = (data[1] << 8) | data[2];
+  info->lldp.mauType = (data[3] << 8) | data[4];
+#ifdef DEBUGSERIAL
+  Serial.printf("Auto negotiation supported=%u enabled=%u, advertised 0x%04x, MAU type %u\n",
+                info->lldp.autoNeg & 0x01, (info->lldp.autoNeg >> 1) & 0x01, info->lldp.autoNegAdvCap, info->lldp.mauType);
 #endif
+  return true;
+}
 
-                      uint16_t powerValue = (lldpData[lldpDataIndex + 1] << 8) | lldpData[lldpDataIndex + 2];
-                      String powerValueStr = String((float)(powerValue) / 10.0) + "Wh";
+// IEEE 802.3 MDI Power Support
+// 1 byte: Port class: bit 0 PSE, bit 1 MDI power supported, bit 2 MDI power enabled, bit 3 pair control
+// 1 byte: Power pairs as defined in pethPsePortPowerPairs: 1 = signal pairs, 2 = spare pairs
+// 1 byte: Power class as defined in pethPsePortPowerClassification (RFC 3621), 1 = class 0
+// With the IEEE 802.3at extension:
+// 1 byte: Type/source priority
+// 2 byte: PD requested power value in 0.1 W steps
+// 2 byte: PSE allocated power value in 0.1 W steps
+static bool lldp_orgPower(const byte data[], uint16_t length, PINFO* info) {
+  info->lldp.powerPortClass = data[0];
+  info->lldp.powerPairs = data[1];
+  info->lldp.powerClass = data[2];
+  info->poeClass = data[2];
+  pinfo_set(info, pinfo_PoEAvail);
+
+  if (length >= 8) {
+    info->lldp.powerTypePrio = data[3];
+    info->lldp.powerRequested = (data[4] << 8) | data[5];
+    info->lldp.powerAllocated = (data[6] << 8) | data[7];
+    info->fields |= PINFO_FIELD(pinfo_PoEReq) | PINFO_FIELD(pinfo_PoEAlloc);
+  }
 #ifdef DEBUGSERIAL
-                      Serial.println("Power value: " + powerValueStr);
+  Serial.printf("MDI power: port class 0x%02x, pairs %u, class %u, requested %u.%uW, allocated %u.%uW\n",
+                info->lldp.powerPortClass, info->lldp.powerPairs, info->lldp.powerClass,
+                info->lldp.powerRequested / 10, info->lldp.powerRequested % 10, info->lldp.powerAllocated / 10, info->lldp.powerAllocated % 10);
 #endif
-                      break;
-                    }  // case 4: Extended Power-via-MDI
+  return true;
+}
 
-                  case 5:  // Inventory - Hardware Revision
-                    {
+// IEEE 802.3 Link Aggregation
+// 1 byte: Capability and status: bit 0 capable, bit 1 currently aggregated
+// 4 byte: Port identifier (aAggPortID)
+static bool lldp_orgLinkAgg(const byte data[], uint16_t /* length */, PINFO* info) {
+  info->lldp.linkAggStatus = data[0] & 0x03;
+  info->lldp.linkAggPortID = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
 #ifdef DEBUGSERIAL
-                      String tmpStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-                      Serial.println("Inventory - Hardware Revision: " + tmpStr);
+  Serial.printf("Link aggregation: status 0x%02x, port ID %lu\n", info->lldp.linkAggStatus, (unsigned long)info->lldp.linkAggPortID);
 #endif
-                      break;
-                    }  // case 5: Inventory - Hardware Revision
+  return true;
+}
 
-                  case 6:  // Inventory - Firmware Revision
-                    {
+// IEEE 802.3 Maximum Frame Size
+// 2 byte: 1518 basic, 1522 tagged, other sizes are implementation dependent
+static bool lldp_orgMaxFrame(const byte data[], uint16_t /* length */, PINFO* info) {
+  info->lldp.maxFrameSize = (data[0] << 8) | data[1];
+  pinfo_set(info, pinfo_MaxFrame);
 #ifdef DEBUGSERIAL
-                      String tmpStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-                      Serial.println("Inventory - Firmware Revision: " + tmpStr);
+  Serial.printf("Maximum frame size: %u\n", info->lldp.maxFrameSize);
 #endif
-                      break;
-                    }  // case 6: Inventory - Firmware Revision
+  return true;
+}
 
-                  case 7:  // Inventory - Software Revision
-                    {
+// IEEE 802.1 Port VLAN ID
+// 2 byte: VLAN ID
+static bool lldp_orgPVID(const byte data[], uint16_t /* length */, PINFO* info) {
+  info->vlan = (data[0] << 8) | data[1];
+  pinfo_set(info, pinfo_VLAN);
 #ifdef DEBUGSERIAL
-                      String tmpStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-                      Serial.println("Inventory - Software Revision: " + tmpStr);
+  Serial.printf("Port VLAN ID: %u\n", info->vlan);
 #endif
-                      break;
-                    }  // case 7: Inventory - Software Revision
+  return true;
+}
 
-                  case 8:  // Inventory - Serial Number
-                    {
+// IEEE 802.1 Port And Protocol VLAN ID
+// 1 byte: Flags, bit 1 supported, bit 2 enabled
+// 2 byte: VLAN ID
+static bool lldp_orgPPVID(const byte data[], uint16_t /* length */, PINFO* info) {
+  info->lldp.ppvidFlags = data[0];
+  info->lldp.ppvid = (data[1] << 8) | data[2];
 #ifdef DEBUGSERIAL
-                      String tmpStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-                      Serial.println("Inventory - Serial Number: " + tmpStr);
+  Serial.printf("Port and protocol VLAN ID: %u, flags 0x%02x\n", info->lldp.ppvid, info->lldp.ppvidFlags);
 #endif
-                      break;
-                    }  // case 8: Inventory - Serial Number
+  return true;
+}
 
-                  case 9:  // Inventory - Manufacturer Name
-                    {
-#ifdef DEBUGSERIAL
-                      String tmpStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-                      Serial.println("Inventory - Manufacturer Name: " + tmpStr);
-#endif
-                      break;
-                    }  // case 9: Inventory - Manufacturer Name
+// IEEE 802.1 VLAN Name
+// 2 byte: VLAN ID
+// 1 byte: Name length
+// n byte: Name
+static bool lldp_orgVlanName(const byte data[], uint16_t length, PINFO* info) {
+  uint16_t nameLength = data[2];
+  if ((3 + nameLength) > length)
+    nameLength = length - 3;
+  if (nameLength >= sizeof(info->lldp.vlanName))
+    nameLength = sizeof(info->lldp.vlanName) - 1;
 
-                  case 10:  // Inventory - Model Name
-                    {
-                      lldpinfo.Model[1] = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-                      ;
+  info->lldp.vlanNameID = (data[0] << 8) | data[1];
+  memcpy(info->lldp.vlanName, data + 3, nameLength);
+  info->lldp.vlanName[nameLength] = '\0';
 #ifdef DEBUGSERIAL
-                      Serial.println("Inventory - Model Name: " + lldpinfo.Model[1]);
+  Serial.printf("VLAN name: %u %s\n", info->lldp.vlanNameID, info->lldp.vlanName);
 #endif
-                      break;
-                    }  // case 10: Inventory - Model Name
+  return true;
+}
 
-                  case 11:  // Inventory - Asset ID
-                    {
-#ifdef DEBUGSERIAL
-                      String tmpStr = handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-                      Serial.println("Inventory - Asset ID: " + tmpStr);
-#endif
-                      break;
-                    }  // case 11: Inventory - Asset ID
-
-                  default:
-                    {
-                      break;
-                    }
-                }  // switch( OUIsubType )
-                break;
-              }  //case 0x0012bb: TIA TR-41 Committee - Media Endpoint Discovery (LLDP-MED, ANSI/TIA-1057)
-
-              // #######################################################
-
-            case 0x0080c2:  // IEEE 802.1
-              {
-                switch (OUIsubType) {
-                  // LLDP specification defines the following set of IEEE 802.1 Organizationally Specific TLVs reference(02-Dec-2011):
-                  // Port VLAN ID TLV (OUI = 00-80-c2, Subtype = 1): 2 byte
-                  // Port And Protocol VLAN ID TLV (OUI = 00-80-c2, Subtype = 2): 1 + 2 byte
-                  // VLAN Name TLV (OUI = 00-80-c2, Subtype = 3): 2 byte length + length bytes
-                  // Protocol Identity (OUI = 00-80-c2, Subtype = 4):
-                  // VID Usage Digest (OUI = 00-80-c2, Subtype = 5)
-                  // Management VID (OUI = 00-80-c2, Subtype = 6)
-                  // Link Aggregation (OUI = 00-80-c2, Subtype = 7)
-                  // Congestion Notification (OUI = 00-80-c2, Subtype = 8)
-                  // ETS Configuration TLV (OUI = 00-80-c2, Subtype = 9)
-                  // ETS Recommendation TLV (OUI = 00-80-c2, Subtype = A)
-                  // Priority-based Flow Control Configuration TLV (OUI = 00-80-c2, Subtype = B )
-                  // Application Priority TLV (OUI = 00-80-c2, Subtype = C)
-                  // EVB TLV (OUI = 00-80-c2, Subtype = D)
-                  // CDCP TLV (OUI = 00-80-c2, Subtype = E)
-                  // Port extension TLV (OUI = 00-80-c2, Subtype = F)
-                  case 1:  // Port VLAN ID TLV
-                    {
-#ifdef DEBUGSERIAL
-                      uint16_t vlanID = (lldpData[lldpDataIndex + 0] << 8) | lldpData[lldpDataIndex + 1];
-#endif
-                      lldpinfo.VLAN[1] = lldp_handleCdpNumField(lldpData, lldpDataIndex, 2);
+// IEEE 802.1 Protocol Identity
+// 1 byte: Length
+// n byte: First bytes of the protocol frame after the MAC addresses
+static bool lldp_orgProtocol(const byte data[], uint16_t length, PINFO* info) {
+  uint16_t idLength = data[0];
+  if ((idLength < 2) || ((1 + idLength) > length))
+    return false;
+
+  const byte* id = data + 1;
+  uint16_t typeOrLength = (id[0] << 8) | id[1];
+  if ((typeOrLength <= 1500) && (idLength >= 4) && (id[2] == 0x42) && (id[3] == 0x42))
+    info->lldp.protocols |= PINFO_PROTO_STP;  // 802.3 length, LLC DSAP/SSAP 0x42
+  else if (typeOrLength == 0x8809)
+    info->lldp.protocols |= PINFO_PROTO_LACP;
+  else if (typeOrLength == 0x888e)
+    info->lldp.protocols |= PINFO_PROTO_EAPOL;
+  else
+    info->lldp.protocols |= PINFO_PROTO_OTHER;
 #ifdef DEBUGSERIAL
-                      Serial.println("Port VLAN ID: " + String(vlanID) + "/" + lldpinfo.VLAN[1]);
+  Serial.printf("Protocol identity: 0x%04x, protocols 0x%02x\n", typeOrLength, info->lldp.protocols);
 #endif
-                      break;
-                    }  // case 1: Port VLAN ID TLV
+  return true;
+}
 
-                  case 2:  // Port And Protocol VLAN ID
-                    {
+// LLDP-MED Capabilities
+// 2 byte: Capabilities: bit 0 LLDP-MED, bit 1 network policy, bit 2 location, bit 3 extended
+//         power PSE, bit 4 extended power PD, bit 5 inventory
+// 1 byte: Class type: 0 not defined, 1-3 endpoint class I-III, 4 network connectivity
+static bool lldp_orgMedCap(const byte data[], uint16_t /* length */, PINFO* info) {
+  info->lldp.medCap = (data[0] << 8) | data[1];
+  info->lldp.medClass = data[2];
 #ifdef DEBUGSERIAL
-                      uint8_t port = lldpData[lldpDataIndex + 0];
-                      uint16_t protvlanID = (lldpData[lldpDataIndex + 1] << 8) | lldpData[lldpDataIndex + 2];
-                      Serial.println("Port: " + String(port));
-                      Serial.println("Protocol VLAN ID: " + String(protvlanID));
+  Serial.printf("LLDP-MED capabilities 0x%04x, class type %u\n", info->lldp.medCap, info->lldp.medClass);
 #endif
-                      break;
-                    }  // case 2: Port And Protocol VLAN ID
+  return true;
+}
 
-                  case 3:  // VLAN Name TLV (OUI = 00-80-c2, Subtype = 3): 2 byte length + length bytes
-                    {
-#ifdef DEBUGSERIAL
-                      uint16_t nameLength = (lldpData[lldpDataIndex + 0] << 8) | lldpData[lldpDataIndex + 1];
-                      Serial.println("VLAN name: " + handlelldpAsciiField(lldpData, 2, nameLength));
+// LLDP-MED Network Policy
+// 1 byte: Media application: 1 voice, 2 voice signaling, 3 guest voice, 4 guest voice signaling,
+//         5 softphone voice, 6 video conferencing, 7 streaming video, 8 video signaling
+// 3 byte: Flags
+//         0x800000 Unknown policy flag
+//         0x400000 Tagged flag
+//         0x1FFE00 VLAN ID
+//         0x0001C0 L2 priority
+//         0x00003F DSCP
+static bool lldp_orgPolicy(const byte data[], uint16_t /* length */, PINFO* info) {
+  uint32_t flags = ((uint32_t)data[1] << 16) | (data[2] << 8) | data[3];
+  bool tagged = (flags & 0x400000) != 0;
+  uint16_t vlanID = (flags & 0x1FFE00) >> 9;
+#ifdef DEBUGSERIAL
+  Serial.printf("Network policy: application %u, flags 0x%06lx, VLAN %u\n", data[0], (unsigned long)flags, vlanID);
+#endif
+
+  // Keep the voice policy if there are several
+  if (((info->lldp.fields & PINFO_FIELD(lldporg_Policy)) != 0) && (info->lldp.policyApp == 1) && (data[0] != 1))
+    return false;
+
+  info->lldp.policyApp = data[0];
+  info->lldp.policyFlags = (flags >> 22) & 0x03;
+  info->lldp.policyVLAN = vlanID;
+  info->lldp.policyPrio = (flags & 0x0001C0) >> 6;
+  info->lldp.policyDSCP = flags & 0x00003F;
+
+  if (tagged && (vlanID != 0)) {
+    info->voiceVLAN = vlanID;
+    pinfo_set(info, pinfo_VoiceVLAN);
+  }
+  return true;
+}  // bool lldp_orgPolicy()
+
+// LLDP-MED Location Identification
+// 1 byte: Location data format: 1 coordinate-based LCI, 2 civic address LCI, 3 ECS ELIN
+// Civic address LCI:
+// 1 byte: LCI length
+// 1 byte: What (address owner)
+// 2 byte: Country code
+// n byte: Civic address elements, each 1 byte type, 1 byte length, value
+static bool lldp_orgLocation(const byte data[], uint16_t length, PINFO* info) {
+  info->lldp.locationFormat = data[0];
+  info->lldp.locationCountry[0] = '\0';
+  if ((data[0] != 2) || (length < 5))
+    return true;
+
+  info->lldp.locationCountry[0] = data[3];
+  info->lldp.locationCountry[1] = data[4];
+  info->lldp.locationCountry[2] = '\0';
+
+#ifdef DEBUGSERIAL
+  uint16_t end = 2 + data[1];
+  if (end > length)
+    end = length;
+  Serial.printf("Location: owner %u, country %s\n", data[2], info->lldp.locationCountry);
+
+  uint16_t pos = 5;
+  while ((pos + 2) <= end) {
+    byte addressType = data[pos];
+    byte addressLen = data[pos + 1];
+    pos += 2;
+    if ((pos + addressLen) > end)
+      break;
+    Serial.println(handleAddressType(addressType) + pinfo_debugText(data + pos, addressLen));
+    pos += addressLen;
+  }
 #endif
-                      break;
-                    }  // case 3: VLAN Name TLV
+  return true;
+}  // bool lldp_orgLocation()
 
-                  default:
-                    {
+// LLDP-MED Extended Power-via-MDI
+// 1 byte: Power type (0xc0), power source (0x30), power priority (0x0f): 1 critical, 2 high, 3 low
+// 2 byte: Power value in 0.1 W steps
+static bool lldp_orgExtPower(const byte data[], uint16_t /* length */, PINFO* info) {
+  info->lldp.extPowerType = data[0];
+  info->lldp.extPowerValue = (data[1] << 8) | data[2];
 #ifdef DEBUGSERIAL
-                      Serial.println("\n\nLLDP custom type OUI:     " + String(OUI, HEX));
-                      Serial.println("LLDP custom type subtype: " + String(OUIsubType, HEX));
-                      Serial.println("LLDP custom data length:  " + String(lldpFieldLength, DEC));
-                      Serial.println("lldp custom field:");
-                      for (uint16_t i = 0; i < lldpFieldLength; i++) {
-                        String data = "00" + String(lldpData[lldpDataIndex + i], HEX);
-                        data = "0x" + data.substring(data.length() - 2);
-                        Serial.print(data + " ");
-                      }
-                      Serial.println("\n\n");
+  Serial.printf("Extended power: type 0x%02x, %u.%uW\n", info->lldp.extPowerType, info->lldp.extPowerValue / 10, info->lldp.extPowerValue % 10);
 #endif
-                      break;
-                    }
-                }  // switch( OUIsubType )
-                break;
-              }  // case 0x0080c2: IEEE 802.1
-
-              // #######################################################
-
-            case 0x30b216:
-              {
-                // The LLDP specification defines the following set of Hytec Organizationally Specific TLVs (Homepage: www.hytec.de, protocol documentation: HYTEC):
-                // Transceiver TLV (OUI = 30-B2-16, Subtype = 1)
-                // Trace TLV (OUI = 30-B2-16, Subtype = 2)
-                //#ifdef DEBUGSERIAL
-                //            Serial.println( "LLDP custom type OUI: 0x30b216" );
-                //#endif
-                break;
-              }  // case 0x30b216:
-
-            default:
-              {
-#ifdef DEBUGSERIAL
-                Serial.println("\n\nLLDP custom type OUI:     " + String(OUI, HEX));
-                Serial.println("LLDP custom type subtype: " + String(OUIsubType, HEX));
-                Serial.println("LLDP custom data length:  " + String(lldpFieldLength, DEC));
-                Serial.println("lldp custom field:");
-                for (uint16_t i = 0; i < lldpFieldLength; i++) {
-                  String data = "00" + String(lldpData[lldpDataIndex + i], HEX);
-                  data = "0x" + data.substring(data.length() - 2);
-                  Serial.print(data + " ");
-                }
-                Serial.println("\n\n");
-#endif
-                break;
-              }  // default
-          }      // switch( OUI )
-          break;
-        }  // case 0x007f: // Custom TLVs
-
-        // #######################################################
+  return true;
+}
 
-      default:
-        {
+// LLDP-MED Inventory, subtypes 5-11, the value is a text of up to 32 characters
+static bool lldp_orgInventory(const byte data[], uint16_t length, char* text) {
+  if (length >= PINFO_INVENTORYLEN)
+    length = PINFO_INVENTORYLEN - 1;
+  memcpy(text, data, length);
+  text[length] = '\0';
 #ifdef DEBUGSERIAL
-          Serial.println("LLDP unhandled type: 0x" + String(lldpFieldType, HEX));
-          Serial.println("LLDP field length:   " + String(lldpFieldLength, DEC));
+  Serial.println("Inventory: " + String(text));
 #endif
-          break;
-        }
-    }  // switch( lldpFieldType )
-    lldpDataIndex += lldpFieldLength;
-  }  // while( lldpDataIndex < plen )
-
-  return lldpinfo;
+  return true;
 }
 
-String handleLLDPIPField(const byte a[], unsigned int offset, unsigned int lengtha) {
-  int j = 0;
-  String temp;
-  for (unsigned int i = offset; i < (offset + lengtha); ++i, ++j) {
-    temp += String(a[i], DEC);
-    if (j < 3)
-      temp += ".";
-  }
-  temp += '\0';
-  return temp;
+static bool lldp_orgHwRev(const byte data[], uint16_t length, PINFO* info) {
+  return lldp_orgInventory(data, length, info->lldp.hwRev);
 }
 
-String handlelldpAsciiField(byte a[], unsigned int offset, unsigned int lengtha) {
-  int j = 0;
-  char temp[lengtha + 1];
-  for (unsigned int i = offset; i < (offset + lengtha); ++i, ++j)
-    temp[j] = a[i];
-
-  temp[lengtha] = '\0';
-  String temp1 = temp;
-  return temp1;
+static bool lldp_orgFwRev(const byte data[], uint16_t length, PINFO* info) {
+  return lldp_orgInventory(data, length, info->lldp.fwRev);
 }
 
-void handlelldpCapabilities(const byte a[], unsigned int offset, unsigned int lengtha) {
-  int j = 0;
-  String temp;
-
-  for (unsigned int i = offset; i < (offset + lengtha); ++i, ++j)
-    temp = temp + lldp_print_binary(a[i], 8);
-
-  lldpinfo.Cap[1] = LldpCapabilities(temp);
+static bool lldp_orgSwRev(const byte data[], uint16_t length, PINFO* info) {
+  return lldp_orgInventory(data, length, info->lldp.swRev);
 }
 
-String lldp_print_binary(int v, int num_places) {
-  String output;
-  int mask = 0, n;
-  for (n = 1; n <= num_places; n++)
-    mask = (mask << 1) | 0x0001;
-  v = v & mask;  // truncate v to specified number of places
-
-  while (num_places) {
-    if (v & ((0x0001 << num_places) - 1))
-      output = output + "1";
-    else
-      output = output + "0";
-
-    --num_places;
-  }
-  return output;
+static bool lldp_orgSerial(const byte data[], uint16_t length, PINFO* info) {
+  return lldp_orgInventory(data, length, info->lldp.serial);
 }
 
-String LldpCapabilities(String temp) {
-  // Capabilities
-  // OTHER     0x0001 = 0b0000 0000 0000 0001
-  // REPEATER  0x0002 = 0b0000 0000 0000 0010
-  // BRIDGE    0x0004 = 0b0000 0000 0000 0100
-  // WLAN      0x0008 = 0b0000 0000 0000 1000
-  // ROUTER    0x0010 = 0b0000 0000 0001 0000
-  // TELEPHONE 0x0020 = 0b0000 0000 0010 0000
-  // DOCSIS    0x0040 = 0b0000 0000 0100 0000
-  // STATION   0x0080 = 0b0000 0000 1000 0000
-  // CVLAN     0x0100 = 0b0000 0001 0000 0000
-  // SVLAN     0x0200 = 0b0000 0010 0000 0000
-  // TPMR      0x0400 = 0b0000 0100 0000 0000
-
-  String output;
-  if (temp.substring(15, 16) == "1")
-    output = output + "Other ";
-  if (temp.substring(14, 15) == "1")
-    output = output + "Repeater ";
-  if (temp.substring(13, 14) == "1")
-    output = output + "Bridge ";
-  if (temp.substring(12, 13) == "1")
-    output = output + "WLAN ";
-  if (temp.substring(11, 12) == "1")
-    output = output + "Router ";
-  if (temp.substring(10, 11) == "1")
-    output = output + "Telephone ";
-  if (temp.substring(9, 10) == "1")
-    output = output + "DOCSIS ";
-  if (temp.substring(8, 9) == "1")
-    output = output + "Station ";
-  if (temp.substring(7, 8) == "1")
-    output = output + "CVLAN ";
-  if (temp.substring(6, 7) == "1")
-    output = output + "SVLAN ";
-  if (temp.substring(5, 6) == "1")
-    output = output + "TMPR ";
-  return output;
+static bool lldp_orgManufacturer(const byte data[], uint16_t length, PINFO* info) {
+  return lldp_orgInventory(data, length, info->lldp.manufacturer);
 }
 
-String lldp_print_mac(const byte a[], unsigned int offset, unsigned int length) {
-  String Mac;
-  for (unsigned int i = offset; i < offset + length; ++i) {
-    if (a[i] < 0x10)
-      Mac = Mac + '0';
-
-    Mac = Mac + String(a[i], HEX);
-  }
-
-  return Mac;
+// The model name is shown instead of the system description
+static bool lldp_orgModel(const byte data[], uint16_t length, PINFO* info) {
+  pinfo_setText(info, pinfo_Model, data, length);
+#ifdef DEBUGSERIAL
+  Serial.println("Inventory - Model Name: " + String(info->model));
+#endif
+  return true;
 }
 
-String lldp_handleCdpNumField(const byte a[], unsigned int offset, unsigned int length) {
-  String temp;
-  unsigned long num = 0;
-  for (unsigned int i = 0; i < length; ++i) {
-    num <<= 8;
-    num += a[offset + i];
-  }
-  temp = "" + String(num, DEC);
-  return temp;
+static bool lldp_orgAssetID(const byte data[], uint16_t length, PINFO* info) {
+  return lldp_orgInventory(data, length, info->lldp.assetID);
 }
 
-String handleChassisSubtype(byte lldpData[], unsigned int lldpDataIndex, unsigned int lldpFieldLength) {
-  lldpFieldLength = lldpFieldLength - 1;
-  unsigned int charTemp = lldpData[lldpDataIndex];
-  lldpDataIndex++;
-
-  switch (charTemp) {
-    case 0x0000:
-      return "Reserved";
-      break;
-
-    case 0x0001:
-      return "Chassis component";
-      break;
-
-    case 0x0002:
-      return "Interface alias";
-      break;
-
-    case 0x0003:
-      return "Port component";
-      break;
-
-    case 0x0004:
-      return "MAC address";
-      break;
-
-    case 0x0005:
-      return "Network address";
-      break;
-
-    case 0x0006:
-      return "Interface name";
-      break;
-
-    case 0x0007:
-      return "Locally assigned";
-      break;
+// Decoder of an organizationally specific TLV
+struct LLDP_ORGDECODER {
+  uint32_t key;        // OUI << 8 | subtype
+  uint8_t minLength;   // Minimum length of the information string
+  uint8_t field;       // eLldpOrgField
+  bool (*decode)(const byte data[], uint16_t length, PINFO* info);
+};
+
+#define LLDP_ORGKEY(oui, subtype) (((uint32_t)(oui) << 8) | (subtype))
+
+// Sorted by key for the binary search in lldp_findOrgDecoder()
+static constexpr LLDP_ORGDECODER LLDP_ORGDECODERS[] = {
+  { LLDP_ORGKEY(0x00120f, 1), 5, lldporg_MacPhy, lldp_orgMacPhy },
+  { LLDP_ORGKEY(0x00120f, 2), 3, lldporg_Power, lldp_orgPower },
+  { LLDP_ORGKEY(0x00120f, 3), 5, lldporg_LinkAgg, lldp_orgLinkAgg },
+  { LLDP_ORGKEY(0x00120f, 4), 2, lldporg_MaxFrame, lldp_orgMaxFrame },
+  { LLDP_ORGKEY(0x0012bb, 1), 3, lldporg_MedCap, lldp_orgMedCap },
+  { LLDP_ORGKEY(0x0012bb, 2), 4, lldporg_Policy, lldp_orgPolicy },
+  { LLDP_ORGKEY(0x0012bb, 3), 1, lldporg_Location, lldp_orgLocation },
+  { LLDP_ORGKEY(0x0012bb, 4), 3, lldporg_ExtPower, lldp_orgExtPower },
+  { LLDP_ORGKEY(0x0012bb, 5), 0, lldporg_Inventory, lldp_orgHwRev },
+  { LLDP_ORGKEY(0x0012bb, 6), 0, lldporg_Inventory, lldp_orgFwRev },
+  { LLDP_ORGKEY(0x0012bb, 7), 0, lldporg_Inventory, lldp_orgSwRev },
+  { LLDP_ORGKEY(0x0012bb, 8), 0, lldporg_Inventory, lldp_orgSerial },
+  { LLDP_ORGKEY(0x0012bb, 9), 0, lldporg_Inventory, lldp_orgManufacturer },
+  { LLDP_ORGKEY(0x0012bb, 10), 0, lldporg_Inventory, lldp_orgModel },
+  { LLDP_ORGKEY(0x0012bb, 11), 0, lldporg_Inventory, lldp_orgAssetID },
+  { LLDP_ORGKEY(0x0080c2, 1), 2, lldporg_PVID, lldp_orgPVID },
+  { LLDP_ORGKEY(0x0080c2, 2), 3, lldporg_PPVID, lldp_orgPPVID },
+  { LLDP_ORGKEY(0x0080c2, 3), 3, lldporg_VlanName, lldp_orgVlanName },
+  { LLDP_ORGKEY(0x0080c2, 4), 1, lldporg_Protocol, lldp_orgProtocol },
+};
+
+static const uint8_t LLDP_ORGDECODERCOUNT = sizeof(LLDP_ORGDECODERS) / sizeof(LLDP_ORGDECODERS[0]);
+
+static constexpr bool lldp_orgDecodersSorted(uint8_t i) {
+  return ((i + 1) >= LLDP_ORGDECODERCOUNT) || ((LLDP_ORGDECODERS[i].key < LLDP_ORGDECODERS[i + 1].key) && lldp_orgDecodersSorted(i + 1));
+}
+static_assert(lldp_orgDecodersSorted(0), "LLDP_ORGDECODERS must be sorted by key");
+
+// Binary search of the decoder, NULL if the TLV is not decoded
+static const LLDP_ORGDECODER* lldp_findOrgDecoder(uint32_t oui, uint8_t subtype) {
+  uint32_t key = LLDP_ORGKEY(oui, subtype);
+  uint8_t low = 0;
+  uint8_t high = LLDP_ORGDECODERCOUNT;
+  while (low < high) {
+    uint8_t mid = (low + high) / 2;
+    if (LLDP_ORGDECODERS[mid].key == key)
+      return &LLDP_ORGDECODERS[mid];
+    if (LLDP_ORGDECODERS[mid].key < key)
+      low = mid + 1;
+    else
+      high = mid;
   }
-  return " ";
+  return NULL;
 }
 
-String handlePortSubtype(byte lldpData[], unsigned int lldpDataIndex, unsigned int lldpFieldLength) {
-  lldpFieldLength = lldpFieldLength - 1;
-  unsigned int charTemp = lldpData[lldpDataIndex];
-  lldpDataIndex++;
-
-  /*
-        https://docs.zephyrproject.org/latest/reference/kconfig/CONFIG_NET_LLDP_PORT_ID_SUBTYPE.html
-        Subtype 1 = Interface alias
-        Subtype 2 = Port component
-        Subtype 3 = MAC address
-        Subtype 4 = Network address
-        Subtype 5 = Interface name
-        Subtype 6 = Agent circuit ID
-        Subtype 7 = Locally assigned
-  */
-  switch (charTemp) {
-    case 0x0001:
-      // ASCII
-      return handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-      break;
-
-    case 0x0002:
-      // ASCII
-      return handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-      break;
-
-    case 0x0003:
-      // MAC Address
-      return lldp_print_mac(lldpData, lldpDataIndex, lldpFieldLength);
-      break;
-
-    case 0x0004:
-      // IP Address
-      return handleLLDPIPField(lldpData, lldpDataIndex, lldpFieldLength);
-      break;
-
-    case 0x0005:
-      // ASCII
-      return handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-      break;
+// Decode an organizationally specific TLV with the matching decoder of LLDP_ORGDECODERS
+void lldp_customTLV(const LLDP_TLV* tlv, PINFO* info) {
+  const LLDP_ORGDECODER* decoder = lldp_findOrgDecoder(tlv->oui, tlv->subtype);
+  if ((decoder == NULL) || (tlv->dataLength < decoder->minLength)) {
+#ifdef DEBUGSERIAL
+    lldp_dumpTLV(tlv);
+#endif
+    return;
+  }
 
-    case 0x0006:
-      // ??
-      break;
+  if (decoder->decode(tlv->data, tlv->dataLength, info))
+    info->lldp.fields |= PINFO_FIELD(decoder->field);
+}  // void lldp_customTLV()
 
-    case 0x0007:
-      // ASCII ??
-      return handlelldpAsciiField(lldpData, lldpDataIndex, lldpFieldLength);
-      break;
+#ifdef DEBUGSERIAL
+// Print OUI, subtype and data of a custom TLV
+void lldp_dumpTLV(const LLDP_TLV* tlv) {
+  Serial.printf("\n\nLLDP custom type OUI:     %06lx\n", (unsigned long)tlv->oui);
+  Serial.printf("LLDP custom type subtype: %x\n", tlv->subtype);
+  Serial.printf("LLDP custom data length:  %u\n", tlv->dataLength);
+  Serial.println("lldp custom field:");
+  for (uint16_t i = 0; i < tlv->dataLength; i++) {
+    Serial.printf("0x%02x ", tlv->data[i]);
   }
-  return " ";
+  Serial.println("\n\n");
 }
+#endif
 
-String handleManagementSubtype(byte lldpData[], unsigned int lldpDataIndex, unsigned int lldpFieldLength) {
-  unsigned int SubtypeLength = lldpData[lldpDataIndex] - 1;
-  lldpDataIndex++;
-  unsigned int charTemp = lldpData[lldpDataIndex];
-  lldpDataIndex++;
-  /*
-     https://github.com/boundary/wireshark/blob/master/epan/dissectors/packet-lldp.c
-        Subtype 1 = IPv4
-        Subtype 2 = IPv6
-        Subtype [Other] = MAC
-  */
-  switch (charTemp) {
-    case 0x0001:
-      // IPv4
-      return handleLLDPIPField(lldpData, lldpDataIndex, SubtypeLength);
-      break;
-
-    case 0x0002:
-      // IPv6
-      //return handleLLDPIPv6Field( lldpData, lldpDataIndex, SubtypeLength );
-      break;
-
-    default:
-      // MAC
-      return lldp_print_mac(lldpData, lldpDataIndex, SubtypeLength);
-      break;
+// Network address: 1 byte IANA address family, followed by the address.
+// IPv4 addresses are printed in dotted notation, IPv6 addresses as in RFC 5952 and all
+// other families are printed as hex string. Returns false if the field was not changed.
+bool lldp_addressField(PINFO* info, ePinfoField field, const byte value[], uint16_t length) {
+  if (length < 2)
+    return false;
+
+  switch (value[0]) {
+    case 1:  // IPv4
+      {
+        if (length != 5)
+          return false;
+        pinfo_setIPv4(info, field, value + 1);
+        return true;
+      }
+
+    case 2:  // IPv6
+      {
+        if (length != 17)
+          return false;
+        pinfo_setIPv6(info, field, value + 1);
+        return true;
+      }
+
+    default:  // MAC and others
+      pinfo_setHex(info, field, value + 1, length - 1);
+      return true;
   }
-  return " ";
 }
 
 String handleAddressType(byte addressType) {
@@ -1207,56 +729,215 @@ String handleAddressType(byte addressType) {
   return address;
 }
 
-// Send a currently very static LLDP-MED packet to the LLDP broadcast address to. This should
-// trigger the switch / router to send itself a LLDP-MED packet.
-void send_LLDP_MED(uint16_t buffersize, uint16_t voiceVLAN, unsigned long* lastLLDPsent, byte mymac[]) {
-  // LLDP-MED packet
-  const byte packet_LLDP_MED[] = {
-    0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e,                                                  // [  6] 6 byte LLDP broadcast address
-    0xca, 0xfe, 0xc0, 0xff, 0xee, 0x00,                                                  // [ 12] 6 byte own MAC address
-    0x88, 0xcc,                                                                          // [ 14] 2 byte Ethernet Frame type
-    0x02, 0x06, 0x05, 0x01, 0x00, 0x00, 0x00, 0x00,                                      // [ 22] 7 bit type=1 (Chassis ID), 9 bit len=6, subtype 5, Value 0x0100000000
-    0x04, 0x07, 0x03, 0xca, 0xfe, 0xc0, 0xff, 0xee, 0x00,                                // [ 31] 7 bit type=2 (Port), 9 bit len=7, 1 byte port type=MAC, 6 byte own MAC
-    0x06, 0x02, 0x00, 0xb4,                                                              // [ 35] 7 bit type=3 (TTL), 9 bit len=2, TTL=0x00b4=180s
-    0x0a, 0x05, 0x44, 0x41, 0x4D, 0x50, 0x46,                                            // [ 42] 7 bit type=5 (Device name), 9 bit len=5, "DAMPF"
-    0x0c, 0x05, 0x44, 0x41, 0x4D, 0x50, 0x46,                                            // [ 49] 7 bit type=6 (Model name), 9 bit len=5, "DAMPF"
-    0x0e, 0x04, 0x00, 0x20, 0x00, 0x20,                                                  // [ 55] 7 bit type=7 (System Capabilities), 9 bit len=4, 0x0020=Phone 0x0020=Phone
-    0x08, 0x08, 0x57, 0x41, 0x4e, 0x20, 0x50, 0x4f, 0x52, 0x54,                          // [ 65] 7 bit type=4 (Port Description),  9 bit len=8, "WAN PORT"
-    0xfe, 0x09, 0x00, 0x12, 0x0f, 0x01, 0x03, 0x6c, 0x00, 0x00, 0x10,                    // [ 76] 7 bit type=127, 9 bit len=9, OUI=0x00120f, subtype=1 (MAC/PHY), AutoNeg en/sup, 0x6c00=phy, 0x0010 MAU
-    0xfe, 0x0c, 0x00, 0x12, 0x0f, 0x02, 0x00, 0x02, 0x03, 0xf3, 0x00, 0x32, 0x00, 0x00,  // ...[ 90] 7 bit type=127, 9 bit len=7, OUI=0x00120f, subtype=2 (MDI Power Support), 0x00:MDI Power support:PD Device, 0x02:Spare pairs, 0x03:Power Class 2, 0x74:Type/Source/Prio, 0x0032: PD 5.0W
-    0xfe, 0x07, 0x00, 0x12, 0xbb, 0x01, 0x00, 0x33, 0x03,                                // [ 99] 7 bit type=127, 9 bit len=7, OUI=0x0012bb, subtype=1 (LLDP-MED Capabilities), 0x0033 (LLPD-MED Capabilities,Network policy,Extended Power via MDI-PD,Inventory), 0x03 Endpoint Class III
-    0xfe, 0x08, 0x00, 0x12, 0xbb, 0x02, 0x01, 0x80, 0x00, 0x00,                          // [109] 7 bit type=127, 9 bit len=8, OUI=0x0012bb, subtype=2 (Network Policy), App 1=Voice, 0x8000, 0x00=Media policy flag
-    0xfe, 0x07, 0x00, 0x12, 0xbb, 0x04, 0x52, 0x00, 0x32,                                // [118] 7 bit type=127, 9 bit len=7, OUI=0x0012bb, subtype=4 (Extended Power-via-MDI), 0x52 (Powered Device,Primary Power Source,Power Prio High), 0x0026=3,8W request
-    0xfe, 0x07, 0x00, 0x12, 0xbb, 0x05, 0x31, 0x2e, 0x30,                                // [127] 7 bit type=127, 9 bit len=7, OUI=0x0012bb, subtype=5 (Inventory - Hardware Revision), "1.0"
-    0xfe, 0x07, 0x00, 0x12, 0xbb, 0x06, 0x31, 0x2e, 0x36,                                // [136] 7 bit type=127, 9 bit len=7, OUI=0x0012bb, subtype=6 (Inventory - Firmware Revision), "1.6"
-    0xfe, 0x07, 0x00, 0x12, 0xbb, 0x07, 0x31, 0x2e, 0x36,                                // [145] 7 bit type=127, 9 bit len=7, OUI=0x0012bb, subtype=7 (Inventory - Software Revision), "1.6"
-    0xfe, 0x10, 0x00, 0x12, 0xbb, 0x08,                                                  // [151] 7 bit type=127, 9 bit len=16, OUI=0x0012bb, subtype=8 (Inventory - Serial Number)
-    0x63, 0x61, 0x66, 0x65, 0x63, 0x30, 0x66, 0x66, 0x65, 0x65, 0x30, 0x30,              // [163] "cafec0ffee00"
-    0xfe, 0x07, 0x00, 0x12, 0xbb, 0x09, 0x44, 0x49, 0x59,                                // [172] 7 bit type=127, 9 bit len=7, OUI=0x0012bb, subtype=9 (Inventory - Manufacturer Name), "DIY"
-    0xfe, 0x09, 0x00, 0x12, 0xbb, 0x0a, 0x44, 0x41, 0x4d, 0x50, 0x46,                    // [182] 7 bit type=127, 9 bit len=9, OUI=0x0012bb, subtype=10 (Inventory - Model Name), "DAMPF"
-  };
-
-  // Check size of data structure and copy packet to send buffer.
-  uint16_t len = sizeof(packet_LLDP_MED);
-  if (len < buffersize) {
-    memset(Ethernet::buffer, 0, buffersize);
-    memcpy_P(Ethernet::buffer, packet_LLDP_MED, len);
+// Cached own LLDP-MED frame, see lldp_buildFrame()
+static byte lldp_txFrame[LLDP_TXMAXLEN];
+static uint16_t lldp_txLength = 0;
+
+// OUIs of the organizationally specific TLVs
+static const uint32_t LLDP_OUI_8023 = 0x00120f;
+static const uint32_t LLDP_OUI_MED = 0x0012bb;
+
+// TLV header: 7 bit type, 9 bit length
+static constexpr uint16_t lldp_tlvHeader(uint8_t type, uint16_t length) {
+  return ((uint16_t)type << 9) | (length & 0x01ff);
+}
+static_assert(lldp_tlvHeader(LLDP_TLV_TTL, 2) == 0x0602, "TLV header encoding");
+
+// Frame under construction, overflow is set if a TLV did not fit
+struct LLDP_BUILDER {
+  byte* frame;
+  uint16_t length;
+  bool overflow;
+};
+
+// Append a TLV header and return the position of its value, NULL if the TLV does not fit
+static byte* lldp_putTLV(LLDP_BUILDER* builder, uint8_t type, uint16_t length) {
+  if ((length > 511) || ((builder->length + 2 + length) > LLDP_TXMAXLEN)) {
+    builder->overflow = true;
+    return NULL;
   }
+  uint16_t header = lldp_tlvHeader(type, length);
+  byte* tlv = builder->frame + builder->length;
+  tlv[0] = header >> 8;
+  tlv[1] = header & 0xff;
+  builder->length += 2 + length;
+  return tlv + 2;
+}
+
+// TLV with a length known at compile time
+template<uint8_t TYPE, uint16_t LENGTH>
+static byte* lldp_putTLV(LLDP_BUILDER* builder) {
+  static_assert(LENGTH <= 511, "LLDP TLV value too long");
+  return lldp_putTLV(builder, TYPE, LENGTH);
+}
+
+// Organizationally specific TLV, returns the position of the information string
+template<uint32_t OUI, uint8_t SUBTYPE, uint16_t LENGTH>
+static byte* lldp_putOrgTLV(LLDP_BUILDER* builder) {
+  static_assert(LENGTH <= 507, "LLDP custom TLV information string too long");
+  byte* value = lldp_putTLV<LLDP_TLV_CUSTOM, LENGTH + 4>(builder);
+  if (value == NULL)
+    return NULL;
+  value[0] = (OUI >> 16) & 0xff;
+  value[1] = (OUI >> 8) & 0xff;
+  value[2] = OUI & 0xff;
+  value[3] = SUBTYPE;
+  return value + 4;
+}
+
+// TLV with a text
+static void lldp_putText(LLDP_BUILDER* builder, uint8_t type, const char* text) {
+  uint16_t length = strlen(text);
+  byte* value = lldp_putTLV(builder, type, length);
+  if (value != NULL)
+    memcpy(value, text, length);
+}
+
+// LLDP-MED inventory TLV, the text is limited to 32 characters
+static void lldp_putInventory(LLDP_BUILDER* builder, uint8_t subtype, const char* text) {
+  uint16_t length = strlen(text);
+  if (length > 32)
+    length = 32;
+  byte* value = lldp_putTLV(builder, LLDP_TLV_CUSTOM, length + 4);
+  if (value == NULL)
+    return;
+  value[0] = (LLDP_OUI_MED >> 16) & 0xff;
+  value[1] = (LLDP_OUI_MED >> 8) & 0xff;
+  value[2] = LLDP_OUI_MED & 0xff;
+  value[3] = subtype;
+  memcpy(value + 4, text, length);
+}
+
+// Build the own LLDP-MED frame from the MAC address, the device name and the configuration.
+// The frame is cached and sent by send_LLDP_MED(), call this again if one of the values changes.
+// Returns false if the frame does not fit into LLDP_TXMAXLEN, nothing will be sent in this case.
+bool lldp_buildFrame(const byte mac[], const char* deviceName, const LLDP_TXCONFIG* config) {
+  LLDP_BUILDER builder = { lldp_txFrame, 0, false };
+  byte* value;
+
+  // Destination, source and Ethernet type
+  memcpy(lldp_txFrame, lldp_mac, 6);
+  memcpy(lldp_txFrame + 6, mac, 6);
+  lldp_txFrame[12] = 0x88;
+  lldp_txFrame[13] = 0xcc;
+  builder.length = LLDP_HEADER_LEN;
+
+  // Chassis ID: subtype network address, IPv4 0.0.0.0. Port ID: subtype MAC address
+  if ((value = lldp_putTLV<LLDP_TLV_CHASSIS, 6>(&builder)) != NULL) {
+    value[0] = 5;
+    value[1] = 1;
+    memset(value + 2, 0, 4);
+  }
+  if ((value = lldp_putTLV<LLDP_TLV_PORT, 7>(&builder)) != NULL) {
+    value[0] = 3;
+    memcpy(value + 1, mac, 6);
+  }
+  if ((value = lldp_putTLV<LLDP_TLV_TTL, 2>(&builder)) != NULL) {
+    value[0] = config->ttl >> 8;
+    value[1] = config->ttl & 0xff;
+  }
+
+  lldp_putText(&builder, LLDP_TLV_SYSNAME, deviceName);
+  lldp_putText(&builder, LLDP_TLV_SYSDESC, config->model);
+
+  // System capabilities and enabled capabilities: telephone
+  if ((value = lldp_putTLV<LLDP_TLV_CAPABILITIES, 4>(&builder)) != NULL) {
+    value[0] = 0x00;
+    value[1] = 0x20;
+    value[2] = 0x00;
+    value[3] = 0x20;
+  }
+  lldp_putText(&builder, LLDP_TLV_PORTDESC, config->portDesc);
+
+  // IEEE 802.3 MAC/PHY: auto negotiation supported and enabled, 10/100 half/full duplex, MAU 10BASE-T full duplex
+  if ((value = lldp_putOrgTLV<LLDP_OUI_8023, 1, 5>(&builder)) != NULL) {
+    value[0] = 0x03;
+    value[1] = 0x6c;
+    value[2] = 0x00;
+    value[3] = 0x00;
+    value[4] = 0x10;
+  }
+
+  // IEEE 802.3 MDI power: PD, spare pairs, power class, type/source/priority 0xf3 and requested power
+  if ((value = lldp_putOrgTLV<LLDP_OUI_8023, 2, 8>(&builder)) != NULL) {
+    value[0] = 0x00;
+    value[1] = 0x02;
+    value[2] = config->powerClass;
+    value[3] = 0xf3;
+    value[4] = config->powerRequest >> 8;
+    value[5] = config->powerRequest & 0xff;
+    value[6] = 0x00;
+    value[7] = 0x00;
+  }
+
+  // LLDP-MED capabilities and device class
+  if ((value = lldp_putOrgTLV<LLDP_OUI_MED, 1, 3>(&builder)) != NULL) {
+    value[0] = config->medCap >> 8;
+    value[1] = config->medCap & 0xff;
+    value[2] = config->medClass;
+  }
+
+  // LLDP-MED network policy: unknown policy flag, the switch is asked for its policy
+  if ((value = lldp_putOrgTLV<LLDP_OUI_MED, 2, 4>(&builder)) != NULL) {
+    value[0] = config->policyApp;
+    value[1] = 0x80;
+    value[2] = 0x00;
+    value[3] = 0x00;
+  }
+
+  // LLDP-MED extended power: PD, powered by PSE, priority and requested power
+  if ((value = lldp_putOrgTLV<LLDP_OUI_MED, 4, 3>(&builder)) != NULL) {
+    value[0] = 0x50 | (config->powerPriority & 0x0f);
+    value[1] = config->powerRequest >> 8;
+    value[2] = config->powerRequest & 0xff;
+  }
+
+  // LLDP-MED inventory, the serial number is the MAC address
+  char serial[FMT_MACLEN];
+  fmt_mac(serial, sizeof(serial), mac, '\0');
+  lldp_putInventory(&builder, 5, config->hwRev);
+  lldp_putInventory(&builder, 6, config->fwRev);
+  lldp_putInventory(&builder, 7, config->swRev);
+  lldp_putInventory(&builder, 8, serial);
+  lldp_putInventory(&builder, 9, config->manufacturer);
+  lldp_putInventory(&builder, 10, config->model);
+
+  lldp_putTLV<LLDP_TLV_END, 0>(&builder);
+
+  lldp_txLength = builder.overflow ? 0 : builder.length;
+#ifdef DEBUGSERIAL
+  Serial.printf("lldp_buildFrame(): %u bytes%s\n", builder.length, builder.overflow ? ", too long" : "");
+#endif
+  return !builder.overflow;
+}  // bool lldp_buildFrame()
+
+// Send the cached LLDP-MED frame to the LLDP broadcast address. This should trigger the
+// switch / router to send itself a LLDP-MED packet. The frame is always sent untagged,
+// voiceVLAN is needed to restore the tagging afterwards.
+void send_LLDP_MED(uint16_t voiceVLAN, unsigned long* lastLLDPsent) {
+  if (lldp_txLength == 0)
+    return;
+
+  uint16_t len = lldp_txLength;
+  memcpy(Ethernet::buffer, lldp_txFrame, len);
 
 #ifdef DEBUGSENDLLDP
-  // Copy Ethernet buffer to input buffer and check if the LLDP data is valid
-  uint16_t plen = buffersize;
-  memcpy(eth_buffcheck, Ethernet::buffer, plen);
+  // Decode the own frame in place and check if the LLDP data is valid
+  uint16_t plen = len;
 #ifdef DEBUGSERIAL
   Serial.println("Check DAMF-lldp():");
 #endif
 
-  unsigned int lldp_correct = lldp_check_Packet(eth_buffcheck, plen);
-  if (lldp_correct > 1) {
+  FRAME_INFO frameInfo;
+  if (frame_classify(lldp_txFrame, plen, &frameInfo) == frame_LLDP) {
 #ifdef DEBUGSERIAL
-    Serial.println("lldp_correct=" + String(lldp_correct));
+    Serial.println("LLDP frame recognized");
 #endif
-    eth_lldpPacket = lldp_packet_handler(eth_buffcheck, plen);
+    uint16_t ttl;
+    PINFO neighbor;
+    pinfo_reset(&neighbor);
+    lldp_packet_handler(lldp_txFrame, plen, &neighbor);
+    neighbor_update(&neighbor, lldp_digest(lldp_txFrame, plen, &ttl), millis());
   }
 #endif
 
@@ -1271,7 +952,4 @@ void send_LLDP_MED(uint16_t buffersize, uint16_t voiceVLAN, unsigned long* lastL
   }
 
   *lastLLDPsent = millis();
-
-  // Clear buffer
-  memset(Ethernet::buffer, 0, buffersize);
-}
+}  // void send_LLDP_MED()
@@ -12,26 +12,71 @@ https://www.ieee802.org/3/frame_study/0409/blatherwick_1_0409.pdf
 #include <EtherCard.h>
 #include <Arduino.h>
 #include "Packet_data.h"
+#include "frame_functions.h"
 
 #ifndef LLDP_FUNCTIONS_H
 #define LLDP_FUNCTIONS_H
 
-unsigned int lldp_check_Packet(byte EthBuffer[], unsigned int length);
-PINFO lldp_packet_handler(byte cdpData[], uint16_t plen);
-String handleLLDPIPField(const byte a[], unsigned int offset, unsigned int lengtha);
-String handlelldpAsciiField(byte a[], unsigned int offset, unsigned int lengtha);
-void handlelldpCapabilities(const byte a[], unsigned int offset, unsigned int lengtha);
-String lldp_print_binary(int v, int num_places);
-String LldpCapabilities(String temp);
-String lldp_print_mac(const byte a[], unsigned int offset, unsigned int length);
-bool lldp_byte_array_contains(const byte a[], unsigned int offset, const byte b[], unsigned int length);
-String lldp_handleCdpNumField(const byte a[], unsigned int offset, unsigned int length);
-
-String handleChassisSubtype(byte cdpData[], unsigned int cdpDataIndex, unsigned int lldpFieldLength);
-String handlePortSubtype(byte cdpData[], unsigned int cdpDataIndex, unsigned int lldpFieldLength);
-String handleManagementSubtype(byte cdpData[], unsigned int cdpDataIndex, unsigned int lldpFieldLength);
+// First TLV of a LLDPDU, directly after destination MAC, source MAC and Ethernet type
+static const uint16_t LLDP_HEADER_LEN = 14;
+
+// TLV types
+static const uint8_t LLDP_TLV_END = 0;
+static const uint8_t LLDP_TLV_CHASSIS = 1;
+static const uint8_t LLDP_TLV_PORT = 2;
+static const uint8_t LLDP_TLV_TTL = 3;
+static const uint8_t LLDP_TLV_PORTDESC = 4;
+static const uint8_t LLDP_TLV_SYSNAME = 5;
+static const uint8_t LLDP_TLV_SYSDESC = 6;
+static const uint8_t LLDP_TLV_CAPABILITIES = 7;
+static const uint8_t LLDP_TLV_MGMTADDR = 8;
+static const uint8_t LLDP_TLV_CUSTOM = 127;
+
+// View of a single TLV inside the received frame. Nothing is copied, the pointers
+// point into the buffer given to lldp_nextTLV() and are valid as long as it is not changed.
+struct LLDP_TLV {
+  uint8_t type;         // 7 bit TLV type
+  uint16_t length;      // 9 bit length of the value
+  const byte* value;    // Information string of the TLV
+  uint32_t oui;         // Organizationally Unique Identifier, custom TLVs only
+  uint8_t subtype;      // Organizationally defined subtype, custom TLVs only
+  const byte* data;     // Custom TLVs: information after OUI and subtype, otherwise same as value
+  uint16_t dataLength;  // Length of data
+};
+
+bool lldp_nextTLV(const byte lldpData[], uint16_t plen, uint16_t* index, LLDP_TLV* tlv);
+eFrameCheck lldp_validate(const byte lldpData[], uint16_t plen);
+uint32_t lldp_digest(const byte lldpData[], uint16_t plen, uint16_t* ttl);
+void lldp_packet_handler(const byte lldpData[], uint16_t plen, PINFO* info);
+void lldp_customTLV(const LLDP_TLV* tlv, PINFO* info);
+void lldp_dumpTLV(const LLDP_TLV* tlv);
+
+bool lldp_addressField(PINFO* info, ePinfoField field, const byte value[], uint16_t length);
 String handleAddressType(byte addressType);
 
-void send_LLDP_MED(uint16_t buffersize, uint16_t voiceVLAN, unsigned long* lastLLDPsent, byte mymac[]);
+// Own LLDP-MED frame
+// The frame is built once by lldp_buildFrame() and cached, send_LLDP_MED() only copies it
+// into the Ethernet buffer.
+static const uint16_t LLDP_TXMAXLEN = 384;
+
+// Content of the own LLDP-MED frame
+struct LLDP_TXCONFIG {
+  uint16_t ttl;            // Time to live in seconds
+  const char* portDesc;    // Port description
+  const char* model;       // System description and inventory model name
+  uint16_t medCap;         // LLDP-MED capabilities: bit 0 LLDP-MED, 1 network policy, 4 extended power PD, 5 inventory
+  uint8_t medClass;        // LLDP-MED device class: 1-3 endpoint class I-III
+  uint8_t powerClass;      // Power class as defined in pethPsePortPowerClassification, 1 = class 0
+  uint8_t powerPriority;   // Power priority: 1 critical, 2 high, 3 low
+  uint16_t powerRequest;   // Requested power in 0.1 W steps
+  uint8_t policyApp;       // Network policy application: 1 voice
+  const char* hwRev;       // Inventory hardware revision
+  const char* fwRev;       // Inventory firmware revision
+  const char* swRev;       // Inventory software revision
+  const char* manufacturer;  // Inventory manufacturer name
+};
+
+bool lldp_buildFrame(const byte mac[], const char* deviceName, const LLDP_TXCONFIG* config);
+void send_LLDP_MED(uint16_t voiceVLAN, unsigned long* lastLLDPsent);
 
 #endif
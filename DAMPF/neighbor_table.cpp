@@ -0,0 +1,187 @@
+/*
+neighbor_table.cpp
+
+Bounded table of the LLDP and CDP neighbors.
+
+The table uses open addressing with linear probing, so finding and updating a neighbor
+on the receive path only checks a few slots. Removed entries are closed by moving the
+following entries back, no tombstones are needed.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "neighbor_table.h"
+
+static const uint8_t NEIGHBOR_MASK = NEIGHBOR_SLOTS - 1;
+
+static NEIGHBOR neighbor_table[NEIGHBOR_SLOTS];
+static uint8_t neighbor_counts[pinfo_ProtoCDP + 1];
+
+// Identifier of the neighbor device. CDP has no chassis ID, the device name is used instead.
+static const char* neighbor_deviceID(const PINFO* info) {
+  if (pinfo_isSet(info, pinfo_ChassisID))
+    return info->chassisID;
+  return info->swName;
+}
+
+// Hash of a text including the terminating zero, so "ab"+"c" and "a"+"bc" differ
+static uint32_t neighbor_hashText(uint32_t hash, const char* text) {
+  return pinfo_hash(hash, (const byte*)text, strlen(text) + 1);
+}
+
+static uint32_t neighbor_key(const PINFO* info) {
+  uint32_t hash = pinfo_hash(PINFO_HASHINIT, &info->proto, 1);
+  hash = neighbor_hashText(hash, neighbor_deviceID(info));
+  return neighbor_hashText(hash, info->port);
+}
+
+static bool neighbor_isSame(const NEIGHBOR* entry, uint32_t key, const PINFO* info) {
+  return (entry->key == key) && (entry->info.proto == info->proto)
+         && (strcmp(neighbor_deviceID(&entry->info), neighbor_deviceID(info)) == 0)
+         && (strcmp(entry->info.port, info->port) == 0);
+}
+
+// Remove the entry and move the following entries of the probe sequence into the gap
+static void neighbor_remove(uint8_t slot) {
+  neighbor_counts[neighbor_table[slot].info.proto]--;
+  neighbor_table[slot].used = false;
+
+  uint8_t hole = slot;
+  uint8_t i = slot;
+  while (true) {
+    i = (i + 1) & NEIGHBOR_MASK;
+    if (!neighbor_table[i].used)
+      break;
+
+    // The entry may only move if the gap is between its home slot and its current slot
+    uint8_t home = neighbor_table[i].key & NEIGHBOR_MASK;
+    if (((i - home) & NEIGHBOR_MASK) >= ((i - hole) & NEIGHBOR_MASK)) {
+      memcpy(&neighbor_table[hole], &neighbor_table[i], sizeof(NEIGHBOR));
+      neighbor_table[i].used = false;
+      hole = i;
+    }
+  }
+}  // void neighbor_remove()
+
+// Remove all neighbors, e.g. after the link went down
+void neighbor_clear() {
+  for (uint8_t i = 0; i < NEIGHBOR_SLOTS; i++)
+    neighbor_table[i].used = false;
+  memset(neighbor_counts, 0, sizeof(neighbor_counts));
+}
+
+// Renew the expiry time of the neighbor which sent a frame with the same digest before,
+// so an unchanged advertisement does not need to be decoded again. Returns false if
+// no neighbor sent this content or the time to live is 0 and the frame must be decoded.
+bool neighbor_refresh(uint8_t proto, uint32_t digest, uint16_t ttl, unsigned long now) {
+  if (ttl == 0)
+    return false;
+
+  for (uint8_t i = 0; i < NEIGHBOR_SLOTS; i++) {
+    if (neighbor_table[i].used && (neighbor_table[i].digest == digest) && (neighbor_table[i].info.proto == proto)) {
+      neighbor_table[i].expires = now + ttl * 1000UL;
+      return true;
+    }
+  }
+  return false;
+}  // bool neighbor_refresh()
+
+// Store the received neighbor data. An existing entry of the same neighbor is replaced
+// and its expiry time is renewed. If the table is full the entry expiring first is dropped.
+// A time to live of 0 removes the neighbor. Returns the stored data or NULL.
+PINFO* neighbor_update(const PINFO* info, uint32_t digest, unsigned long now) {
+  if (info->proto > pinfo_ProtoCDP)
+    return NULL;
+
+  uint32_t key = neighbor_key(info);
+  uint8_t slot = key & NEIGHBOR_MASK;
+  int16_t freeSlot = -1;
+
+  for (uint8_t probe = 0; probe < NEIGHBOR_SLOTS; probe++) {
+    if (!neighbor_table[slot].used) {
+      freeSlot = slot;
+      break;
+    }
+    if (neighbor_isSame(&neighbor_table[slot], key, info))
+      break;
+    slot = (slot + 1) & NEIGHBOR_MASK;
+  }
+
+  uint16_t ttl = pinfo_isSet(info, pinfo_TTL) ? info->ttl : NEIGHBOR_DEFAULTTTL;
+
+  if (freeSlot < 0) {
+    if (neighbor_table[slot].used && neighbor_isSame(&neighbor_table[slot], key, info)) {
+      // Known neighbor
+      if (ttl == 0) {
+        neighbor_remove(slot);
+        return NULL;
+      }
+    } else {
+      // Table is full, drop the neighbor expiring first and search the slot again
+      if (ttl == 0)
+        return NULL;
+      uint8_t oldest = 0;
+      for (uint8_t i = 1; i < NEIGHBOR_SLOTS; i++) {
+        if ((long)(neighbor_table[i].expires - neighbor_table[oldest].expires) < 0)
+          oldest = i;
+      }
+      neighbor_remove(oldest);
+      return neighbor_update(info, digest, now);
+    }
+  } else {
+    // New neighbor
+    if (ttl == 0)
+      return NULL;
+    neighbor_table[slot].used = true;
+    neighbor_table[slot].key = key;
+    neighbor_counts[info->proto]++;
+  }
+
+  neighbor_table[slot].expires = now + ttl * 1000UL;
+  neighbor_table[slot].digest = digest;
+  memcpy(&neighbor_table[slot].info, info, sizeof(PINFO));
+  return &neighbor_table[slot].info;
+}  // PINFO* neighbor_update()
+
+// Remove expired neighbors. Returns true if a neighbor was removed.
+bool neighbor_expire(unsigned long now) {
+  bool removed = false;
+  uint8_t i = 0;
+  while (i < NEIGHBOR_SLOTS) {
+    if (neighbor_table[i].used && ((long)(now - neighbor_table[i].expires) >= 0)) {
+      // Another entry may be moved into this slot, so check it again
+      neighbor_remove(i);
+      removed = true;
+    } else
+      i++;
+  }
+  return removed;
+}  // bool neighbor_expire()
+
+// Number of neighbors of the protocol
+uint8_t neighbor_count(uint8_t proto) {
+  if (proto > pinfo_ProtoCDP)
+    return 0;
+  return neighbor_counts[proto];
+}
+
+// Slot of the next neighbor of the protocol after slot, -1 starts at the beginning.
+// Returns -1 if there is no further neighbor.
+int8_t neighbor_next(uint8_t proto, int8_t slot) {
+  for (int8_t i = slot + 1; i < NEIGHBOR_SLOTS; i++) {
+    if (neighbor_table[i].used && (neighbor_table[i].info.proto == proto))
+      return i;
+  }
+  return -1;
+}
+
+// Neighbor data of the slot, NULL if the slot holds no neighbor of the protocol
+PINFO* neighbor_get(uint8_t proto, int8_t slot) {
+  if ((slot < 0) || (slot >= NEIGHBOR_SLOTS))
+    return NULL;
+  if (!neighbor_table[slot].used || (neighbor_table[slot].info.proto != proto))
+    return NULL;
+  return &neighbor_table[slot].info;
+}
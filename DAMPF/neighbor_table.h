@@ -0,0 +1,39 @@
+/*
+neighbor_table.h
+
+Bounded table of the LLDP and CDP neighbors, keyed by protocol, chassis ID and port ID.
+Entries expire after the time to live received with the neighbor.
+
+2023-12-18: Initial version
+*/
+
+#include <Arduino.h>
+#include "Packet_data.h"
+
+#ifndef NEIGHBOR_TABLE_H
+#define NEIGHBOR_TABLE_H
+
+// Number of table slots, must be a power of two
+static const uint8_t NEIGHBOR_SLOTS = 8;
+
+// Time to live in seconds if the neighbor did not send one
+static const uint16_t NEIGHBOR_DEFAULTTTL = 120;
+
+// One neighbor
+struct NEIGHBOR {
+  bool used;
+  uint32_t key;           // Hash of protocol, chassis ID and port ID
+  uint32_t digest;        // Digest of the received frame, see lldp_digest() and cdp_digest()
+  unsigned long expires;  // millis() when the entry is removed
+  PINFO info;
+};
+
+void neighbor_clear();
+bool neighbor_refresh(uint8_t proto, uint32_t digest, uint16_t ttl, unsigned long now);
+PINFO* neighbor_update(const PINFO* info, uint32_t digest, unsigned long now);
+bool neighbor_expire(unsigned long now);
+uint8_t neighbor_count(uint8_t proto);
+int8_t neighbor_next(uint8_t proto, int8_t slot);
+PINFO* neighbor_get(uint8_t proto, int8_t slot);
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ntp_client.cpp
+
+Query all NTP sources at the same time and select the best one.
+
+ntp_start() sends one request to every source, each with its own transmit timestamp. The server
+returns it as originate timestamp, so ntp_receive() matches the replies in the receive path
+without waiting. When all sources replied or NTP_TIMEOUT has passed, the source with the
+lowest round-trip delay plus NTP_STRATUMWEIGHT per stratum is selected.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "ntp_client.h"
+#include "fmt_functions.h"
+
+// UDP ports
+static const uint16_t NTP_SERVER_PORT = 123;
+static const uint16_t NTP_CLIENT_PORT = 0xda7b;
+
+// NTP packet
+static const uint8_t NTP_PACKETLEN = 48;
+static const uint8_t NTP_LI_VN_MODE = 0;
+static const uint8_t NTP_STRATUM = 1;
+static const uint8_t NTP_ORIGINATE = 24;
+static const uint8_t NTP_RECEIVE = 32;
+static const uint8_t NTP_TRANSMIT = 40;
+
+// No leap warning, version 4, client mode
+static const uint8_t NTP_REQUEST = 0x23;
+static const uint8_t NTP_MODE_SERVER = 4;
+static const uint8_t NTP_LI_UNSYNC = 3;
+
+// Transmit timestamp of the requests: "NT" and a request number in the seconds, millis() in the fraction
+static const uint32_t NTP_ORIGINPREFIX = 0x4e540000UL;
+
+// Seconds from 1900 to 1970
+static const uint32_t NTP_UNIXOFFSET = 2208988800UL;
+
+static NTP_SOURCE ntp_sources[NTP_MAXSOURCES];
+static uint8_t ntp_count = 0;
+static uint8_t ntp_replies = 0;
+static uint16_t ntp_requestNumber = 0;
+static int8_t ntp_selected = -1;
+static unsigned long ntp_started = 0;
+static eNtpState ntp_current = ntp_Idle;
+
+static inline uint32_t ntp_get32(const byte a[]) {
+  return ((uint32_t)a[0] << 24) | ((uint32_t)a[1] << 16) | (a[2] << 8) | a[3];
+}
+
+static inline void ntp_put32(byte a[], uint32_t value) {
+  a[0] = value >> 24;
+  a[1] = (value >> 16) & 0xff;
+  a[2] = (value >> 8) & 0xff;
+  a[3] = value & 0xff;
+}
+
+// NTP timestamp in ms since 1900
+static int64_t ntp_timestampMs(const byte timestamp[]) {
+  return (int64_t)ntp_get32(timestamp) * 1000 + (((uint64_t)ntp_get32(timestamp + 4) * 1000) >> 32);
+}
+
+static uint32_t ntp_score(const NTP_SOURCE* source) {
+  return source->rtt + (uint32_t)source->stratum * NTP_STRATUMWEIGHT;
+}
+
+// Select the best source and calculate the offsets of the others to it
+static void ntp_finish() {
+  ntp_selected = -1;
+  for (uint8_t i = 0; i < ntp_count; i++) {
+    NTP_SOURCE* source = &ntp_sources[i];
+    if (source->state == ntp_Running)
+      source->state = ntp_Timeout;
+    if ((source->state == ntp_Done) && ((ntp_selected < 0) || (ntp_score(source) < ntp_score(&ntp_sources[ntp_selected]))))
+      ntp_selected = i;
+  }
+
+  if (ntp_selected >= 0) {
+    for (uint8_t i = 0; i < ntp_count; i++) {
+      if (ntp_sources[i].state == ntp_Done)
+        ntp_sources[i].offset = ntp_sources[i].base - ntp_sources[ntp_selected].base;
+    }
+  }
+  ntp_current = ntp_Done;
+}
+
+// Send a request to all sources, returns false if there is no source
+bool ntp_start(const byte sources[][IP_LEN], uint8_t count, unsigned long now) {
+  if (count > NTP_MAXSOURCES)
+    count = NTP_MAXSOURCES;
+  memset(ntp_sources, 0, sizeof(ntp_sources));
+  ntp_count = count;
+  ntp_replies = 0;
+  ntp_selected = -1;
+  ntp_started = now;
+  if (count == 0) {
+    ntp_current = ntp_Done;
+    return false;
+  }
+
+  byte packet[NTP_PACKETLEN];
+  memset(packet, 0, sizeof(packet));
+  packet[NTP_LI_VN_MODE] = NTP_REQUEST;
+  for (uint8_t i = 0; i < count; i++) {
+    NTP_SOURCE* source = &ntp_sources[i];
+    memcpy(source->ip, sources[i], IP_LEN);
+    source->state = ntp_Running;
+    source->originSec = NTP_ORIGINPREFIX | ntp_requestNumber++;
+    source->originFrac = millis();
+    source->sent = source->originFrac;
+    ntp_put32(packet + NTP_TRANSMIT, source->originSec);
+    ntp_put32(packet + NTP_TRANSMIT + 4, source->originFrac);
+    ether.sendUdp((const char*)packet, NTP_PACKETLEN, NTP_CLIENT_PORT, source->ip, NTP_SERVER_PORT);
+  }
+
+  ntp_current = ntp_Running;
+  return true;
+}  // bool ntp_start()
+
+// Remove the sources, late replies are ignored
+void ntp_stop() {
+  ntp_count = 0;
+  ntp_selected = -1;
+  ntp_current = ntp_Idle;
+}
+
+// Returns true when the last reply was received or the timeout has passed
+bool ntp_process(unsigned long now) {
+  if (ntp_current != ntp_Running)
+    return false;
+  if ((ntp_replies < ntp_count) && ((now - ntp_started) < NTP_TIMEOUT))
+    return false;
+  ntp_finish();
+  return true;
+}
+
+// Match a reply to its request, returns true if the frame was a reply for the client
+bool ntp_receive(const byte frame[], uint16_t plen, const FRAME_INFO* info, unsigned long now) {
+  if ((ntp_current != ntp_Running) || (info->type != frame_NTP))
+    return false;
+
+  const byte* ip = frame + info->headerLen;
+  uint16_t ipHeaderLen = (ip[0] & 0x0f) * 4;
+  uint16_t udpPos = info->headerLen + ipHeaderLen;
+  if (((udpPos + 8 + NTP_PACKETLEN) > plen) || (((frame[udpPos + 2] << 8) | frame[udpPos + 3]) != NTP_CLIENT_PORT))
+    return false;
+
+  const byte* msg = frame + udpPos + 8;
+  uint32_t originSec = ntp_get32(msg + NTP_ORIGINATE);
+  uint32_t originFrac = ntp_get32(msg + NTP_ORIGINATE + 4);
+  NTP_SOURCE* source = NULL;
+  for (uint8_t i = 0; i < ntp_count; i++) {
+    if ((ntp_sources[i].state == ntp_Running) && (ntp_sources[i].originSec == originSec) && (ntp_sources[i].originFrac == originFrac)) {
+      source = &ntp_sources[i];
+      break;
+    }
+  }
+  if (source == NULL)
+    return true;
+
+  ntp_replies++;
+  source->stratum = msg[NTP_STRATUM];
+  if (((msg[NTP_LI_VN_MODE] & 0x07) != NTP_MODE_SERVER) || ((msg[NTP_LI_VN_MODE] >> 6) == NTP_LI_UNSYNC)
+      || (source->stratum == 0) || (source->stratum > 15) || (ntp_get32(msg + NTP_TRANSMIT) == 0)) {
+    source->state = ntp_Invalid;
+    return true;
+  }
+
+  // Round-trip delay without the time the server needed between receive and transmit
+  int64_t serverReceive = ntp_timestampMs(msg + NTP_RECEIVE);
+  int64_t serverTransmit = ntp_timestampMs(msg + NTP_TRANSMIT);
+  int64_t rtt = (int64_t)(now - source->sent) - (serverTransmit - serverReceive);
+  if (rtt < 0)
+    rtt = 0;
+  if (rtt > 0xffff)
+    rtt = 0xffff;
+  source->rtt = rtt;
+
+  // Server clock at the time the reply was received
+  source->base = serverTransmit + rtt / 2 - (int64_t)now;
+  source->state = ntp_Done;
+  return true;
+}  // bool ntp_receive()
+
+eNtpState ntp_state() {
+  return ntp_current;
+}
+
+uint8_t ntp_sourceCount() {
+  return ntp_count;
+}
+
+const NTP_SOURCE* ntp_getSource(uint8_t index) {
+  if (index >= ntp_count)
+    return NULL;
+  return &ntp_sources[index];
+}
+
+// Index of the selected source, -1 if no source replied
+int8_t ntp_best() {
+  return ntp_selected;
+}
+
+// Unix time in s of the selected source at millis() now, 0 if no source replied
+uint32_t ntp_getTime(unsigned long now) {
+  if (ntp_selected < 0)
+    return 0;
+  return (uint32_t)((ntp_sources[ntp_selected].base + (int64_t)now) / 1000 - NTP_UNIXOFFSET);
+}
+
+// Print the result of a source as "S<stratum> <rtt>ms <offset>ms"
+size_t ntp_printSource(const NTP_SOURCE* source, char* value, size_t size) {
+  switch (source->state) {
+    case ntp_Running:
+      return fmt_text(value, size, "waiting");
+    case ntp_Invalid:
+      return fmt_text(value, size, "unsynchronized");
+    case ntp_Timeout:
+      return fmt_text(value, size, "timeout");
+    case ntp_Done:
+      break;
+    default:
+      return fmt_text(value, size, "");
+  }
+
+  size_t pos = fmt_text(value, size, "S");
+  pos += fmt_uint(value + pos, size - pos, source->stratum);
+  pos += fmt_text(value + pos, size - pos, " ");
+  pos += fmt_uint(value + pos, size - pos, source->rtt);
+  pos += fmt_text(value + pos, size - pos, (source->offset < 0) ? "ms -" : "ms +");
+  pos += fmt_uint(value + pos, size - pos, (source->offset < 0) ? -source->offset : source->offset);
+  pos += fmt_text(value + pos, size - pos, "ms");
+  return pos;
+}  // size_t ntp_printSource()
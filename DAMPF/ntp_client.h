@@ -0,0 +1,63 @@
+/*
+ntp_client.h
+
+Query all NTP sources at the same time and select the best one by round-trip delay and stratum.
+
+2023-12-18: Initial version
+*/
+
+#include <EtherCard.h>
+#include <Arduino.h>
+#include "frame_functions.h"
+
+#ifndef NTP_CLIENT_H
+#define NTP_CLIENT_H
+
+// Sources queried at the same time, the same as ETH_NTPMAXSOURCES
+static const uint8_t NTP_MAXSOURCES = 10;
+
+// Time in ms to wait for the replies
+static const uint16_t NTP_TIMEOUT = 1500;
+
+// Round-trip delay in ms a source of a lower stratum may be slower than a source of the next
+// higher stratum and is still selected
+static const uint16_t NTP_STRATUMWEIGHT = 16;
+
+// Maximum length of a source printed by ntp_printSource() including the terminating zero
+static const uint8_t NTP_SOURCELEN = 40;
+
+// State of the client and of a source
+enum eNtpState {
+  ntp_Idle = 0,
+  ntp_Running,   // Waiting for the reply
+  ntp_Done,      // Reply received
+  ntp_Invalid,   // Unsynchronized server or kiss-o'-death
+  ntp_Timeout
+};
+
+// One queried source
+struct NTP_SOURCE {
+  uint8_t state;          // eNtpState
+  uint8_t stratum;
+  byte ip[IP_LEN];
+  uint32_t originSec;     // Transmit timestamp of the request, returned as originate timestamp
+  uint32_t originFrac;
+  unsigned long sent;     // millis() when the request was sent
+  uint16_t rtt;           // Round-trip delay in ms without the processing time of the server
+  int64_t base;           // ms since 1900 of the server clock at millis() 0
+  int32_t offset;         // ms to the selected source
+};
+
+bool ntp_start(const byte sources[][IP_LEN], uint8_t count, unsigned long now);
+void ntp_stop();
+bool ntp_process(unsigned long now);
+bool ntp_receive(const byte frame[], uint16_t plen, const FRAME_INFO* info, unsigned long now);
+
+eNtpState ntp_state();
+uint8_t ntp_sourceCount();
+const NTP_SOURCE* ntp_getSource(uint8_t index);
+int8_t ntp_best();
+uint32_t ntp_getTime(unsigned long now);
+size_t ntp_printSource(const NTP_SOURCE* source, char* value, size_t size);
+
+#endif
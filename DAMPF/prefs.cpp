@@ -153,3 +153,64 @@ unsigned char readPreferencesDelay() {
   }
   return tempDelay;
 }
+
+// Handle promiscuous receive of the Ethernet port, the default is set in Definitions.h
+void savePreferencesPromiscuous(unsigned char promiscuous) {
+  Preferences preferences;
+  preferences.begin("DAMPF", false);
+  preferences.putUChar("PROMISCUOUS", promiscuous);
+  preferences.end();
+}
+unsigned char readPreferencesPromiscuous() {
+  Preferences preferences;
+#ifdef ETH_PROMISCUOUS
+  unsigned char promiscuous = 1;
+#else
+  unsigned char promiscuous = 0;
+#endif
+  preferences.begin("DAMPF", true);
+  if (preferences.isKey("PROMISCUOUS")) {
+    promiscuous = preferences.getUChar("PROMISCUOUS", promiscuous);
+    if (promiscuous > 1)
+      promiscuous = 0;
+  }
+  return promiscuous;
+}
+
+// Handle the VLANs of the DHCP sweep, index of eth_sweepRanges or ETH_SWEEPSEENVLANS
+void savePreferencesSweepVLANs(unsigned char sweepVLANsIdx) {
+  Preferences preferences;
+  preferences.begin("DAMPF", false);
+  preferences.putUChar("SWEEPVLANS", sweepVLANsIdx);
+  preferences.end();
+}
+unsigned char readPreferencesSweepVLANs() {
+  Preferences preferences;
+  unsigned char sweepVLANs = ETH_DEFAULTSWEEPRANGEIDX;
+  preferences.begin("DAMPF", true);
+  if (preferences.isKey("SWEEPVLANS")) {
+    sweepVLANs = preferences.getUChar("SWEEPVLANS", ETH_DEFAULTSWEEPRANGEIDX);
+    if (sweepVLANs > ETH_SWEEPSEENVLANS)
+      sweepVLANs = ETH_DEFAULTSWEEPRANGEIDX;
+  }
+  return sweepVLANs;
+}
+
+// Handle the rate of the DHCP sweep
+void savePreferencesSweepRate(unsigned char sweepRateIdx) {
+  Preferences preferences;
+  preferences.begin("DAMPF", false);
+  preferences.putUChar("SWEEPRATE", sweepRateIdx);
+  preferences.end();
+}
+unsigned char readPreferencesSweepRate() {
+  Preferences preferences;
+  unsigned char sweepRate = ETH_DEFAULTSWEEPRATEIDX;
+  preferences.begin("DAMPF", true);
+  if (preferences.isKey("SWEEPRATE")) {
+    sweepRate = preferences.getUChar("SWEEPRATE", ETH_DEFAULTSWEEPRATEIDX);
+    if (sweepRate >= eth_sweepRatesCount)
+      sweepRate = ETH_DEFAULTSWEEPRATEIDX;
+  }
+  return sweepRate;
+}
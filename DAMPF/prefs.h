@@ -30,4 +30,13 @@ unsigned char readPreferencesOrientation(void);
 
 void savePreferencesDelay(unsigned char delay);
 unsigned char readPreferencesDelay();
+
+void savePreferencesPromiscuous(unsigned char promiscuous);
+unsigned char readPreferencesPromiscuous();
+
+void savePreferencesSweepVLANs(unsigned char sweepVLANsIdx);
+unsigned char readPreferencesSweepVLANs();
+
+void savePreferencesSweepRate(unsigned char sweepRateIdx);
+unsigned char readPreferencesSweepRate();
 #endif
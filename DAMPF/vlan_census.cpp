@@ -0,0 +1,116 @@
+/*
+vlan_census.cpp
+
+Passive census of the 802.1Q VLAN IDs of the received frames.
+
+vlan_record() runs in the receive task for every frame, so it only checks the tag type, sets the
+bit of the VLAN ID and increments its counter. The counters are in an open-addressed table with
+linear probing, VLAN ID 0 marks a free entry. The loop only reads the bitmap and the counters.
+
+2023-12-18: Initial version
+*/
+
+#include "Definitions.h"
+#include <Arduino.h>
+#include "vlan_census.h"
+
+static_assert((VLAN_TABLESIZE & (VLAN_TABLESIZE - 1)) == 0, "VLAN_TABLESIZE must be a power of two");
+static const uint8_t VLAN_TABLEMASK = VLAN_TABLESIZE - 1;
+
+// Tag protocol identifier of 802.1Q at the position of the Ethernet type
+static const uint16_t VLAN_TPID = 0x8100;
+static const uint16_t VLAN_TAGPOS = 12;
+static const uint16_t VLAN_IDMASK = 0x0fff;
+
+// Frames per VLAN
+struct VLAN_ENTRY {
+  uint16_t vlan;
+  uint32_t frames;
+};
+
+static byte vlan_bitmap[VLAN_BITMAPLEN];
+static VLAN_ENTRY vlan_table[VLAN_TABLESIZE];
+static uint16_t vlan_count = 0;
+static uint32_t vlan_framesUncounted = 0;
+
+// Record the VLAN ID of a tagged frame, returns the VLAN ID or 0 for untagged and priority tagged frames.
+// removedTagVLAN is the VLAN ID of the tag the EtherCard library removed from the frame, 0 if the
+// frame is in the buffer as it was received.
+uint16_t vlan_record(const byte frame[], uint16_t plen, uint16_t removedTagVLAN) {
+  uint16_t vlan;
+  if ((plen >= (VLAN_TAGPOS + 4)) && (((frame[VLAN_TAGPOS] << 8) | frame[VLAN_TAGPOS + 1]) == VLAN_TPID))
+    vlan = ((frame[VLAN_TAGPOS + 2] << 8) | frame[VLAN_TAGPOS + 3]) & VLAN_IDMASK;
+  else
+    vlan = removedTagVLAN & VLAN_IDMASK;
+  if ((vlan == 0) || (vlan == VLAN_IDMASK))
+    return 0;
+
+  byte mask = 1 << (vlan & 0x07);
+  if ((vlan_bitmap[vlan >> 3] & mask) == 0) {
+    vlan_bitmap[vlan >> 3] |= mask;
+    vlan_count++;
+  }
+
+  uint8_t index = (vlan ^ (vlan >> 6)) & VLAN_TABLEMASK;
+  for (uint8_t i = 0; i < VLAN_TABLESIZE; i++) {
+    VLAN_ENTRY* entry = &vlan_table[(index + i) & VLAN_TABLEMASK];
+    if (entry->vlan == vlan) {
+      entry->frames++;
+      return vlan;
+    }
+    if (entry->vlan == 0) {
+      entry->frames = 1;
+      entry->vlan = vlan;
+      return vlan;
+    }
+  }
+  vlan_framesUncounted++;
+  return vlan;
+}  // uint16_t vlan_record()
+
+void vlan_reset() {
+  memset(vlan_bitmap, 0, sizeof(vlan_bitmap));
+  memset(vlan_table, 0, sizeof(vlan_table));
+  vlan_count = 0;
+  vlan_framesUncounted = 0;
+}
+
+bool vlan_seen(uint16_t vlan) {
+  return (vlan <= VLAN_IDMASK) && ((vlan_bitmap[vlan >> 3] & (1 << (vlan & 0x07))) != 0);
+}
+
+uint16_t vlan_seenCount() {
+  return vlan_count;
+}
+
+// Next VLAN ID seen after vlan, start with -1. Returns -1 after the last one.
+int16_t vlan_next(int16_t vlan) {
+  for (uint16_t next = vlan + 1; next < VLAN_IDMASK; next++) {
+    // Skip 8 VLAN IDs at once if none of them was seen
+    if (((next & 0x07) == 0) && (vlan_bitmap[next >> 3] == 0)) {
+      next += 7;
+      continue;
+    }
+    if (vlan_seen(next))
+      return next;
+  }
+  return -1;
+}
+
+// Frames received in the VLAN, 0 if the VLAN is not in the table
+uint32_t vlan_frames(uint16_t vlan) {
+  uint8_t index = (vlan ^ (vlan >> 6)) & VLAN_TABLEMASK;
+  for (uint8_t i = 0; i < VLAN_TABLESIZE; i++) {
+    const VLAN_ENTRY* entry = &vlan_table[(index + i) & VLAN_TABLEMASK];
+    if (entry->vlan == vlan)
+      return entry->frames;
+    if (entry->vlan == 0)
+      break;
+  }
+  return 0;
+}
+
+// Frames of the VLANs that did not fit into the table
+uint32_t vlan_uncounted() {
+  return vlan_framesUncounted;
+}
@@ -0,0 +1,35 @@
+/*
+vlan_census.h
+
+Passive census of the 802.1Q VLAN IDs of the received frames. Every VLAN ID seen is recorded in a
+bitmap, the frames per VLAN are counted in a small table.
+
+The modified EtherCard library keeps the 802.1Q tag in Ethernet::buffer while VLAN tagging is
+disabled. While it is enabled, it removes the tag of the frames of the tagged VLAN, so the EtherCard
+DHCP client can parse them, and only reports it with ENC28J60::packet_Received_Was_Tagged(). The
+library has no function for the VLAN ID of such a frame, it is the ID given to enable_VLAN_tagging().
+
+2023-12-18: Initial version
+*/
+
+#include <Arduino.h>
+
+#ifndef VLAN_CENSUS_H
+#define VLAN_CENSUS_H
+
+// Bitmap of the 4096 VLAN IDs
+static const uint16_t VLAN_BITMAPLEN = 512;
+
+// VLANs with frame counters, must be a power of two. Further VLANs are only recorded in the bitmap.
+static const uint8_t VLAN_TABLESIZE = 64;
+
+uint16_t vlan_record(const byte frame[], uint16_t plen, uint16_t removedTagVLAN);
+void vlan_reset();
+
+bool vlan_seen(uint16_t vlan);
+uint16_t vlan_seenCount();
+int16_t vlan_next(int16_t vlan);
+uint32_t vlan_frames(uint16_t vlan);
+uint32_t vlan_uncounted();
+
+#endif
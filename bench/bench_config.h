@@ -0,0 +1,8 @@
+// Forced include for the host benchmark: use the sketch configuration, but without
+// serial debug output, which would otherwise dominate the measured decoder cost.
+#pragma once
+#include <Arduino.h>
+#include "../DAMPF/Definitions.h"
+
+#undef DEBUGSERIAL
+#undef DEBUGSENDLLDP
@@ -0,0 +1,661 @@
+/*
+decoder_bench.cpp
+
+Host benchmark for the LLDP, CDP and DHCP decoders of DAMPF. The received frames are read
+from pcap files (Ethernet link type), classified with frame_classify() and then replayed
+through the decoder of their type. For every decoder the throughput, the time per frame
+and the number of heap allocations per frame are reported.
+
+Usage: decoder_bench [-n iterations] [-v] [file.pcap ...]
+Without files a small set of built-in frames is used. With -v the values decoded from every
+LLDP and CDP frame are printed once before the measurement.
+Finally the fmt_functions formatters are compared with the String code they replaced.
+
+2023-12-18: Initial version
+*/
+
+#include <Arduino.h>
+#include <EtherCard.h>
+#include "frame_functions.h"
+#include "lldp_functions.h"
+#include "cdp_functions.h"
+#include "DHCPOptions.h"
+#include "Packet_data.h"
+#include "fmt_functions.h"
+#include "vlan_census.h"
+#include "dhcp_client.h"
+
+#include <chrono>
+#include <new>
+#include <vector>
+
+// Options stored by DHCPOption()
+static DHCP_DATA bench_dhcpInfo;
+
+// Count heap allocations, the shim String allocates through operator new
+static unsigned long long bench_allocs = 0;
+
+void* operator new(size_t size) {
+  bench_allocs++;
+  void* p = malloc(size ? size : 1);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+void operator delete(void* p) noexcept {
+  free(p);
+}
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+  free(p);
+}
+
+// Maximum frame size including a VLAN tag
+static const uint32_t BENCH_MAXFRAME = 1522;
+
+typedef std::vector<byte> FRAME;
+
+// Decoders to measure
+enum eBenchDecoder {
+  bench_LLDP = 0,
+  bench_CDP,
+  bench_DHCP,
+  bench_DecoderCount
+};
+
+static const char* const BENCH_DECODERNAMES[bench_DecoderCount] = { "LLDP", "CDP", "DHCP" };
+
+// Built-in frames used without pcap files
+static const byte BENCH_LLDPFRAME[] = {
+  0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x88, 0xcc,
+  0x02, 0x07, 0x04, 0x00, 0x11, 0x22, 0x33, 0x44, 0x00,                                  // Chassis ID, MAC
+  0x04, 0x08, 0x05, 'G', 'i', '1', '/', '0', '/', '7',                                  // Port ID, interface name
+  0x06, 0x02, 0x00, 0x78,                                                                // TTL 120s
+  0x08, 0x09, 'A', 'c', 'c', 'e', 's', 's', ' ', 'P', '7',                               // Port description
+  0x0a, 0x11, 's', 'w', '-', 'f', 'l', 'o', 'o', 'r', '2', '.', 'e', 'x', 'a', 'm', 'p', 'l', 'e',  // System name
+  0x0c, 0x15, 'S', 'w', 'i', 't', 'c', 'h', ' ', 'O', 'S', ' ', '1', '6', '.', '9', '\r', '\n', 'B', 'u', 'i', 'l', 'd',  // System description
+  0x0e, 0x04, 0x00, 0x14, 0x00, 0x04,                                                    // Capabilities bridge and router, bridge enabled
+  0x10, 0x0c, 0x05, 0x01, 10, 0, 20, 1, 0x02, 0x00, 0x00, 0x00, 0x01, 0x00,              // Management address
+  0xfe, 0x06, 0x00, 0x80, 0xc2, 0x01, 0x00, 0x0a,                                        // Port VLAN ID 10
+  0xfe, 0x09, 0x00, 0x12, 0x0f, 0x01, 0x03, 0x6c, 0x01, 0x00, 0x1e,                      // MAC/PHY
+  0xfe, 0x07, 0x00, 0x12, 0x0f, 0x02, 0x07, 0x01, 0x05,                                  // MDI power
+  0xfe, 0x07, 0x00, 0x12, 0xbb, 0x01, 0x00, 0x0f, 0x04,                                  // MED capabilities
+  0xfe, 0x08, 0x00, 0x12, 0xbb, 0x02, 0x01, 0x41, 0x90, 0x2e,                            // Network policy voice VLAN 200
+  0x00, 0x00                                                                             // End
+};
+
+static const byte BENCH_CDPFRAME[] = {
+  0x01, 0x00, 0x0c, 0xcc, 0xcc, 0xcc, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0x00,
+  0xaa, 0xaa, 0x03, 0x00, 0x00, 0x0c, 0x20, 0x00,  // SNAP
+  0x02, 0xb4, 0x00, 0x00,                          // Version 2, TTL 180s, checksum
+  0x00, 0x01, 0x00, 0x15, 's', 'w', '-', 'f', 'l', 'o', 'o', 'r', '2', '.', 'e', 'x', 'a', 'm', 'p', 'l', 'e',  // Device ID
+  0x00, 0x02, 0x00, 0x11, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0xcc, 0x00, 0x04, 10, 0, 20, 1,           // Addresses
+  0x00, 0x03, 0x00, 0x18, 'G', 'i', 'g', 'a', 'b', 'i', 't', 'E', 't', 'h', 'e', 'r', 'n', 'e', 't', '1', '/', '0', '/', '7',  // Port ID
+  0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00, 0x28,  // Capabilities switch, IGMP
+  0x00, 0x05, 0x00, 0x10, 'S', 'w', 'i', 't', 'c', 'h', ' ', 'O', 'S', ' ', '1', '6',  // Software version
+  0x00, 0x06, 0x00, 0x12, 'c', 'i', 's', 'c', 'o', ' ', 'W', 'S', '-', 'C', '2', '9', '6', '0',  // Platform
+  0x00, 0x09, 0x00, 0x08, 'v', 't', 'p', '1',      // VTP domain
+  0x00, 0x0a, 0x00, 0x06, 0x00, 0x0a,              // Native VLAN 10
+  0x00, 0x0b, 0x00, 0x05, 0x01,                    // Full duplex
+  0x00, 0x0e, 0x00, 0x07, 0x01, 0x00, 0xc8         // Voice VLAN 200
+};
+
+// CDP frame with an odd length ending with the Power Available TLV. The checksum 0xcda4 was
+// calculated like Cisco does, a 32 bit sum with the last byte sign-extended, not with cdp_checksum().
+static const byte BENCH_CDPODDFRAME[] = {
+  0x01, 0x00, 0x0c, 0xcc, 0xcc, 0xcc, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0x4f,
+  0xaa, 0xaa, 0x03, 0x00, 0x00, 0x0c, 0x20, 0x00,  // SNAP
+  0x02, 0xb4, 0xcd, 0xa4,                          // Version 2, TTL 180s, checksum
+  0x00, 0x01, 0x00, 0x0d, 's', 'w', '-', 'f', 'l', 'o', 'o', 'r', '2',  // Device ID
+  0x00, 0x03, 0x00, 0x18, 'G', 'i', 'g', 'a', 'b', 'i', 't', 'E', 't', 'h', 'e', 'r', 'n', 'e', 't', '1', '/', '0', '/', '7',  // Port ID
+  0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00, 0x28,  // Capabilities switch, IGMP
+  0x00, 0x0a, 0x00, 0x06, 0x00, 0x0a,              // Native VLAN 10
+  0x00, 0x1a, 0x00, 0x10, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x3a, 0x98, 0xff, 0xff, 0xff, 0xff  // Power available 15 W
+};
+
+static const byte BENCH_DHCPFRAME[] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x11, 0x22, 0x33, 0x44, 0x66, 0x08, 0x00,
+  // IPv4 header
+  0x45, 0x00, 0x01, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x40, 0x11, 0x00, 0x00, 10, 0, 20, 1, 255, 255, 255, 255,
+  // UDP 67 -> 68
+  0x00, 0x43, 0x00, 0x44, 0x01, 0x28, 0x00, 0x00,
+  // BOOTP: op, htype, hlen, hops, xid, secs, flags
+  0x02, 0x01, 0x06, 0x00, 0x12, 0x34, 0x56, 0x78, 0x00, 0x00, 0x00, 0x00,
+  // ciaddr, yiaddr, siaddr, giaddr
+  0, 0, 0, 0, 10, 0, 20, 50, 10, 0, 20, 1, 0, 0, 0, 0,
+  // chaddr, sname and file are added by bench_builtinFrames()
+};
+
+static const byte BENCH_DHCPOPTIONS[] = {
+  0x63, 0x82, 0x53, 0x63,                                                                   // Magic cookie
+  53, 1, 2,                                                                                 // Offer
+  1, 4, 255, 255, 255, 0,                                                                   // Mask
+  3, 4, 10, 0, 20, 1,                                                                       // Router
+  6, 8, 10, 0, 0, 53, 10, 0, 1, 53,                                                         // DNS
+  15, 11, 'e', 'x', 'a', 'm', 'p', 'l', 'e', '.', 'c', 'o', 'm',                            // Domain
+  42, 4, 10, 0, 0, 123,                                                                     // NTP
+  51, 4, 0x00, 0x01, 0x51, 0x80,                                                            // Lease time
+  54, 4, 10, 0, 20, 1,                                                                      // Server
+  119, 13, 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0,                       // Domain search
+  255
+};
+
+// Read all frames of a pcap file. pcapng files are not supported.
+static bool bench_readPcap(const char* fileName, std::vector<FRAME>* frames) {
+  FILE* file = fopen(fileName, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "%s: cannot open\n", fileName);
+    return false;
+  }
+
+  byte header[24];
+  if (fread(header, 1, sizeof(header), file) != sizeof(header)) {
+    fprintf(stderr, "%s: no pcap header\n", fileName);
+    fclose(file);
+    return false;
+  }
+
+  uint32_t magic = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+  bool swapped;
+  if ((magic == 0xa1b2c3d4) || (magic == 0xa1b23c4d))
+    swapped = false;
+  else if ((magic == 0xd4c3b2a1) || (magic == 0x4d3cb2a1))
+    swapped = true;
+  else {
+    fprintf(stderr, "%s: not a pcap file (pcapng must be converted with editcap -F pcap)\n", fileName);
+    fclose(file);
+    return false;
+  }
+
+  // Read a 32 bit value in the byte order of the file
+  auto read32 = [swapped](const byte* p) -> uint32_t {
+    if (swapped)
+      return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+  };
+
+  uint32_t linkType = read32(header + 20);
+  if (linkType != 1) {
+    fprintf(stderr, "%s: link type %u is not Ethernet\n", fileName, linkType);
+    fclose(file);
+    return false;
+  }
+
+  byte record[16];
+  size_t count = 0;
+  while (fread(record, 1, sizeof(record), file) == sizeof(record)) {
+    uint32_t capLen = read32(record + 8);
+    FRAME frame(capLen);
+    if ((capLen > 0) && (fread(frame.data(), 1, capLen, file) != capLen))
+      break;
+    if (capLen > BENCH_MAXFRAME)
+      frame.resize(BENCH_MAXFRAME);
+    frames->push_back(frame);
+    count++;
+  }
+  fclose(file);
+
+  printf("%s: %zu frames\n", fileName, count);
+  return true;
+}  // bool bench_readPcap()
+
+static void bench_builtinFrames(std::vector<FRAME>* frames) {
+  frames->push_back(FRAME(BENCH_LLDPFRAME, BENCH_LLDPFRAME + sizeof(BENCH_LLDPFRAME)));
+
+  // 802.3 length field of the CDP frame
+  FRAME cdp(BENCH_CDPFRAME, BENCH_CDPFRAME + sizeof(BENCH_CDPFRAME));
+  cdp[12] = (cdp.size() - 14) >> 8;
+  cdp[13] = (cdp.size() - 14) & 0xff;
+  uint16_t checksum = cdp_checksum(cdp.data() + CDP_SNAP_LEN, cdp.size() - CDP_SNAP_LEN);
+  cdp[CDP_SNAP_LEN + 2] = checksum >> 8;
+  cdp[CDP_SNAP_LEN + 3] = checksum & 0xff;
+  frames->push_back(cdp);
+  frames->push_back(FRAME(BENCH_CDPODDFRAME, BENCH_CDPODDFRAME + sizeof(BENCH_CDPODDFRAME)));
+
+  // chaddr (16), sname (64) and file (128) are zero
+  FRAME dhcp(BENCH_DHCPFRAME, BENCH_DHCPFRAME + sizeof(BENCH_DHCPFRAME));
+  dhcp.resize(dhcp.size() + 16 + 64 + 128, 0);
+  dhcp.insert(dhcp.end(), BENCH_DHCPOPTIONS, BENCH_DHCPOPTIONS + sizeof(BENCH_DHCPOPTIONS));
+  frames->push_back(dhcp);
+
+  printf("built-in frames: %zu\n", frames->size());
+}
+
+// Check cdp_checksum() with the odd length frame, the sum over a valid frame is 0.
+// The same frame with one changed byte has to be rejected by cdp_validate().
+static bool bench_checkCdpChecksum() {
+  uint16_t checksum = cdp_checksum(BENCH_CDPODDFRAME + CDP_SNAP_LEN, sizeof(BENCH_CDPODDFRAME) - CDP_SNAP_LEN);
+  printf("CDP checksum of odd length frame: %s\n", (checksum == 0) ? "ok" : "FAILED");
+
+  FRAME corrupted(BENCH_CDPODDFRAME, BENCH_CDPODDFRAME + sizeof(BENCH_CDPODDFRAME));
+  corrupted[CDP_HEADER_LEN + 4] ^= 0x01;
+  uint16_t plen = corrupted.size();
+  bool rejected = cdp_validate(corrupted.data(), &plen) == frame_BadChecksum;
+  printf("CDP frame with bad checksum: %s\n", rejected ? "rejected" : "FAILED");
+  return (checksum == 0) && rejected;
+}
+
+// Tagged frame of VLAN 42 with priority 5 as it is on the wire
+static const byte BENCH_TAGGEDFRAME[] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x15, 0x65, 0x12, 0x34, 0x56,
+  0x81, 0x00, 0xa0, 0x2a, 0x08, 0x06,
+  0x00, 0x01, 0x08, 0x00, 0x06, 0x04, 0x00, 0x01, 0x00, 0x15, 0x65, 0x12, 0x34, 0x56,
+  0xc0, 0xa8, 0x2a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xa8, 0x2a, 0x01,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+static const uint16_t BENCH_TAGGEDVLAN = 42;
+
+// Receive a frame and record it like eth_rxTask() does, returns the recorded VLAN ID
+static uint16_t bench_receiveVlan(const byte frame[], uint16_t len, uint16_t voiceVLAN) {
+  shim_receive(frame, len);
+  uint16_t plen = ether.packetReceive();
+  bool tagged = ENC28J60::packet_Received_Was_Tagged();
+  return vlan_record(Ethernet::buffer, plen, tagged ? voiceVLAN : 0);
+}
+
+// Check vlan_record() with the frames as packetReceive() returns them. With VLAN tagging disabled
+// the tag is in the buffer, with tagging enabled the library removes it and only sets its flag.
+static bool bench_checkVlanCensus() {
+  vlan_reset();
+  bool kept = bench_receiveVlan(BENCH_TAGGEDFRAME, sizeof(BENCH_TAGGEDFRAME), 0) == BENCH_TAGGEDVLAN;
+  printf("VLAN census, tag in the buffer: %s\n", kept ? "ok" : "FAILED");
+
+  ENC28J60::enable_VLAN_tagging(BENCH_TAGGEDVLAN);
+  bool removed = (bench_receiveVlan(BENCH_TAGGEDFRAME, sizeof(BENCH_TAGGEDFRAME), BENCH_TAGGEDVLAN) == BENCH_TAGGEDVLAN)
+                 && ENC28J60::packet_Received_Was_Tagged() && (Ethernet::buffer[12] == 0x08) && (Ethernet::buffer[13] == 0x06);
+  printf("VLAN census, tag removed by the library: %s\n", removed ? "ok" : "FAILED");
+
+  // The same frame without tag is not counted
+  FRAME untagged(BENCH_TAGGEDFRAME, BENCH_TAGGEDFRAME + 12);
+  untagged.insert(untagged.end(), BENCH_TAGGEDFRAME + 16, BENCH_TAGGEDFRAME + sizeof(BENCH_TAGGEDFRAME));
+  bool ignored = bench_receiveVlan(untagged.data(), untagged.size(), BENCH_TAGGEDVLAN) == 0;
+  ENC28J60::disable_VLAN_tagging();
+  printf("VLAN census, untagged frame: %s\n", ignored ? "ok" : "FAILED");
+
+  bool counted = (vlan_seenCount() == 1) && (vlan_frames(BENCH_TAGGEDVLAN) == 2);
+  printf("VLAN census, frames of VLAN %u: %lu\n", BENCH_TAGGEDVLAN, (unsigned long)vlan_frames(BENCH_TAGGEDVLAN));
+  vlan_reset();
+  return kept && removed && ignored && counted;
+}
+
+// DHCP server answering the DHCP client in the VLAN of its DISCOVER
+static const byte BENCH_CLIENTMAC[ETH_LEN] = { 0x00, 0x15, 0x65, 0x12, 0x34, 0x56 };
+static const byte BENCH_SERVERMAC[ETH_LEN] = { 0x00, 0x1b, 0x54, 0x0a, 0x0b, 0x0c };
+static const byte BENCH_OFFEREDIP[IP_LEN] = { 192, 168, 42, 10 };
+static const byte BENCH_SERVERIP[IP_LEN] = { 192, 168, 42, 1 };
+static const uint16_t BENCH_BOOTPOPTIONS = 28 + 240;  // IPv4, UDP, BOOTP header and magic cookie
+
+// Data of an option of a DHCP frame, NULL if it is missing
+static const byte* bench_dhcpOption(const byte frame[], uint16_t len, uint8_t code) {
+  uint16_t headerLen = ((frame[12] == 0x81) && (frame[13] == 0x00)) ? FRAME_VLAN_HEADER_LEN : FRAME_ETH_HEADER_LEN;
+  for (uint16_t pos = headerLen + BENCH_BOOTPOPTIONS; (pos + 1) < len;) {
+    byte option = frame[pos++];
+    if (option == 0)
+      continue;
+    if (option == 255)
+      break;
+    if (option == code)
+      return frame + pos + 1;
+    pos += 1 + frame[pos];
+  }
+  return NULL;
+}
+
+// Type of the message sent by the DHCP client, 0 if nothing or a frame in another VLAN was sent
+static uint8_t bench_dhcpSent(uint16_t len, uint16_t vlan) {
+  if ((len < FRAME_VLAN_HEADER_LEN + BENCH_BOOTPOPTIONS) || (len == 0xffff))
+    return 0;
+  bool tagged = (Ethernet::buffer[12] == 0x81) && (Ethernet::buffer[13] == 0x00);
+  if ((tagged ? (((Ethernet::buffer[14] << 8) | Ethernet::buffer[15]) & 0x0fff) : 0) != vlan)
+    return 0;
+  const byte* msgType = bench_dhcpOption(Ethernet::buffer, len, 53);
+  return (msgType != NULL) ? *msgType : 0;
+}
+
+// Answer the message of the DHCP client in the send buffer like a server and pass the answer to
+// dhcpc_receive(), returns true if the client took it
+static bool bench_dhcpAnswer(uint8_t msgType, unsigned long now) {
+  static const byte options[] = {
+    53, 1, 0,                       // Message type, set below
+    54, 4, 192, 168, 42, 1,         // Server identifier
+    1, 4, 255, 255, 255, 0,         // Network mask
+    3, 4, 192, 168, 42, 1,          // Router
+    51, 4, 0x00, 0x00, 0x0e, 0x10,  // Lease time 3600s
+    255
+  };
+  uint16_t headerLen = ((Ethernet::buffer[12] == 0x81) && (Ethernet::buffer[13] == 0x00)) ? FRAME_VLAN_HEADER_LEN : FRAME_ETH_HEADER_LEN;
+  FRAME answer(Ethernet::buffer, Ethernet::buffer + headerLen + BENCH_BOOTPOPTIONS);
+  answer.insert(answer.end(), options, options + sizeof(options));
+  answer[headerLen + BENCH_BOOTPOPTIONS + 2] = msgType;
+  memcpy(&answer[ETH_LEN], BENCH_SERVERMAC, ETH_LEN);
+
+  byte* udp = &answer[headerLen + 20];
+  udp[1] = 67;  // Server port
+  udp[3] = 68;  // Client port
+  byte* bootp = udp + 8;
+  bootp[0] = 2;  // Reply
+  memcpy(bootp + 16, BENCH_OFFEREDIP, IP_LEN);
+
+  FRAME_INFO info;
+  frame_classify(answer.data(), answer.size(), &info);
+  return dhcpc_receive(answer.data(), answer.size(), &info, now);
+}
+
+// Run a lease in the voice VLAN and two probes through the DHCP client. The messages are taken
+// from the send buffer and answered like a server. The library tagging is enabled like after the
+// "v" command, the client has to send its own tag.
+static bool bench_checkDhcpClient() {
+  static DHCP_DATA store;
+  unsigned long now = 1000;
+  dhcpc_init(BENCH_CLIENTMAC, "DAMPF");
+  ENC28J60::enable_VLAN_tagging(BENCH_TAGGEDVLAN);
+
+  dhcpc_lease(DHCPC_VOICE, BENCH_TAGGEDVLAN, &store, 60000, now);
+  dhcpc_process(now, BENCH_TAGGEDVLAN);
+  uint16_t len = shim_sent();
+  bool discover = bench_dhcpSent(len, BENCH_TAGGEDVLAN) == 1;
+  bool requesting = bench_dhcpAnswer(2, now) && (dhcpc_state(DHCPC_VOICE) == dhcpc_Requesting);
+  printf("DHCP client, DISCOVER and OFFER in VLAN %u: %s\n", BENCH_TAGGEDVLAN, (discover && requesting) ? "ok" : "FAILED");
+
+  dhcpc_process(now, BENCH_TAGGEDVLAN);
+  len = shim_sent();
+  const byte* requested = bench_dhcpOption(Ethernet::buffer, len, 50);
+  bool request = (bench_dhcpSent(len, BENCH_TAGGEDVLAN) == 3) && (requested != NULL) && (memcmp(requested, BENCH_OFFEREDIP, IP_LEN) == 0);
+  const DHCPC_CONTEXT* context = dhcpc_getContext(DHCPC_VOICE);
+  bool bound = bench_dhcpAnswer(5, now) && (context->state == dhcpc_Bound) && dhcp_hasOption(&store, DHCP_OPT_IP)
+               && (memcmp(context->gateway, BENCH_SERVERIP, IP_LEN) == 0) && (memcmp(context->serverMAC, BENCH_SERVERMAC, ETH_LEN) == 0);
+  printf("DHCP client, REQUEST and ACK: %s\n", (request && bound) ? "ok" : "FAILED");
+
+  // The untagged lease runs next to the voice lease, which is given back
+  dhcpc_lease(DHCPC_UNTAGGED, 0, &bench_dhcpInfo, 60000, now);
+  dhcpc_process(now, BENCH_TAGGEDVLAN);
+  len = shim_sent();
+  bool untagged = (bench_dhcpSent(len, 0) == 1) && (dhcpc_state(DHCPC_UNTAGGED) == dhcpc_Selecting);
+  dhcpc_release(DHCPC_VOICE);
+  dhcpc_process(now, BENCH_TAGGEDVLAN);
+  bool released = (bench_dhcpSent(shim_sent(), BENCH_TAGGEDVLAN) == 7) && (memcmp(Ethernet::buffer, BENCH_SERVERMAC, ETH_LEN) == 0)
+                  && (dhcpc_state(DHCPC_VOICE) == dhcpc_Idle) && ENC28J60::is_VLAN_tagging_enabled();
+  printf("DHCP client, untagged lease and RELEASE: %s\n", (untagged && released) ? "ok" : "FAILED");
+
+  // A probe keeps the OFFER, a probe without answer fails after its timeout
+  int8_t offered = dhcpc_probe(BENCH_TAGGEDVLAN + 1, 250, now);
+  dhcpc_process(now, BENCH_TAGGEDVLAN);
+  len = shim_sent();
+  bool probe = (offered >= 0) && (bench_dhcpSent(len, BENCH_TAGGEDVLAN + 1) == 1) && bench_dhcpAnswer(2, now)
+               && (dhcpc_state(offered) == dhcpc_Offered) && (memcmp(dhcpc_getContext(offered)->ip, BENCH_OFFEREDIP, IP_LEN) == 0);
+  int8_t silent = dhcpc_probe(BENCH_TAGGEDVLAN + 2, 250, now);
+  dhcpc_process(now, BENCH_TAGGEDVLAN);
+  dhcpc_process(now + 250, BENCH_TAGGEDVLAN);
+  bool failed = (silent >= 0) && (silent != offered) && (dhcpc_state(silent) == dhcpc_Failed);
+  printf("DHCP client, probes: %s\n", (probe && failed) ? "ok" : "FAILED");
+
+  dhcpc_reset();
+  dhcp_reset(&bench_dhcpInfo);
+  ENC28J60::disable_VLAN_tagging();
+  return discover && requesting && request && bound && untagged && released && probe && failed;
+}
+
+// Print the decoded values of a neighbor
+static void bench_printNeighbor(const PINFO* info) {
+  char value[PINFO_VALUELEN];
+  for (int field = 0; field < pinfo_FieldCount; field++) {
+    if (pinfo_getValue(info, (ePinfoField)field, value, sizeof(value)))
+      printf("  %s=%s\n", PINFO_FIELDS[field].label, value);
+  }
+  printf("\n");
+}
+
+// Print the stored DHCP options
+static void bench_printDhcp(const DHCP_DATA* store) {
+  char value[DHCP_VALUELEN];
+  for (byte i = 0; i < store->count; i++) {
+    uint8_t code = store->options[i].code;
+    if (dhcp_getValue(store, code, value, sizeof(value)))
+      printf("  %u %s=%s\n", code, dhcp_optionLabel(code), value);
+  }
+  printf("\n");
+}
+
+// Walk the DHCP options like the DHCP client and pass them to DHCPOption()
+static void bench_dhcpDecode(const byte frame[], uint16_t plen, const FRAME_INFO* info) {
+  uint16_t pos = info->headerLen;
+  if ((pos + 20) > plen)
+    return;
+  pos += (frame[pos] & 0x0f) * 4;  // IPv4 header
+  pos += 8;                         // UDP header
+  pos += 236;                       // BOOTP header
+  if ((pos + 4) > plen)
+    return;
+  pos += 4;  // Magic cookie
+
+  while (pos < plen) {
+    byte option = frame[pos++];
+    if (option == 0)
+      continue;
+    if ((option == 255) || (pos >= plen))
+      break;
+    byte len = frame[pos++];
+    if ((pos + len) > plen)
+      break;
+    DHCPOption(&bench_dhcpInfo, option, frame + pos, len);
+    pos += len;
+  }
+}
+
+// Keep the formatted results alive, so the compiler cannot drop the formatting
+static volatile size_t bench_sink = 0;
+
+// MAC address as built in setup() before fmt_mac()
+static void bench_stringMac(const byte mac[]) {
+  String text = "";
+  for (byte i = 0; i < 6; i++) {
+    String tmp = "0" + String(mac[i], HEX);
+    tmp = tmp.substring(tmp.length() - 2);
+    text += tmp;
+    if (i < 5)
+      text += ":";
+  }
+  bench_sink += text.length();
+}
+
+// IPv4 address as built for the DHCP and NTP data before fmt_ipv4()
+static void bench_stringIPv4(const byte ip[]) {
+  String text;
+  for (byte j = 0; j < IP_LEN; ++j) {
+    text += String(ip[j]);
+    if (j < 3)
+      text += ".";
+  }
+  bench_sink += text.length();
+}
+
+// Hex dump as built for the DHCP debug output before fmt_hex()
+static void bench_stringHex(const byte data[], byte len) {
+  String text;
+  for (byte i = 0; i < len; i++) {
+    String hex = "00" + String(data[i], HEX);
+    text += hex.substring(hex.length() - 2);
+  }
+  bench_sink += text.length();
+}
+
+static void bench_fmtMac(const byte mac[]) {
+  char text[FMT_MACLEN];
+  bench_sink += fmt_mac(text, sizeof(text), mac, ':');
+}
+
+static void bench_fmtIPv4(const byte ip[]) {
+  char text[FMT_IPV4LEN];
+  bench_sink += fmt_ipv4(text, sizeof(text), ip);
+}
+
+static void bench_fmtHex(const byte data[], byte len) {
+  char text[2 * 255 + 1];
+  bench_sink += fmt_hex(text, sizeof(text), data, len);
+}
+
+// Compare the formatters of fmt_functions with the String code they replaced
+static void bench_formatting(unsigned long iterations) {
+  static const byte mac[ETH_LEN] = { 0xca, 0xfe, 0xc0, 0xff, 0xee, 0x00 };
+  static const byte ip[IP_LEN] = { 192, 168, 100, 254 };
+  static const byte data[32] = { 0x01, 0x04, 0xff, 0xff, 0xff, 0x00, 0x03, 0x04, 10, 0, 20, 1 };
+  static const char* const names[] = { "MAC String", "MAC fmt", "IPv4 String", "IPv4 fmt", "hex32 String", "hex32 fmt" };
+
+  printf("\n%-12s %10s %10s %12s\n", "format", "iterations", "ns/value", "allocs/value");
+  for (int test = 0; test < 6; test++) {
+    unsigned long long allocsStart = bench_allocs;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long it = 0; it < iterations; it++) {
+      switch (test) {
+        case 0: bench_stringMac(mac); break;
+        case 1: bench_fmtMac(mac); break;
+        case 2: bench_stringIPv4(ip); break;
+        case 3: bench_fmtIPv4(ip); break;
+        case 4: bench_stringHex(data, sizeof(data)); break;
+        case 5: bench_fmtHex(data, sizeof(data)); break;
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-12s %10lu %10.1f %12.2f\n", names[test], iterations, ns / iterations, (double)(bench_allocs - allocsStart) / iterations);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  unsigned long iterations = 10000;
+  std::vector<FRAME> frames;
+  bool fromFiles = false;
+  bool verbose = false;
+
+  for (int i = 1; i < argc; i++) {
+    if ((strcmp(argv[i], "-n") == 0) && ((i + 1) < argc))
+      iterations = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-v") == 0)
+      verbose = true;
+    else {
+      bench_readPcap(argv[i], &frames);
+      fromFiles = true;
+    }
+  }
+  if (!bench_checkCdpChecksum())
+    return 1;
+  if (!bench_checkVlanCensus())
+    return 1;
+  if (!bench_checkDhcpClient())
+    return 1;
+  if (!fromFiles)
+    bench_builtinFrames(&frames);
+  if (iterations == 0)
+    iterations = 1;
+
+  // Classify once, only the checks and decoders are measured. Frames rejected by the
+  // structural checks are counted like in the sketch and not measured.
+  std::vector<FRAME> decoderFrames[bench_DecoderCount];
+  std::vector<FRAME_INFO> decoderInfos[bench_DecoderCount];
+  size_t otherFrames = 0;
+  for (const FRAME& frame : frames) {
+    FRAME_INFO info;
+    uint16_t plen = frame.size();
+    switch (frame_classify(frame.data(), plen, &info)) {
+      case frame_LLDP:
+        if (!frame_count(frame_LLDP, lldp_validate(frame.data(), plen)))
+          break;
+        decoderFrames[bench_LLDP].push_back(frame);
+        decoderInfos[bench_LLDP].push_back(info);
+        break;
+      case frame_CDP:
+        if (!frame_count(frame_CDP, cdp_validate(frame.data(), &plen)))
+          break;
+        decoderFrames[bench_CDP].push_back(FRAME(frame.begin(), frame.begin() + plen));
+        decoderInfos[bench_CDP].push_back(info);
+        break;
+      case frame_DHCP:
+        decoderFrames[bench_DHCP].push_back(frame);
+        decoderInfos[bench_DHCP].push_back(info);
+        break;
+      default:
+        otherFrames++;
+        break;
+    }
+  }
+  printf("other frames (not measured): %zu\n", otherFrames);
+  for (eFrameType type : { frame_LLDP, frame_CDP }) {
+    const FRAME_COUNTERS* counters = frame_getCounters(type);
+    printf("%s rejected: truncated %u, malformed %u, bad checksum %u\n", type == frame_LLDP ? "LLDP" : "CDP",
+           counters->truncated, counters->malformed, counters->badChecksum);
+  }
+  printf("\n");
+
+  if (verbose) {
+    PINFO info;
+    for (const FRAME& frame : decoderFrames[bench_LLDP]) {
+      pinfo_reset(&info);
+      lldp_packet_handler(frame.data(), frame.size(), &info);
+      bench_printNeighbor(&info);
+    }
+    for (const FRAME& frame : decoderFrames[bench_CDP]) {
+      pinfo_reset(&info);
+      cdp_packet_handler(frame.data(), frame.size(), &info);
+      bench_printNeighbor(&info);
+    }
+    for (size_t f = 0; f < decoderFrames[bench_DHCP].size(); f++) {
+      dhcp_reset(&bench_dhcpInfo);
+      bench_dhcpDecode(decoderFrames[bench_DHCP][f].data(), decoderFrames[bench_DHCP][f].size(), &decoderInfos[bench_DHCP][f]);
+      bench_printDhcp(&bench_dhcpInfo);
+    }
+  }
+
+  printf("%-6s %8s %10s %14s %10s %12s\n", "proto", "frames", "iterations", "frames/s", "ns/frame", "allocs/frame");
+  for (int d = 0; d < bench_DecoderCount; d++) {
+    const std::vector<FRAME>& list = decoderFrames[d];
+    if (list.empty()) {
+      printf("%-6s %8u %10s %14s %10s %12s\n", BENCH_DECODERNAMES[d], 0, "-", "-", "-", "-");
+      continue;
+    }
+
+    PINFO info;
+    unsigned long long allocsStart = bench_allocs;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long it = 0; it < iterations; it++) {
+      for (size_t f = 0; f < list.size(); f++) {
+        const byte* frame = list[f].data();
+        uint16_t plen = list[f].size();
+        switch (d) {
+          case bench_LLDP:
+            if (lldp_validate(frame, plen) != frame_Valid)
+              break;
+            pinfo_reset(&info);
+            lldp_packet_handler(frame, plen, &info);
+            break;
+          case bench_CDP:
+            if (cdp_validate(frame, &plen) != frame_Valid)
+              break;
+            pinfo_reset(&info);
+            cdp_packet_handler(frame, plen, &info);
+            break;
+          case bench_DHCP:
+            dhcp_reset(&bench_dhcpInfo);
+            bench_dhcpDecode(frame, plen, &decoderInfos[d][f]);
+            break;
+        }
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double decoded = (double)iterations * list.size();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-6s %8zu %10lu %14.0f %10.1f %12.2f\n", BENCH_DECODERNAMES[d], list.size(), iterations,
+           decoded * 1e9 / ns, ns / decoded, (bench_allocs - allocsStart) / decoded);
+  }
+
+  bench_formatting(iterations);
+  return 0;
+}
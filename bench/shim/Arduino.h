@@ -0,0 +1,104 @@
+// Host shim: the parts of the Arduino core used by the protocol decoders.
+// String is backed by std::string, so its heap allocations go through operator new
+// and are counted by the benchmark.
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+#define PROGMEM
+#define F(x) (x)
+#define memcpy_P memcpy
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_ptr(p) (*(void* const*)(p))
+
+unsigned long millis();
+unsigned long micros();
+
+class String {
+public:
+  std::string s;
+
+  String() {}
+  String(const char* c) : s(c ? c : "") {}
+  String(const std::string& c) : s(c) {}
+  String(char c) : s(1, c) {}
+  String(unsigned char v, int base = 10) { fromU(v, base); }
+  String(int v, int base = 10) { if (base == 10) s = std::to_string(v); else fromU((unsigned)v, base); }
+  String(unsigned int v, int base = 10) { fromU(v, base); }
+  String(long v, int base = 10) { if (base == 10) s = std::to_string(v); else fromU((unsigned long)v, base); }
+  String(unsigned long v, int base = 10) { fromU(v, base); }
+  String(float v, int d = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", d, v); s = b; }
+  String(double v, int d = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", d, v); s = b; }
+
+  unsigned int length() const { return s.size(); }
+  const char* c_str() const { return s.c_str(); }
+  String substring(unsigned a) const { return a >= s.size() ? String() : String(s.substr(a)); }
+  String substring(unsigned a, unsigned b) const {
+    if (a > b) std::swap(a, b);
+    if (a >= s.size()) return String();
+    return String(s.substr(a, b - a));
+  }
+  int indexOf(char c, unsigned from = 0) const { auto p = s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const char* c, unsigned from = 0) const { auto p = s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+  int lastIndexOf(char c) const { auto p = s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+  long toInt() const { return atol(s.c_str()); }
+  bool reserve(unsigned n) { s.reserve(n); return true; }
+  bool concat(const char* c, unsigned n) { s.append(c, n); return true; }
+  char operator[](unsigned i) const { return s[i]; }
+
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* o) { s += o; return *this; }
+  String& operator+=(char o) { s += o; return *this; }
+  String& operator+=(unsigned char o) { s += std::to_string(o); return *this; }
+  String& operator+=(int o) { s += std::to_string(o); return *this; }
+  String& operator+=(unsigned o) { s += std::to_string(o); return *this; }
+  String& operator+=(long o) { s += std::to_string(o); return *this; }
+  String& operator+=(unsigned long o) { s += std::to_string(o); return *this; }
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator==(const char* o) const { return s == o; }
+  bool operator!=(const String& o) const { return s != o.s; }
+  bool operator!=(const char* o) const { return s != o; }
+  friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+  friend String operator+(const String& a, const char* b) { return String(a.s + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.s); }
+  friend String operator+(const String& a, char b) { return String(a.s + b); }
+
+private:
+  void fromU(unsigned long v, int base) {
+    if (!v) { s = "0"; return; }
+    char b[40];
+    int i = 39;
+    b[i] = 0;
+    while (v) {
+      int d = v % base;
+      b[--i] = d < 10 ? '0' + d : 'a' + d - 10;
+      v /= base;
+    }
+    s = b + i;
+  }
+};
+
+// Serial output is discarded
+class HardwareSerialShim {
+public:
+  template<typename T> size_t print(const T&) { return 0; }
+  template<typename T> size_t print(const T&, int) { return 0; }
+  template<typename T> size_t println(const T&) { return 0; }
+  template<typename T> size_t println(const T&, int) { return 0; }
+  size_t println() { return 0; }
+  size_t printf(const char*, ...) { return 0; }
+  size_t write(uint8_t) { return 0; }
+};
+extern HardwareSerialShim Serial;
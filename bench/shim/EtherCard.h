@@ -0,0 +1,29 @@
+// Host shim: the parts of the modified EtherCard library used by the protocol decoders
+#pragma once
+#include "Arduino.h"
+
+#define IP_LEN 4
+#define ETH_LEN 6
+
+class ENC28J60 {
+public:
+  static uint8_t buffer[];
+  static bool is_VLAN_tagging_enabled();
+  static void disable_VLAN_tagging();
+  static void enable_VLAN_tagging(uint16_t vlan);
+  static uint16_t packetReceive();
+  static bool packet_Received_Was_Tagged();
+  static void packetSend(uint16_t len);
+};
+
+class EtherCard : public ENC28J60 {};
+
+typedef ENC28J60 Ethernet;
+extern EtherCard ether;
+
+// Frame returned by the next packetReceive(), as it was on the wire
+void shim_receive(const uint8_t frame[], uint16_t len);
+
+// Length of the frame in buffer passed to packetSend() since the last call, 0 if none was sent.
+// Sending with VLAN tagging enabled is counted as a failure and returns 0xffff.
+uint16_t shim_sent();
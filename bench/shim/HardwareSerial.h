@@ -0,0 +1,14 @@
+// Host shim: serial configuration constants used by the sketch
+#pragma once
+#define SERIAL_7N1 0x08000018
+#define SERIAL_8N1 0x0800001c
+#define SERIAL_7E1 0x0800001a
+#define SERIAL_8E1 0x0800001e
+#define SERIAL_7O1 0x0800001b
+#define SERIAL_8O1 0x0800001f
+#define SERIAL_7N2 0x08000038
+#define SERIAL_8N2 0x0800003c
+#define SERIAL_7E2 0x0800003a
+#define SERIAL_8E2 0x0800003e
+#define SERIAL_7O2 0x0800003b
+#define SERIAL_8O2 0x0800003f
@@ -0,0 +1,80 @@
+// Host shim: globals of the Arduino core, the EtherCard library and the main sketch
+#include "Arduino.h"
+#include "EtherCard.h"
+#include "DHCPOptions.h"
+#include <chrono>
+
+HardwareSerialShim Serial;
+EtherCard ether;
+uint8_t ENC28J60::buffer[1522];
+
+// Receive path of the modified EtherCard library: with VLAN tagging enabled the tag of the
+// frames of the tagged VLAN is removed and only reported by packet_Received_Was_Tagged()
+static uint16_t shim_taggingVLAN = 0;
+static bool shim_receivedTagged = false;
+static uint8_t shim_wireFrame[sizeof(ENC28J60::buffer)];
+static uint16_t shim_wireLen = 0;
+
+bool ENC28J60::is_VLAN_tagging_enabled() {
+  return shim_taggingVLAN != 0;
+}
+
+void ENC28J60::disable_VLAN_tagging() {
+  shim_taggingVLAN = 0;
+}
+
+void ENC28J60::enable_VLAN_tagging(uint16_t vlan) {
+  shim_taggingVLAN = vlan;
+}
+
+void shim_receive(const uint8_t frame[], uint16_t len) {
+  if (len > sizeof(shim_wireFrame))
+    len = sizeof(shim_wireFrame);
+  memcpy(shim_wireFrame, frame, len);
+  shim_wireLen = len;
+}
+
+uint16_t ENC28J60::packetReceive() {
+  uint16_t len = shim_wireLen;
+  shim_wireLen = 0;
+  shim_receivedTagged = (shim_taggingVLAN != 0) && (len >= 18) && (shim_wireFrame[12] == 0x81) && (shim_wireFrame[13] == 0x00)
+                        && ((((shim_wireFrame[14] << 8) | shim_wireFrame[15]) & 0x0fff) == shim_taggingVLAN);
+  if (shim_receivedTagged) {
+    memcpy(buffer, shim_wireFrame, 12);
+    memcpy(buffer + 12, shim_wireFrame + 16, len - 16);
+    len -= 4;
+  } else
+    memcpy(buffer, shim_wireFrame, len);
+  return len;
+}
+
+bool ENC28J60::packet_Received_Was_Tagged() {
+  return shim_receivedTagged;
+}
+
+// Send path: the frame stays in buffer, only its length is kept
+static uint16_t shim_sentLen = 0;
+
+void ENC28J60::packetSend(uint16_t len) {
+  shim_sentLen = (shim_taggingVLAN != 0) ? 0xffff : len;
+}
+
+uint16_t shim_sent() {
+  uint16_t len = shim_sentLen;
+  shim_sentLen = 0;
+  return len;
+}
+
+static const auto shim_start = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - shim_start).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - shim_start).count();
+}
+
+// Variables of DAMPF.ino used by DHCPOptions.cpp
+byte eth_ntpIPs[ETH_NTPMAXSOURCES][IP_LEN];
+byte eth_ntpSources = 0;